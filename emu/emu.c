@@ -1,6 +1,8 @@
 
 /* emulator to develop and debug the game logic  */
 
+/* build: gcc -O2 -pthread emu.c (or make.sh for the shared library) */
+
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -8,9 +10,25 @@
 #include <assert.h>
 #include <time.h>
 #include <inttypes.h>
+#include <ctype.h>
 
 #include <termios.h>
 #include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stddef.h>
+#include <limits.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "emu.h"
 
 /* === SETTINGS ==== */
 
@@ -43,6 +61,105 @@
 // number of search steps
 #define NUM_SEARCH UINT32_MAX
 
+// file to checkpoint the search to, an existing checkpoint is resumed ("" = no checkpoints)
+#define SEARCH_CHECKPOINT_FILE "search.ckpt"
+
+// seconds between two checkpoints
+#define SEARCH_CHECKPOINT_INTERVAL 60
+
+// test corpus, %d is the board width ("" = in memory only), the search appends to it
+#define CORPUS_FILE "corpus%d.bin"
+
+/*
+    Exhaustive check of the score implementation
+    0 disable
+    1 enabled
+
+    adds every tile value to every score state (blank and zero padded) with
+    game_addScore1 and game_addScore_ref and reports all mismatches
+ */
+#define CHECK_SCORE 0
+
+// file to write every mismatch to ("" = summary and examples only, all mismatches are ~1 GB)
+#define CHECK_SCORE_FILE ""
+
+// number of threads (0 = one per core)
+#define NUM_THREADS 0
+
+/*
+    Count the switching activity of memory, buffer and shift counter
+    0 disable
+    1 enabled
+
+    debug_toggles ranks the move algorithms by toggles per move
+ */
+#define TOGGLE 0
+
+/*
+    Publish progress counters of long runs
+    0 disable
+    1 enabled
+
+    status line on stderr and a memory mapped stats file (see METRICS FUNCTIONS)
+ */
+#define METRICS 0
+
+// file the counters are mapped from ("" = status line only)
+#define METRICS_FILE "emu.stats"
+
+// time between two updates of the rates and the status line
+#define METRICS_INTERVAL_MS 1000
+
+/*
+    Train a n-tuple network by self-play (TD(0) on afterstates)
+    0 disable
+    1 enabled
+
+    the weights are a policy to play deep games (high tiles and overflow)
+ */
+#define TRAIN 0
+
+// number of self-play games
+#define TRAIN_GAMES 100000
+
+// file the weights are mapped from ("" = in memory only)
+#define TRAIN_FILE "ntuple.bin"
+
+// learning rate
+#define TRAIN_ALPHA 0.0025f
+
+/*
+    Play deep games with the trained policy of TRAIN_FILE as workload
+    0 disable
+    1 enabled
+
+    every move is checked with game_move against the reference, the boards on
+    which a game reaches a new highest tile (from PLAY_MIN_TILE) are appended
+    to the corpus
+ */
+#define PLAY 0
+
+// number of games
+#define PLAY_GAMES 1000
+
+// lowest tile whose boards are added to the corpus
+#define PLAY_MIN_TILE 10
+
+/*
+    Scoped timers of moves, score, spawn, memory and the drivers
+    0 disable (no overhead)
+    1 enabled
+
+    the events are written to TRACE_FILE at exit (Chrome trace event JSON)
+ */
+#define TRACE 0
+
+// file the trace is written to
+#define TRACE_FILE "emu.trace.json"
+
+// number of events kept per thread (the last ones)
+#define TRACE_BUFFER 65536
+
 /* Select which implementation to use for spawning tiles
    0 manual
    1 time random
@@ -52,7 +169,8 @@
 
 /* Select which implementation to use for computing the score
    0 reference
-   1 v1
+   1 v1 (decimal digits)
+   2 v2 (binary register, double dabble)
 */
 #define SCORE 1
 
@@ -65,14 +183,92 @@
 */
 #define MOVE_ALGO 4
 
+/* Select the width of the board (x = y = width)
+   3 3x3 ( 9 fields)
+   4 4x4 (16 fields)
+   5 5x5 (25 fields)
+
+   can be set from the command line, e.g. -DNUM_FIELDW=5
+*/
+#ifndef NUM_FIELDW
+#define NUM_FIELDW 4
+#endif
+
+/* Generate the decision logic of v4 (move4_decide) as SystemVerilog
+   0 disable
+   1 enabled
+*/
+#define GENERATE_LOGIC 0
+
+// file the logic is written to
+#define GENERATE_LOGIC_FILE "../src/modules/MoveLogic.sv"
+
+/* Coverage guided fuzzing of v4 against the reference
+   0 disable
+   1 enabled
+
+   compares the coverage of uniform random boards and of mutated boards
+*/
+#define FUZZ 0
+
+// number of boards per mode
+#define FUZZ_ITERATIONS 1000000
+
+/*
+    Select a minimal set of vectors for gate level simulation
+    0 disable
+    1 write COMPACT_FILE
+ */
+#define COMPACT 0
+
+// random candidates in addition to the corpus moves
+#define COMPACT_CANDIDATES 200000
+
+// seed of the candidates
+#define COMPACT_SEED 1
+
+// python module with the stimulus
+#define COMPACT_FILE "../src/stimulus.py"
+
+/* Select how the board is drawn
+   0 clear the screen and print the whole board
+   1 incremental (ANSI cursor), only changed tiles and score digits are redrawn
+*/
+#define RENDER 1
+
+// minimum time between two incremental frames in ms (0 = draw every frame)
+#define RENDER_INTERVAL 0
+
+/* Select the kernels for batch moves
+   0 portable only
+   1 use SSE4.1 / AVX2 if the CPU supports it
+*/
+#define BATCH_SIMD 1
+
+/* Select the memory model accessMemory runs against
+   0 ring (ShiftRegisterController)
+   1 bidirectional ring
+   2 one ring per row
+   3 one ring per column
+   4 random access
+*/
+#define MEMORY_MODEL 0
+
+// clock of the chip, used to compute the display bandwidth
+#define DISPLAY_CLOCK_HZ 10000000
+// refresh rate the display has to reach
+#define DISPLAY_REFRESH_HZ 60
+
 /* === DEFINITIONS ==== */
 
+#if NUM_FIELDW < 3 || NUM_FIELDW > 5
+#error "NUM_FIELDW must be 3, 4 or 5"
+#endif
+
 /* this is not really configurable */
 
 // number of directions
 #define NUM_DIRS 4
-// widht of the board (x = y = widht)
-#define NUM_FIELDW 4
 // number of fields on the bord
 #define NUM_FIELDS (NUM_FIELDW * NUM_FIELDW)
 // number of fields to display the score
@@ -81,22 +277,163 @@
 #define NUM_SCORE_WITH_DECSEP (NUM_SCORE + (NUM_SCORE / 3))
 // number of different signs on the board
 #define NUM_SIGNS 18
+// number of bits per memory location (DATA_WIDTH of the ShiftRegisterController)
+#define MEM_DATA_WIDTH 8
+// number of bits to address a field (ADDRESS_WIDTH of the ShiftRegisterController)
+#define MEM_ADDRESS_WIDTH (NUM_FIELDS > 16 ? 5 : 4)
+
+// number of variant classes of a lane ((NUM_FIELDW + 1) ^ NUM_FIELDW)
+#if NUM_FIELDW == 3
+#define NUM_VARIANTS 64
+#elif NUM_FIELDW == 4
+#define NUM_VARIANTS 625
+#elif NUM_FIELDW == 5
+#define NUM_VARIANTS 7776
+#endif
 
 /* === plattform functions ==== */
 
-int getch(void)
+/*
+    Terminal input
+
+    The terminal is switched to raw mode once (term_init) and restored at exit
+    or when the process is terminated by a signal. Input is read in blocks into
+    a buffer and escape sequences are decoded into single keys.
+*/
+
+// decoded keys, all other keys are returned as ASCII
+typedef enum term_key_en {
+    KEY_NONE  = -1,     // no key within the timeout
+    KEY_EOF   = -2,     // input closed
+    KEY_UP    = 0x100,
+    KEY_DOWN  = 0x101,
+    KEY_LEFT  = 0x102,
+    KEY_RIGHT = 0x103,
+} term_key_t;
+
+// time to wait for the rest of an escape sequence in ms
+#define TERM_ESC_TIMEOUT 25
+
+static struct termios term_oldattr;
+static bool term_isRaw = false;
+
+static unsigned char term_buffer[256];
+static int term_bufferPos = 0;
+static int term_bufferLen = 0;
+
+void term_restore(void)
 {
-    struct termios oldattr, newattr;
-    int ch;
-    tcgetattr(STDIN_FILENO, &oldattr);
-    newattr = oldattr;
+    if(!term_isRaw) return;
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &term_oldattr);
+    term_isRaw = false;
+}
+
+void term_signal(int sig)
+{
+    term_restore();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/*
+    enter raw mode (only if stdin is a terminal)
+*/
+void term_init(void)
+{
+    if(term_isRaw || !isatty(STDIN_FILENO)) return;
+    if(tcgetattr(STDIN_FILENO, &term_oldattr) != 0) return;
+
+    struct termios newattr = term_oldattr;
     newattr.c_lflag &= (unsigned) ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &newattr);
-    ch = getchar();
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldattr);
+    newattr.c_cc[VMIN]  = 1;
+    newattr.c_cc[VTIME] = 0;
+
+    if(tcsetattr(STDIN_FILENO, TCSANOW, &newattr) != 0) return;
+
+    term_isRaw = true;
+
+    atexit(term_restore);
+    signal(SIGINT,  term_signal);
+    signal(SIGTERM, term_signal);
+    signal(SIGHUP,  term_signal);
+    signal(SIGQUIT, term_signal);
+}
+
+/*
+    get the next byte from the buffer, refill it if empty
+
+    timeout     in ms, 0 returns immediately, -1 waits forever
+*/
+int term_getByte(int timeout)
+{
+    if(term_bufferPos < term_bufferLen) return term_buffer[term_bufferPos++];
+
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+
+    if(poll(&pfd, 1, timeout) <= 0) return KEY_NONE;
+
+    ssize_t len = read(STDIN_FILENO, term_buffer, sizeof(term_buffer));
+
+    if(len <= 0) return KEY_EOF;
+
+    term_bufferPos = 1;
+    term_bufferLen = (int) len;
+
+    return term_buffer[0];
+}
+
+/*
+    get the next key without waiting longer than timeout (in ms)
+
+    returns KEY_NONE if no key was pressed, so automated and manual input can be mixed
+*/
+int term_poll(int timeout)
+{
+    int ch = term_getByte(timeout);
+
+    if(ch != 27) return ch;
+
+    int ch2 = term_getByte(TERM_ESC_TIMEOUT);
+
+    // a single ESC or Alt+key, the key is returned by the next call
+    if(ch2 != '[' && ch2 != 'O')
+    {
+        if(ch2 >= 0) term_bufferPos--;
+        return 27;
+    }
+
+    // CSI: parameter and intermediate bytes up to the final byte (e.g. ESC [ 1 ; 5 A)
+    int final = term_getByte(TERM_ESC_TIMEOUT);
+    while(ch2 == '[' && final >= 0x20 && final <= 0x3f) final = term_getByte(TERM_ESC_TIMEOUT);
+
+    switch(final)
+    {
+        case 'A': return KEY_UP;
+        case 'B': return KEY_DOWN;
+        case 'C': return KEY_RIGHT;
+        case 'D': return KEY_LEFT;
+    }
+
+    return KEY_NONE;
+}
+
+/*
+    wait for the next key
+*/
+int term_getKey(void)
+{
+    int ch;
+
+    do
+    {
+        ch = term_poll(-1);
+    } while(ch == KEY_NONE);
+
     return ch;
 }
-#define GETCH() getch()
+
+#define GETCH() term_getKey()
 #define CLEAR() system("clear");
 
 /* === globals ==== */
@@ -118,49 +455,289 @@ char game_moveNames[5][9] =
     "MV_RIGHT"
 };
 
-static char game_signs[] = {' ', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'x'};
+/*
+    value -> sign (forward table)
+
+    'x' is only used for random searching and marks an overflow, it is repeated
+    so merging two 'x' tiles saturates instead of reading past the table
+*/
+static const char game_signs[NUM_SIGNS + 2] = {' ', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'x', 'x'};
+
+/*
+    sign -> value (reverse table)
+
+    unknown signs map to 0 (empty)
+*/
+static const uint8_t game_signValues[256] = {
+    [' '] = 0,
+    ['1'] = 1,  ['2'] = 2,  ['3'] = 3,  ['4'] = 4,  ['5'] = 5,  ['6'] = 6,  ['7'] = 7,  ['8'] = 8,  ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15, ['g'] = 16, ['h'] = 17,
+    ['x'] = NUM_SIGNS,
+};
 static char game_moveLabels[][4] = { " ", "↑", "↓", "←", "→" };
 
+/*
+    the game state is thread local, every thread runs its own game
+*/
+
 // board is stored as chars
-static char game_field[NUM_FIELDS + 1] = "                ";
+static _Thread_local char game_field[NUM_FIELDS + 1];
 // score is stored as chars (base 10)
-static char game_score[NUM_SCORE + 1] = "      0";
+static _Thread_local char game_score[NUM_SCORE + 1] = "      0";
 
 // last move
-static move_direction_t game_lastMove = 0;
+static _Thread_local move_direction_t game_lastMove = 0;
 
 // last sign spawned
-static int game_lastSpawn = 0;
+static _Thread_local int game_lastSpawn = 0;
 // last field of board accessed by memory function
-static int game_fieldIndex = 0;
+static _Thread_local int game_fieldIndex = 0;
 // num shifts through memory
-static int game_numIterations = 0;
+static _Thread_local int game_numIterations = 0;
 // num iterations thorugh move logic
-static int game_numSteps = 0;
+static _Thread_local int game_numSteps = 0;
+// num accesses to memory
+static _Thread_local int game_numAccesses = 0;
 
 //  linear feedback shift register init value
-static uint16_t game_rng_value = 0x8988;
+#define RNG_SEED 0x8988
+static _Thread_local uint16_t game_rng_value = RNG_SEED;
+
+// decimal seperators of the score (bit n = dot after the n-th digit from the right)
+static _Thread_local uint8_t game_scoreDecSep = 0;
+// score datapath used by game_addScore (see SCORE)
+static _Thread_local int game_scoreVersion = SCORE;
+// cycles spent adding and converting scores
+static _Thread_local long game_scoreAddCycles = 0;
+static _Thread_local long game_scoreConvertCycles = 0;
+// binary score register of v2, wrapped around, converted to game_score
+static _Thread_local uint32_t game_scoreBinary = 0;
+static _Thread_local bool game_scoreWrapped = false;
+static _Thread_local bool game_scoreConverted = true;
+static _Thread_local bool game_scorePadded = false;
+// game_score as last converted (a different game_score was loaded from outside)
+static _Thread_local char game_scoreShown[NUM_SCORE + 1] = "      0";
+
+void game_scoreRefresh();
+// carries of the last addScore1 calls (bit n = carry out of the n-th digit from the right)
+static _Thread_local uint8_t game_scoreCarries[NUM_FIELDS];
+static _Thread_local int game_numScoreCarries = 0;
 
 // output debug info (is set in case of error)
-bool debug = false;
+_Thread_local bool debug = false;
 
 /* store variant seen in any lane an
 
-    v       values as seen in one lane
+    v       values as seen in one lane (index is the lane read as base NUM_FIELDW + 1 number)
     num     total numbers of variants stored
 
  */
 typedef struct variant_store_st
 {
     int num;
-    bool v[5][5][5][5];
+    bool v[NUM_VARIANTS];
 } variant_store_t;
 
-variant_store_t testVariants = { 0, {{{{false}}}}};
+variant_store_t testVariants = { 0, {false}};
 
 // variations data of last move from reference 
-static int moveRefLastValues[NUM_FIELDS] = {0};
+static _Thread_local int moveRefLastValues[NUM_FIELDS] = {0};
+
+
+/* === TRACE FUNCTIONS ==== */
+
+    /*
+        Scoped timers
+
+        TRACE_SCOPE("name") at the beginning of a block measures the block until it
+        is left. Every thread records its events into its own ring buffer (the
+        oldest events are overwritten), at exit all buffers are written to
+        TRACE_FILE as Chrome trace events (chrome://tracing, Perfetto).
+
+        The time stamp counter is used on x86-64 and converted with the ratio of
+        counter and CLOCK_MONOTONIC between the program start and the exit.
+
+        A buffer is released when its thread exits and taken over by the next new
+        thread (its events are kept), so only TRACE_MAX_THREADS threads can record
+        at the same time.
+    */
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+
+#if TRACE
+#define TRACE_SCOPE(name) trace_scope_t TRACE_CONCAT(trace_scope_, __LINE__) __attribute__((cleanup(trace_end))) = trace_begin(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
+
+// maximum number of threads which record events at the same time
+#define TRACE_MAX_THREADS 256
+
+typedef struct trace_scope_st
+{
+    const char *name;
+    uint64_t   begin;
+} trace_scope_t;
+
+typedef struct trace_event_st
+{
+    const char *name;
+    uint64_t   begin;
+    uint64_t   end;
+} trace_event_t;
+
+typedef struct trace_buffer_st
+{
+    int           tid;
+    bool          inUse;          // owned by a running thread
+    size_t        numEvents;      // all events, the last TRACE_BUFFER are kept
+    trace_event_t events[TRACE_BUFFER];
+} trace_buffer_t;
+
+static _Thread_local trace_buffer_t *trace_buffer = NULL;
+static trace_buffer_t *trace_buffers[TRACE_MAX_THREADS];
+static int trace_numBuffers = 0;
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t trace_key;
+static uint64_t trace_startTicks;
+static struct timespec trace_startTime;
+
+static inline uint64_t trace_now()
+{
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+void trace_write();
+
+/*
+    release the buffer of an exiting thread
+*/
+static void trace_release(void *arg)
+{
+    trace_buffer_t *buffer = arg;
+
+    pthread_mutex_lock(&trace_mutex);
+    buffer->inUse = false;
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+/*
+    start time before the first scope begins
+*/
+__attribute__((constructor)) static void trace_start()
+{
+    clock_gettime(CLOCK_MONOTONIC, &trace_startTime);
+    trace_startTicks = trace_now();
+    pthread_key_create(&trace_key, trace_release);
+}
+
+/*
+    buffer of the calling thread, NULL if there are too many threads
+*/
+trace_buffer_t *trace_getBuffer()
+{
+    if(trace_buffer) return trace_buffer;
+
+    pthread_mutex_lock(&trace_mutex);
+
+    if(TRACE && trace_numBuffers == 0) atexit(trace_write);
+
+    // a buffer of an exited thread or a new one
+    for(int b = 0; b < trace_numBuffers && !trace_buffer; b++)
+    {
+        if(!trace_buffers[b]->inUse) trace_buffer = trace_buffers[b];
+    }
+
+    if(!trace_buffer && trace_numBuffers < TRACE_MAX_THREADS)
+    {
+        trace_buffer_t *buffer = calloc(1, sizeof(trace_buffer_t));
 
+        if(buffer)
+        {
+            buffer->tid = trace_numBuffers;
+            trace_buffers[trace_numBuffers++] = buffer;
+            trace_buffer = buffer;
+        }
+    }
+
+    if(trace_buffer)
+    {
+        trace_buffer->inUse = true;
+        pthread_setspecific(trace_key, trace_buffer);
+    }
+
+    pthread_mutex_unlock(&trace_mutex);
+
+    return trace_buffer;
+}
+
+static inline trace_scope_t trace_begin(const char *name)
+{
+    return (trace_scope_t) { name, trace_now() };
+}
+
+static inline void trace_end(trace_scope_t *scope)
+{
+    uint64_t end = trace_now();
+    trace_buffer_t *buffer = trace_buffer ? trace_buffer : trace_getBuffer();
+
+    if(!buffer) return;
+
+    buffer->events[buffer->numEvents % TRACE_BUFFER] = (trace_event_t) { scope->name, scope->begin, end };
+    buffer->numEvents++;
+}
+
+/*
+    write all events as Chrome trace event JSON
+*/
+void trace_write()
+{
+    FILE *f = fopen(TRACE_FILE, "w");
+    if(!f) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t ticks = trace_now() - trace_startTicks;
+    double   ns    = (double) (now.tv_sec - trace_startTime.tv_sec) * 1e9 + (double) (now.tv_nsec - trace_startTime.tv_nsec);
+    double   usPerTick = ticks ? ns / (double) ticks / 1000.0 : 0;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    bool first = true;
+    size_t numDropped = 0;
+
+    pthread_mutex_lock(&trace_mutex);
+
+    for(int b = 0; b < trace_numBuffers; b++)
+    {
+        trace_buffer_t *buffer = trace_buffers[b];
+        size_t numKept = buffer->numEvents < TRACE_BUFFER ? buffer->numEvents : TRACE_BUFFER;
+
+        numDropped += buffer->numEvents - numKept;
+
+        for(size_t i = buffer->numEvents - numKept; i < buffer->numEvents; i++)
+        {
+            trace_event_t *e = &buffer->events[i % TRACE_BUFFER];
+            uint64_t begin = e->begin > trace_startTicks ? e->begin - trace_startTicks : 0;
+
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n",
+                e->name, buffer->tid, (double) begin * usPerTick, (double) (e->end - e->begin) * usPerTick);
+            first = false;
+        }
+    }
+
+    pthread_mutex_unlock(&trace_mutex);
+
+    fprintf(f, "\n],\"otherData\":{\"threads\":%d,\"dropped\":%zu}}\n", trace_numBuffers, numDropped);
+    fclose(f);
+}
 
 /* === MEMORY FUNCTIONS ==== */
 
@@ -243,6 +820,9 @@ int computeIndex(int lane, int pos, int dir)
 
 /*
     computes the distance (number of shifts in one direction) between 2 indexes
+
+    one shift moves the ring by one field, which takes MEM_DATA_WIDTH clock cycles
+    in the ShiftRegisterController, the distance grows with the ring length (NUM_FIELDS)
 */
 int computeMemoryDistance(int index)
 {
@@ -251,1756 +831,8549 @@ int computeMemoryDistance(int index)
 }
 
 /*
-    get data from memory and update statisticall data
+    convert the sign to a binary number
 */
-int accessMemory(int index, bool write, int data)
+static inline int getSignValue(char sign)
 {
-    game_numIterations += computeMemoryDistance(index);
-
-    assert(write ? data > 0 : data == 0);
-    assert(index >= 0);
-    assert(index < NUM_FIELDS);
-
-    game_fieldIndex = index;
-
-    if(write) 
-    {
-        game_field[index] = data;
-    }
-    
-    return game_field[index];
+    return game_signValues[(unsigned char) sign];
 }
 
 /*
-    red the value of the last accessed index
+    convert a binary number to the sign
 */
-int getCurrentValue()
+static inline char getSign(int value)
 {
-    return game_field[game_fieldIndex];
+    assert(value >= 0);
+    assert(value <= NUM_SIGNS + 1);
+
+    return game_signs[value];
 }
 
-/*
-    convert the sign to a binary number
-*/
-int getSignValue(char sign)
-{
-    int value = 0;
+/* === TOGGLE FUNCTIONS ==== */
 
-    for(int i = 0; i < NUM_SIGNS; i++)
-    {
-        if(sign == game_signs[i]) value = i;
-    }
+    /*
+        Switching activity
 
-    return value;
-}
+        A ring of the memory model is modelled as a chain of its fields x
+        MEM_DATA_WIDTH bits, in the order they pass the buffer. The first location
+        of the chain is the buffer and holds the current field of the ring (for
+        the single ring: chain[k] = field[(game_fieldIndex + k) % NUM_FIELDS]).
 
-/* === HELPER FUNCTION  ==== */
+        Every clock each bit takes the value of its neighbour (towards bit 0, as in
+        ShiftRegister), a bit toggles if it differs from its neighbour. The ring
+        content does not change while shifting, so the toggles of T clocks are
+        counted on the unrolled chain without rotating it.
 
-void print_game()
-{
-    /*
-    
-    ╔═══╦═══╦═══╦═══╗
-    ║ f ║ e ║ d ║ c ║
-    ╟───╫───╫───╫───╢
-    ║ b ║ a ║ 9 ║ 8 ║
-    ╟───╫───╫───╫───╢
-    ║ 7 ║ 6 ║ 5 ║ 4 ║
-    ╟───╫───╫───╫───╢
-    ║ 3 ║ 2 ║ 1 ║ 0 ║
-    ╚═══╩═══╩═══╩═══╝
-    
+        The DownCounter of the ShiftRegisterController of each ring is loaded with
+        the number of bit shifts on every access and counts down to 1, a write
+        replaces the buffer content.
     */
 
-   printf("╔═══╦═══╦═══╦═══╗\n");
-   printf("║ %c ║ %c ║ %c ║ %c ║\n", game_field[15], game_field[14], game_field[13], game_field[12]);
-   printf("╟───╫───╫───╫───╢\n");
-   printf("║ %c ║ %c ║ %c ║ %c ║\n", game_field[11], game_field[10], game_field[9],  game_field[8]);
-   printf("╟───╫───╫───╫───╢\n");
-   printf("║ %c ║ %c ║ %c ║ %c ║\n", game_field[7],  game_field[6],  game_field[5],  game_field[4]);
-   printf("╟───╫───╫───╫───╢\n");
-   printf("║ %c ║ %c ║ %c ║ %c ║\n", game_field[3],  game_field[2],  game_field[1],  game_field[0]);
-   printf("╚═══╩═══╩═══╩═══╝\n");
-}
+// number of bits in the ring
+#define TOGGLE_RING_BITS (NUM_FIELDS * MEM_DATA_WIDTH)
+// number of histogram buckets (toggles per move)
+#define TOGGLE_HIST_BUCKETS 16
+// width of one histogram bucket
+#define TOGGLE_HIST_WIDTH 4096
 
-void print_lane(int lane, int dir)
+typedef struct toggle_count_st
 {
-    printf("║ %c | %c | %c | %c ║", 
-    game_field[computeIndex(lane, 0, dir)], 
-    game_field[computeIndex(lane, 1, dir)], 
-    game_field[computeIndex(lane, 2, dir)], 
-    game_field[computeIndex(lane, 3, dir)]);
-}
+    long memory;
+    long buffer;
+    long counter;
+} toggle_count_t;
 
-void printBits(size_t const size, void const * const ptr)
-{
-    unsigned char *b = (unsigned char*) ptr;
-    unsigned char byte;
-    int i, j;
-    
-    for (i = size-1; i >= 0; i--) {
-        for (j = 7; j >= 0; j--) {
-            byte = (b[i] >> j) & 1;
-            printf("%u", byte);
-        }
-    }
-}
+static _Thread_local toggle_count_t game_numToggles;
+// value of the DownCounter of each ring
+static _Thread_local int toggle_counterValue[NUM_FIELDW];
 
-/* === GAME FUNCTIONS ==== */
+/*
+    count the toggles of shifting a ring by distance fields
 
+    chain   fields of the ring in the order they pass the buffer, chain[0] is in the buffer
+*/
+void toggle_shift(const int *chain, int length, int ring, int distance)
+{
+    int clocks = distance * MEM_DATA_WIDTH;
+    int *counter = &toggle_counterValue[ring];
 
-/* = SPAWN = */
+    // load
+    game_numToggles.counter += __builtin_popcount((unsigned) (*counter ^ clocks));
+    *counter = clocks;
 
-/*
-    spawn new tiles using time based rand
- */
-void spawn_timerandom()
-{
-    int numSpotsLeft = 0;
+    if(distance == 0) return;
 
-    for(int i = 0; i < NUM_FIELDS; i++)
+    static _Thread_local uint8_t bits[TOGGLE_RING_BITS];
+    static _Thread_local uint8_t edge[TOGGLE_RING_BITS];
+    int numBits = length * MEM_DATA_WIDTH;
+
+    for(int k = 0; k < length; k++)
     {
-        if(game_field[i] == game_signs[0]) numSpotsLeft++;
+        int value = getSignValue(game_field[chain[k]]);
+
+        for(int b = 0; b < MEM_DATA_WIDTH; b++) bits[(k * MEM_DATA_WIDTH) + b] = (value >> b) & 1;
     }
 
-    if (numSpotsLeft > 0)
+    int numEdges = 0;
+    for(int k = 0; k < numBits; k++)
     {
-        srand((unsigned int) time(NULL));
-
-        // 10% chance for 4, else 2
-        int value = (rand() % 10 == 0) ? 2 : 1;
+        edge[k] = bits[k] != bits[(k + 1) % numBits];
+        numEdges += edge[k];
+    }
 
-        int spot = rand() % numSpotsLeft;
-        int s = 0;
+    // bits in the buffer at clock t are bits t .. t + MEM_DATA_WIDTH of the unrolled chain
+    long buffer = 0;
+    for(int t = 0; t < clocks; t++)
+    {
+        for(int b = 0; b < MEM_DATA_WIDTH; b++) buffer += edge[(t + b) % numBits];
+    }
 
-        for (int i = 0; i < NUM_FIELDS; i++)
-        {
-            if (game_field[i] == game_signs[0])
-            {
-                if (s == spot) 
-                {
-                    game_field[i] = game_signs[value];
-                    game_lastSpawn = value;
-                    return;
-                }
+    game_numToggles.buffer += buffer;
+    game_numToggles.memory += ((long) clocks * numEdges) - buffer;
 
-                s += 1;
-            }
-        }
-        printf("s: %d\n", s);
-    }
+    // count down to 1, the next access reloads it
+    for(int c = clocks; c > 1; c--) game_numToggles.counter += __builtin_popcount((unsigned) (c ^ (c - 1)));
+    *counter = 1;
 }
 
 /*
-    select where to spawn a new tile
- */
-void spawn_manual()
+    count the toggles of overwriting the buffer
+*/
+void toggle_write(int index, char data)
 {
-    bool spawned = false;
-    int spawn;
-    bool spawn4 = false;
+    game_numToggles.buffer += __builtin_popcount((unsigned) (getSignValue(game_field[index]) ^ getSignValue(data)));
+}
 
-    printf("\rspawn?> ");
+/*
+    Memory models
 
-    do
-    {
-        int ch = GETCH();
-        
-        switch(ch)
-        {
-            case 'a':
-            case 'b':
-            case 'c':
-            case 'd':
-            case 'e':
-            case 'f':
-            case 'g':
-            case 'h':
-            case 'i':
-            case 'j':
-            case 'k':
-            case 'l':
-            case 'm':
-            case 'n':
-            case 'o':
-            case 'p': spawn = ch - 'a'; break;
-            case 'A':
-            case 'B':
-            case 'C':
-            case 'D':
-            case 'E':
-            case 'F':
-            case 'G':
-            case 'H':
-            case 'I':
-            case 'J':
-            case 'K':
-            case 'L':
-            case 'M':
-            case 'N':
-            case 'O':
-            case 'P': spawn = ch - 'A'; spawn4 = true; break;
-            default: continue;
-        }
-
-        if(spawn < NUM_FIELDS && game_field[spawn] == game_signs[0])
-        {
-            game_lastSpawn = spawn;
-            spawned = true;
-            game_field[spawn] = spawn4 ? game_signs[2] : game_signs[1];
-        }
+    The move algorithms only access the memory through accessMemory, the
+    model decides how many shifts an access takes:
 
-    } while(!spawned);
+        ring        one ring over all fields, shifts in one direction (ShiftRegisterController)
+        biring      one ring over all fields, shifts in both directions
+        rows        one ring per row, each with its own buffer
+        columns     one ring per column, each with its own buffer
+        random      random access, no shifts
 
-}
+    A shift moves a ring by one field (MEM_DATA_WIDTH cycles), an access takes
+    one more cycle. The toggle counter (TOGGLE) follows the rings of the model.
+*/
 
-/*
-    spawn new tiles using  linear feedback shift register 
- */
-void spawn_tetrisrng()
+typedef struct memory_model_st
 {
-  game_rng_value = ((((game_rng_value >> 9) & 1) ^ ((game_rng_value >> 1) & 1)) << 15) | (game_rng_value >> 1);
+    const char *name;
+    int  (*distance)(int index);    // shifts to get index into the buffer
+    void (*shift)(int index);       // one shift towards index
+    void (*seek)(int index);        // index is in the buffer
+    int  (*chain)(int index, int chain[NUM_FIELDS], int *ring);    // fields of the ring of index in shift order
+    int  numBuffers;                // buffers (MEM_DATA_WIDTH bit registers)
+} memory_model_t;
+
+// field in the buffer of each row / column ring
+static _Thread_local int memory_ringIndex[NUM_FIELDW];
+
+int memory_ringDistance(int index)
+{
+    return computeMemoryDistance(index);
 }
 
-void spawn()
+void memory_ringShift(int index)
 {
-    if(SPAWN == 0) return spawn_manual();
-    if(SPAWN == 1) return spawn_timerandom();
-    if(SPAWN == 2) return spawn_tetrisrng();
+    (void) index;
+    game_fieldIndex = (game_fieldIndex + 1) % NUM_FIELDS;
+}
 
-    assert(false);
+void memory_ringSeek(int index)
+{
+    game_fieldIndex = index;
 }
 
+int memory_ringChain(int index, int chain[NUM_FIELDS], int *ring)
+{
+    (void) index;
+    *ring = 0;
 
-/* = SCORE = */
+    for(int k = 0; k < NUM_FIELDS; k++) chain[k] = (game_fieldIndex + k) % NUM_FIELDS;
 
-uint8_t game_addScore1(int addScoreBit)
-{
-    uint8_t decSep   = 0;
-    bool carry   = false;
-    int addScore = 1 << addScoreBit;
-    
-    if(DEBUG_SCORE && debug) printf("'%s' + %2d(%6d)\n", game_score, addScoreBit, addScore);
+    return NUM_FIELDS;
+}
 
-    for(int ctr = NUM_SCORE -1; ctr >= 0; ctr--)
-    {
-        int  pos        = NUM_SCORE - ctr - 1;
-        char cOld       = game_score[ctr];     
-        bool isOldEmtpy = game_score[ctr] == ' ';
+int memory_biringDistance(int index)
+{
+    int distance = computeMemoryDistance(index);
 
-        int vOld;
-        switch(game_score[ctr])
-        {
-            case ' ':
-            case '0': vOld = 0; break;
-            case '1': vOld = 1; break;
-            case '2': vOld = 2; break;
-            case '3': vOld = 3; break;
-            case '4': vOld = 4; break;
-            case '5': vOld = 5; break;
-            case '6': vOld = 6; break;
-            case '7': vOld = 7; break;
-            case '8': vOld = 8; break;
-            case '9': vOld = 9; break;
-        }
+    return distance <= NUM_FIELDS - distance ? distance : NUM_FIELDS - distance;
+}
 
-        int vAdd   = addScore % 10;
-        int nNew   = vOld + vAdd + carry;
-        int vNew   =  nNew % 10;
-        carry      = (nNew / 10) > 0;
+void memory_biringShift(int index)
+{
+    int distance = computeMemoryDistance(index);
+    int step     = distance <= NUM_FIELDS - distance ? 1 : NUM_FIELDS - 1;
 
-        char cNew = ' ';
-        bool isNewEmpty = (isOldEmtpy && !carry && vNew == 0);
+    game_fieldIndex = (game_fieldIndex + step) % NUM_FIELDS;
+}
 
-        if(!isNewEmpty)
-        {
-            switch(vNew)
-            {
-                case 0: cNew = '0'; break;
-                case 1: cNew = '1'; break;
-                case 2: cNew = '2'; break;
-                case 3: cNew = '3'; break;
-                case 4: cNew = '4'; break;
-                case 5: cNew = '5'; break;
-                case 6: cNew = '6'; break;
-                case 7: cNew = '7'; break;
-                case 8: cNew = '8'; break;
-                case 9: cNew = '9'; break;
-            }
-        }
+int memory_biringChain(int index, int chain[NUM_FIELDS], int *ring)
+{
+    int distance = computeMemoryDistance(index);
+    int step     = distance <= NUM_FIELDS - distance ? 1 : NUM_FIELDS - 1;
 
-        bool isDecSepPos = (pos == 3 || pos == 6);
-        bool hasDecSep   = isDecSepPos && !isNewEmpty;
+    *ring = 0;
 
-        if(DEBUG_SCORE && debug) printf(" %d:'%c'(%2d)  + %2d = '%c'(%6d) (+%d) %c\n", pos, cOld, vOld, vAdd, cNew, vNew, carry, hasDecSep ? '.' : ' ');
+    for(int k = 0; k < NUM_FIELDS; k++) chain[k] = (game_fieldIndex + (k * step)) % NUM_FIELDS;
 
-        game_score[ctr] = cNew;
-        addScore = addScore / 10;
-        if(hasDecSep) decSep |= 1 << pos;
+    return NUM_FIELDS;
+}
 
-    }
-    if(DEBUG_SCORE && debug) printf("%s ",game_score);
-    if(DEBUG_SCORE && debug) printBits(sizeof(uint8_t), &decSep);
-    if(DEBUG_SCORE && debug) printf(" ");
-    if(DEBUG_SCORE && debug) for(int i = 0; i < NUM_SCORE; i++) { printf("%c", game_score[i]); if(decSep & (1 << (NUM_SCORE - i - 1)))  printf("."); }
-    if(DEBUG_SCORE && debug) printf("\n");
+int memory_rowsDistance(int index)
+{
+    int ring = index / NUM_FIELDW;
 
-    return decSep;
+    return ((index % NUM_FIELDW) - memory_ringIndex[ring] + NUM_FIELDW) % NUM_FIELDW;
 }
 
-uint8_t game_addScore_ref(int value)
+void memory_rowsShift(int index)
 {
-    uint8_t decSep   = 0;
-    int currentScore = atol(game_score);
-    int currentValue = 1 << value;
-    int newScore = currentScore + currentValue;
+    int ring = index / NUM_FIELDW;
 
-    if(DEBUG_SCORE && debug) printf("'%s' + %2d(%6d) = ", game_score, value, currentValue);
+    memory_ringIndex[ring] = (memory_ringIndex[ring] + 1) % NUM_FIELDW;
+}
 
-    if(newScore >= 1000)    decSep |= 1 << 3;
-    
-    if(newScore >= 1000000) 
-    {
-        decSep |= 1 << 6;
-        snprintf(game_score, NUM_SCORE+1, "%07d", newScore % 10000000);
-    }
-    else
-    {
-        snprintf(game_score, NUM_SCORE+1, "%7d", newScore);
-    }
+void memory_rowsSeek(int index)
+{
+    memory_ringIndex[index / NUM_FIELDW] = index % NUM_FIELDW;
+}
 
-    if(DEBUG_SCORE && debug) printf("'%s' ( %7d ) ", game_score, newScore, currentValue);
-    if(DEBUG_SCORE && debug) printf("[");
-    if(DEBUG_SCORE && debug) printBits(sizeof(uint8_t), &decSep);
-    if(DEBUG_SCORE && debug) printf("] -> '");
-    if(DEBUG_SCORE && debug) for(int i = 0; i < NUM_SCORE; i++) { printf("%c", game_score[i]); if(decSep & (1 << (NUM_SCORE - i - 1)))  printf("."); }
+int memory_rowsChain(int index, int chain[NUM_FIELDS], int *ring)
+{
+    *ring = index / NUM_FIELDW;
 
-    if(DEBUG_SCORE && debug) printf("'\n");
-    if(DEBUG_SCORE && debug) printf(" %7d\n", currentScore);
+    for(int k = 0; k < NUM_FIELDW; k++) chain[k] = (*ring * NUM_FIELDW) + ((memory_ringIndex[*ring] + k) % NUM_FIELDW);
 
-    return decSep;
+    return NUM_FIELDW;
 }
 
+int memory_columnsDistance(int index)
+{
+    int ring = index % NUM_FIELDW;
 
+    return ((index / NUM_FIELDW) - memory_ringIndex[ring] + NUM_FIELDW) % NUM_FIELDW;
+}
 
-uint8_t game_addScore(int value)
+void memory_columnsShift(int index)
 {
-    if(SCORE == 1) return game_addScore1(value);
-    if(SCORE == 0) return game_addScore_ref(value);
+    int ring = index % NUM_FIELDW;
 
-    assert(false);
+    memory_ringIndex[ring] = (memory_ringIndex[ring] + 1) % NUM_FIELDW;
 }
 
+void memory_columnsSeek(int index)
+{
+    memory_ringIndex[index % NUM_FIELDW] = index / NUM_FIELDW;
+}
 
-/* = MOVE = */
+int memory_columnsChain(int index, int chain[NUM_FIELDS], int *ring)
+{
+    *ring = index % NUM_FIELDW;
 
-/*
-    uses a buffer to hold a value and the current shift register value to updat the field based on the move
-    only two values are loaded each step. A field is loaded into Base and then compared with View. View itereates
-    over all elements. Base is adopted if tiles where moved or merged.
+    for(int k = 0; k < NUM_FIELDW; k++) chain[k] = (((memory_ringIndex[*ring] + k) % NUM_FIELDW) * NUM_FIELDW) + *ring;
 
-    # Evaluation #
+    return NUM_FIELDW;
+}
 
-    position    0   1   2   3 
+int memory_randomDistance(int index)
+{
+    (void) index;
+    return 0;
+}
 
-                ╟───╫───╫───╫───╢
-    lane        ║ B ║ V ║   ║   ║   <-- move direction
-                ╟───╫───╫───╫───╢
+void memory_randomSeek(int index)
+{
+    (void) index;
+}
 
-              
-    A. fetch                                                                        B       V       score   posBase
-                                                                                    p0      p1              0                      
+int memory_randomChain(int index, int chain[NUM_FIELDS], int *ring)
+{
+    chain[0] = index;
+    *ring = 0;
 
+    return 1;
+}
 
-    B. eval                                 C. write                    D. next     a       d
-                  0   1   2   3              
-    2.1         ║ 0 ║ 0 ║   ║   ║                                                           p2              0
-    2.2         ║ x ║ 0 ║   ║   ║                                                           p2              0
-    2.3         ║ x ║ y ║   ║   ║                                                   d       p2              1
-    2.4         ║ x ║ x ║   ║   ║           ║ y ║ 0 ║   ║   ║                       0       p2      +y      1
-    2.5         ║ 0 ║ y ║   ║   ║           ║ y ║ 0 ║   ║   ║                       d       p2              0
+static const memory_model_t memory_models[] = {
+    { "ring",    memory_ringDistance,    memory_ringShift,    memory_ringSeek,    memory_ringChain,    1          },
+    { "biring",  memory_biringDistance,  memory_biringShift,  memory_ringSeek,    memory_biringChain,  1          },
+    { "rows",    memory_rowsDistance,    memory_rowsShift,    memory_rowsSeek,    memory_rowsChain,    NUM_FIELDW },
+    { "columns", memory_columnsDistance, memory_columnsShift, memory_columnsSeek, memory_columnsChain, NUM_FIELDW },
+    { "random",  memory_randomDistance,  memory_randomSeek,   memory_randomSeek,  memory_randomChain,  1          },
+};
 
+#define NUM_MEMORY_MODELS (int) (sizeof(memory_models) / sizeof(memory_models[0]))
 
-    B. eval                                 C. write                    D. next     a       d
-                  0   1   2   3
-    2.1.1       ║ 0 ║ 0 ║ 0 ║   ║                                                           p3              0
-    2.1.2       ║ 0 ║ 0 ║ x ║   ║           ║ x ║ 0 ║ 0 ║   ║                       d       p3              0
+static _Thread_local const memory_model_t *memory_model = &memory_models[MEMORY_MODEL];
 
-    2.2.1       ║ x ║ 0 ║ 0 ║   ║                                                           p3              0
-    2.2.2       ║ x ║ 0 ║ x ║   ║           ║ y ║ 0 ║ 0 ║   ║                       d       p3      +y      1
-    2.2.3       ║ x ║ 0 ║ y ║   ║           ║ x ║ y ║ 0 ║   ║                       0       p3              1
-    
-    2.3.1       ║ x ║ y ║ 0 ║   ║                                                           p3              1
-    2.3.2       ║ x ║ y ║ x ║   ║                                                           p3              2
-    2.3.3       ║ x ║ y ║ y ║   ║           ║ x ║ z ║   ║   ║                       d       p3      +z      2
+/*
+    all rings start at field 0
+*/
+void memory_reset()
+{
+    game_fieldIndex = 0;
+    memset(memory_ringIndex, 0, sizeof(memory_ringIndex));
+    memset(toggle_counterValue, 0, sizeof(toggle_counterValue));
+}
 
-    2.4.1       ║ y ║ 0 ║ 0 ║   ║                                                           p3              1
-    2.4.2       ║ y ║ 0 ║ x ║   ║           ║ y ║ x ║ 0 ║   ║                       d       p3              1
-    2.4.3       ║ y ║ 0 ║ y ║   ║           ║ y ║ y ║ 0 ║   ║                       0       p3              1
+/*
+    count the toggles of shifting the ring of index by distance fields
+*/
+void memory_toggleShift(int index, int distance)
+{
+    int chain[NUM_FIELDS], ring;
+    int length = memory_model->chain(index, chain, &ring);
 
-    2.5.1       ║ y ║ 0 ║ 0 ║   ║                                                           p3              0
-    2.5.2       ║ y ║ 0 ║ x ║   ║           ║ y ║ x ║ 0 ║   ║                       d       p3              1
-    2.5.3       ║ y ║ 0 ║ y ║   ║           ║ z ║ 0 ║ 0 ║   ║                       d       p3              1
+    toggle_shift(chain, length, ring, distance);
+}
 
+/*
+    number of cycles of the memory accesses so far
+*/
+long memory_cycles()
+{
+    return ((long) game_numIterations * MEM_DATA_WIDTH) + game_numAccesses;
+}
 
-    B. eval                                 C. write                                
-                  0   1   2   3
-    2.1.1.1     ║ 0 ║ 0 ║ 0 ║ 0 ║                                                  l1p0     l1p1           
-    2.1.1.2     ║ 0 ║ 0 ║ 0 ║ x ║           ║ x ║ 0 ║ 0 ║ 0 ║         
+/*
+    get data from memory and update statisticall data
+*/
+int accessMemory(int index, bool write, int data)
+{
+    TRACE_SCOPE("accessMemory");
 
-    
-    2.2.1.2     ║ x ║ 0 ║ 0 ║ x ║           ║ y ║ 0 ║ 0 ║ 0 ║                                       +y
-    2.2.1.3     ║ x ║ 0 ║ 0 ║ y ║           ║ x ║ y ║ 0 ║ 0 ║         
+    int distance = memory_model->distance(index);
 
-    etc.
+    if(TOGGLE) memory_toggleShift(index, distance);
 
-    == Memory Access ==        
+    game_numIterations += distance;
+    game_numAccesses += 1;
+
+    assert(write ? data > 0 : data == 0);
+    assert(index >= 0);
+    assert(index < NUM_FIELDS);
+
+    memory_model->seek(index);
+    game_fieldIndex = index;
+
+    if(write) 
+    {
+        if(TOGGLE) toggle_write(index, (char) data);
+        game_field[index] = data;
+    }
     
-    B = current, N = next = buff + 1
+    return game_field[index];
+}
 
-                            pos      buff   data        0   1   2   3       score
+/*
+    red the value of the last accessed index
+*/
+int getCurrentValue()
+{
+    return game_field[game_fieldIndex];
+}
 
-                LOAD(0)     <0>              a        ║<a>║ b ║   ║   ║
-                STORE        0       <a>     a        ║ a ║ b ║   ║   ║
-                LOAD(1)     <1>       a     <b>       ║ a ║<b>║   ║   ║
-    ------------------------------------------------------------------------------
+/* === METRICS FUNCTIONS ==== */
 
-    -->                      1        a      b        ║ a ║<b>║   ║   ║
-    2.3         STORE        1       <b>     b        ║ a ║ b ║   ║   ║
+    /*
+        Metrics
+
+        Long runs (search, score check, training, move tests) count their progress
+        in one shared struct. With METRICS enabled the struct is mapped from
+        METRICS_FILE, so other processes can read it while the run continues, and a
+        reporter thread refreshes the rates and a status line on stderr. Without
+        METRICS the counters are not updated at all.
+
+        File layout (little endian, offsets in bytes):
+
+              0  uint32  magic
+              4  uint32  version
+              8  uint64  size of the struct
+             16  uint64  iterations         (search boards, score states, games)
+             24  uint64  moves
+             32  uint64  shifts             (memory shifts of the moves of game_move)
+             40  uint64  variants
+             48  uint64  mismatches
+             56  uint64  start time         (ns, CLOCK_REALTIME)
+             64  uint64  update time        (ns, CLOCK_REALTIME)
+             72  double  iterations/s
+             80  double  moves/s
+             88  double  shifts/move        (of the moves of game_move)
+             96  char[32] name of the run
+            128  uint64  shifted moves      (moves of game_move, the others use the reference)
+    */
 
-    -->                      1        a      b        ║ a ║ b ║   ║   ║
-    2.4         STORE_NEXT   1       <n>     b        ║ a ║ b ║   ║   ║
-    2.4         CLEAR,1     <1>       n     <0>       ║ a ║<0>║   ║   ║
-    2.4         WRITE,0     <0>       n     <n>       ║<n>║ 0 ║   ║   ║
-    2.4         CLEAR        0       <0>     n        ║ n ║ 0 ║   ║   ║
+#define METRICS_MAGIC 0x7274656d
+#define METRICS_VERSION 2
 
-    -->                      1        a      b        ║ a ║ b ║   ║   ║
-    2.3         STORE        1        b      b        ║ a ║ 0 ║   ║   ║
-    2.5         CLEAR,1     <1>       b     <0>       ║ a ║<0>║   ║   ║
-    2.5         WRITE,0     <0>       b     <b>       ║<b>║ 0 ║   ║   ║
+typedef struct metrics_st
+{
+    uint32_t            magic;
+    uint32_t            version;
+    uint64_t            size;
+    _Atomic uint64_t    iterations;
+    _Atomic uint64_t    moves;
+    _Atomic uint64_t    shifts;
+    _Atomic uint64_t    variants;
+    _Atomic uint64_t    mismatches;
+    uint64_t            startTime;
+    uint64_t            updateTime;
+    double              iterationsPerSecond;
+    double              movesPerSecond;
+    double              shiftsPerMove;
+    char                name[32];
+    _Atomic uint64_t    shiftedMoves;
+} metrics_t;
+
+_Static_assert(offsetof(metrics_t, shiftedMoves) == 128, "layout of METRICS_FILE");
+
+static metrics_t metrics_local;
+static metrics_t *metrics = &metrics_local;
+static pthread_t metrics_thread;
+static atomic_bool metrics_running = false;
+
+static inline void metrics_add(_Atomic uint64_t *counter, uint64_t value)
+{
+    if(METRICS) atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
 
+static inline void metrics_set(_Atomic uint64_t *counter, uint64_t value)
+{
+    if(METRICS) atomic_store_explicit(counter, value, memory_order_relaxed);
+}
 
+uint64_t metrics_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
 
-                            pos      buff   data        0   1   2   3       score
+    return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
 
-                LOAD(3)     <3>       a     <b>       ║ a ║ 0 ║ 0 ║<b>║
-    ------------------------------------------------------------------------------
+/*
+    update the rates and print the status line
+*/
+void metrics_report(uint64_t *lastTime, uint64_t *lastIterations, uint64_t *lastMoves)
+{
+    uint64_t now        = metrics_now();
+    uint64_t iterations = atomic_load(&metrics->iterations);
+    uint64_t moves      = atomic_load(&metrics->moves);
+    uint64_t shifts     = atomic_load(&metrics->shifts);
+    uint64_t shifted    = atomic_load(&metrics->shiftedMoves);
+    double   seconds    = (double) (now - *lastTime) * 1e-9;
+
+    if(seconds > 0)
+    {
+        metrics->iterationsPerSecond = (double) (iterations - *lastIterations) / seconds;
+        metrics->movesPerSecond      = (double) (moves - *lastMoves) / seconds;
+    }
+    metrics->shiftsPerMove = shifted ? (double) shifts / (double) shifted : 0;
+    metrics->updateTime    = now;
 
-    -->                      3        a      b        ║ a ║   ║   ║ b ║
-    2.2.1.3     STORE        3       <b>     b        ║ a ║   ║   ║<b>║
+    *lastTime       = now;
+    *lastIterations = iterations;
+    *lastMoves      = moves;
 
-    -->                      3        a      b        ║ a ║   ║   ║ b ║
-    2.2.1.2     STORE_NEXT   3       <n>     b        ║ a ║   ║   ║ b ║
-    2.2.1.2     CLEAR,3     <3>       n     <0>       ║ a ║   ║   ║<0>║
-    2.2.1.2     WRITE,0     <0>       n     <n>       ║<n>║   ║   ║ 0 ║
-    2.2.1.2     CLEAR        3       <0>     n        ║ n ║   ║   ║ 0 ║
+    uint64_t elapsed = (now - metrics->startTime) / 1000000000u;
 
-    -->                      3        a      b        ║ a ║   ║   ║ b ║
-    2.2.1.3     STORE        3       <b>     b        ║ a ║   ║   ║<b>║
-    2.2.1.3     CLEAR,3     <3>       b     <0>       ║ a ║   ║   ║<0>║
-    2.2.1.3     WRITE,1     <1>       b     <b>       ║ a ║<b>║   ║   ║
+    fprintf(stderr, "\r [%s] %02" PRIu64 ":%02" PRIu64 ":%02" PRIu64 " it/s: %.3g moves/s: %.3g variants: %" PRIu64 " mismatches: %" PRIu64 " shifts/move: %.1f\033[K",
+        metrics->name, elapsed / 3600, (elapsed / 60) % 60, elapsed % 60, 
+        metrics->iterationsPerSecond, metrics->movesPerSecond, 
+        (uint64_t) atomic_load(&metrics->variants), (uint64_t) atomic_load(&metrics->mismatches), metrics->shiftsPerMove);
+}
+
+void *metrics_reporter(void *arg)
+{
+    (void) arg;
 
+    uint64_t lastTime = metrics->startTime, lastIterations = 0, lastMoves = 0;
+    int waited = 0;
 
+    while(atomic_load(&metrics_running))
+    {
+        usleep(10000);
+        waited += 10;
+
+        if(waited < METRICS_INTERVAL_MS) continue;
+
+        metrics_report(&lastTime, &lastIterations, &lastMoves);
+        waited = 0;
+    }
+
+    metrics_report(&lastTime, &lastIterations, &lastMoves);
+    fprintf(stderr, "\n");
+
+    return NULL;
+}
+
+/*
+    map the metrics file ("" or failure = in memory only)
 */
+void metrics_open()
+{
+    if(!METRICS || metrics != &metrics_local || strlen(METRICS_FILE) == 0) return;
 
-bool game_move4(move_direction_t dir)
+    int fd = open(METRICS_FILE, O_RDWR | O_CREAT, 0644);
+    if(fd < 0) return;
+
+    if(ftruncate(fd, sizeof(metrics_t)) == 0)
+    {
+        void *map = mmap(NULL, sizeof(metrics_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(map != MAP_FAILED) metrics = map;
+    }
+
+    close(fd);
+}
+
+/*
+    reset the counters and start the reporter of a run
+*/
+void metrics_begin(const char *name)
 {
-    bool start    = true;
-    bool done     = false;
-    bool hasMoved = false;
+    metrics_open();
+
+    memset(metrics, 0, sizeof(metrics_t));
+    metrics->magic     = METRICS_MAGIC;
+    metrics->version   = METRICS_VERSION;
+    metrics->size      = sizeof(metrics_t);
+    metrics->startTime = metrics->updateTime = metrics_now();
+    snprintf(metrics->name, sizeof(metrics->name), "%s", name);
+
+    if(!METRICS || atomic_load(&metrics_running)) return;
+
+    atomic_store(&metrics_running, true);
+    if(pthread_create(&metrics_thread, NULL, metrics_reporter, NULL) != 0) atomic_store(&metrics_running, false);
+}
+
+/*
+    stop the reporter, the counters stay readable until the next run
+*/
+void metrics_end()
+{
+    if(!atomic_exchange(&metrics_running, false)) return;
+
+    pthread_join(metrics_thread, NULL);
+}
+
+/* === HELPER FUNCTION  ==== */
+
+static void print_border(const char *left, const char *mid, const char *right, const char *fill)
+{
+    printf("%s", left);
+
+    for(int col = 0; col < NUM_FIELDW; col++)
+    {
+        printf("%s%s", col ? mid : "", fill);
+    }
+
+    printf("%s\n", right);
+}
+
+void print_game()
+{
+    /*
     
-    int buff      = game_signs[0];
-    int data      = game_signs[0];
-    int lane      = 0;
-    int posBase   = 0;
-    int posView   = 0;
+    ╔═══╦═══╦═══╦═══╗
+    ║ f ║ e ║ d ║ c ║
+    ╟───╫───╫───╫───╢
+    ║ b ║ a ║ 9 ║ 8 ║
+    ╟───╫───╫───╫───╢
+    ║ 7 ║ 6 ║ 5 ║ 4 ║
+    ╟───╫───╫───╫───╢
+    ║ 3 ║ 2 ║ 1 ║ 0 ║
+    ╚═══╩═══╩═══╩═══╝
     
-    do
-    {       
-        game_numSteps += 1;
+    */
 
-        bool addScore; 
-        bool setValue;
-        bool clrValue;
-        bool memWrite;
-        bool memReadB;
-        bool memReadV;
-
-        bool isBaseZero = (buff == game_signs[0]);
-        bool isViewZero = (data == game_signs[0]);
-        bool eqBaseView = (buff == data);   
-
-        int posClear;
-        int posWrite;
-        int posReadB;
-        int posReadV;
-
-        int laneWrite;
-        int laneRead;
-
-        {  
-            // Logic
-      
-            bool hasTwoTiles = !start && !isBaseZero && !isViewZero;
-            bool canMerge    = hasTwoTiles && eqBaseView;
-            bool hasGap      = hasTwoTiles && (posView - posBase > 1);
-            bool moveTile    = !start && !isViewZero && (isBaseZero || canMerge || hasGap);
-            bool advanceBase = !canMerge && hasGap; 
-
-            int posBaseNextValue = posBase + 1;
-            int posViewNextValue = posView + 1;
-            int laneNextValue    = lane    + 1;
-            
-            int incLane      = (posViewNextValue >= NUM_FIELDW);
-            done             = (laneNextValue    >= NUM_FIELDW) && incLane;
-            int posBaseRead  = start || incLane ? 0 : posBase;
-            int posBaseWrite = advanceBase ? posBaseNextValue : posBase;
-
-            int laneNext     = incLane ? laneNextValue : lane;
-            int posBaseNext  = incLane ? 0 : (hasTwoTiles ? posBaseNextValue : posBase);
-            int posViewNext  = incLane ? 1 : posViewNextValue;
-            
-            // Plumbing
-
-            setValue = (hasTwoTiles || moveTile);
-            memWrite = moveTile;
-            addScore = canMerge;
-            memReadB = !done && (start || incLane);
-            memReadV = !done;
-            clrValue = !memReadB && addScore;
-
-            laneWrite= lane;
-            laneRead = laneNext;
-            posClear = posView;
-            posWrite = posBaseWrite;
-            posReadB = posBaseRead;
-            posReadV = posViewNext;
-
-            // Set values
-
-            start    = false;
-            lane     = laneNext;
-            posBase  = posBaseNext;
-            posView  = posViewNext;
-            hasMoved = hasMoved || moveTile;  
-        }
-        
-        // Process
-        int nextValue = getSignValue(buff) + 1; 
-        int next      = game_signs[nextValue];
+    print_border("╔", "╦", "╗", "═══");
 
-        // Memory
-        if(setValue) buff = addScore ? next : data;
+    for(int row = NUM_FIELDW - 1; row >= 0; row--)
+    {
+        for(int col = NUM_FIELDW - 1; col >= 0; col--)
+        {
+            printf("║ %c ", game_field[(row * NUM_FIELDW) + col]);
+        }
+        printf("║\n");
 
-        int indexClear = computeIndex(laneWrite, posClear, dir);
-        int indexWrite = computeIndex(laneWrite, posWrite, dir);
-        int indexReadB = computeIndex(laneRead,  posReadB, dir);
-        int indexReadV = computeIndex(laneRead,  posReadV, dir);
+        if(row > 0) print_border("╟", "╫", "╢", "───");
+    }
 
-        if(memWrite) accessMemory(indexClear, true, game_signs[0]);
-        if(memWrite) accessMemory(indexWrite, true, buff);
+    print_border("╚", "╩", "╝", "═══");
+}
 
-        if(addScore) game_addScore(nextValue); 
+void print_lane(int lane, int dir)
+{
+    printf("║");
 
-        if(clrValue) buff = game_signs[0];       
-        if(memReadB) buff = accessMemory(indexReadB, false, 0);
-        if(memReadV) data = accessMemory(indexReadV, false, 0);  
-           
+    for(int pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        printf("%s %c ", pos ? "|" : "", game_field[computeIndex(lane, pos, dir)]);
     }
-    while(!done);
 
-    if(DEBUG_MOVE && debug) print_game();
+    printf("║");
+}
 
-    if(hasMoved) game_lastMove = dir;
+void printBits(size_t const size, void const * const ptr)
+{
+    unsigned char *b = (unsigned char*) ptr;
+    unsigned char byte;
+    int i, j;
     
-    return hasMoved;
+    for (i = size-1; i >= 0; i--) {
+        for (j = 7; j >= 0; j--) {
+            byte = (b[i] >> j) & 1;
+            printf("%u", byte);
+        }
+    }
 }
 
-bool game_move3(move_direction_t dir)
+/* === RENDER FUNCTIONS ==== */
+
+    /*
+        Incremental renderer
+
+        The frame is drawn once, after that only the cells which differ from
+        the last drawn frame are updated by positioning the cursor:
+
+            row 1               score: ddddddd
+            row 2               ╔═══╦═══╦═══╦═══╗
+            row 3 + 2 * y       ║ t ║ t ║ t ║ t ║     (tile at column 3 + 4 * x)
+            row 3 + 2 * NUM_FIELDW  last spawn / last move / step
+    */
+
+#define RENDER_ROW_SCORE   1
+#define RENDER_COL_SCORE   8
+#define RENDER_ROW_BOARD   2
+#define RENDER_ROW_STATUS  (RENDER_ROW_BOARD + (2 * NUM_FIELDW) + 1)
+
+static bool render_valid = false;
+static char render_field[NUM_FIELDS];
+static char render_score[NUM_SCORE];
+static char render_status[64];
+static struct timespec render_lastFrame;
+
+void render_moveCursor(int row, int col)
 {
-    bool hasMoved = false;
-    
-    int buff     = game_signs[0];
-    int data     = game_signs[0];
-    int lane     = 0;
-    int posBase  = 0;
-    int posView  = 0;
-    
-    bool start = true;
-    bool done = false;
+    printf("\033[%d;%dH", row, col);
+}
 
-    if(DEBUG_MOVE && debug) printf("dir: %s\n", game_moveLabels[dir]);
-    if(DEBUG_MOVE && debug) print_game();
+/*
+    draws the whole frame and remembers its content
+*/
+void render_full(const char *status)
+{
+    printf("\033[H\033[2J");
+    printf("score: %s\n", game_score);
+    print_game();
+    printf("%s\n", status);
 
-    do
-    {       
-        game_numSteps += 1;
+    memcpy(render_field, game_field, NUM_FIELDS);
+    memcpy(render_score, game_score, NUM_SCORE);
+    strncpy(render_status, status, sizeof(render_status) - 1);
 
-        // Logic
-        bool isBaseZero  = (buff == game_signs[0]);
-        bool isViewZero  = (data == game_signs[0]);    
-        bool eqBaseView  = (buff == data);        
-        bool hasTwoTiles = !start && !isBaseZero && !isViewZero;
-        bool canMerge    = hasTwoTiles && eqBaseView;
-        bool hasGap      = hasTwoTiles && (posView - posBase > 1);
-        bool moveTile    = !start && !isViewZero && (isBaseZero || canMerge || hasGap);
+    render_valid = true;
+}
 
-        int posBaseNext  = posBase + 1;
-        int posViewNext  = posView + 1;
-        int laneNext     = lane + 1;
-        int incLane      = (posViewNext >= NUM_FIELDW);
-        done             = incLane && (laneNext >= NUM_FIELDW);
-        int posBaseRead  = start || incLane ? 0 : posBase;
-        int posBaseWrite = !canMerge && hasGap ? posBaseNext : posBase;
+/*
+    redraws the changed tiles, score digits and the status line
 
-        int nextLane     = incLane ? laneNext : lane;
-        int nextPosBase  = incLane ? 0 : (hasTwoTiles ? posBaseNext : posBase);
-        int nextPosView  = incLane ? 1 : posViewNext;
-        
-        // Process
-        int nextValue = getSignValue(data) + 1; 
-        int next      = game_signs[nextValue];
-        if(canMerge) game_addScore(nextValue); 
+    force   ignore RENDER_INTERVAL (e.g. for the last frame of a game)
+*/
+void render_game(size_t step, bool force)
+{
+    game_scoreRefresh();
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    long elapsed = ((now.tv_sec - render_lastFrame.tv_sec) * 1000) + ((now.tv_nsec - render_lastFrame.tv_nsec) / 1000000);
+
+    if(render_valid && !force && RENDER_INTERVAL > 0 && elapsed < RENDER_INTERVAL) return;
+
+    render_lastFrame = now;
+
+    char status[sizeof(render_status)] = {0};
+    snprintf(status, sizeof(status), "last spawn: %2d last move: %s step: %zu", game_lastSpawn, game_moveLabels[game_lastMove], step);
+
+    if(!render_valid)
+    {
+        render_full(status);
+        fflush(stdout);
+        return;
+    }
+
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(render_field[i] == game_field[i]) continue;
+
+        int x = NUM_FIELDW - (i % NUM_FIELDW) - 1;
+        int y = NUM_FIELDW - (i / NUM_FIELDW) - 1;
+
+        render_moveCursor(RENDER_ROW_BOARD + 1 + (2 * y), 3 + (4 * x));
+        putchar(game_field[i]);
+        render_field[i] = game_field[i];
+    }
+
+    for(int i = 0; i < NUM_SCORE; i++)
+    {
+        if(render_score[i] == game_score[i]) continue;
+
+        render_moveCursor(RENDER_ROW_SCORE, RENDER_COL_SCORE + i);
+        putchar(game_score[i]);
+        render_score[i] = game_score[i];
+    }
+
+    if(strcmp(render_status, status) != 0)
+    {
+        render_moveCursor(RENDER_ROW_STATUS, 1);
+        printf("%s\033[K", status);
+        strcpy(render_status, status);
+    }
+
+    render_moveCursor(RENDER_ROW_STATUS + 1, 1);
+    fflush(stdout);
+}
+
+/* === GAME FUNCTIONS ==== */
+
+/*
+    clears the board, the score and the statistics
+ */
+void game_reset()
+{
+    memset(game_field, getSign(0), NUM_FIELDS);
+    game_field[NUM_FIELDS] = '\0';
+    strncpy(game_score, "      0", NUM_SCORE + 1);
+    memory_reset();
+    game_numIterations = 0;
+    game_numSteps = 0;
+    game_numAccesses = 0;
+    game_scoreBinary = 0;
+    game_scoreWrapped = false;
+    game_scoreConverted = true;
+    memcpy(game_scoreShown, game_score, NUM_SCORE + 1);
+    game_numScoreCarries = 0;
+    game_lastMove = 0;
+}
+
+
+/* = SPAWN = */
+
+/*
+    spawn new tiles using time based rand
+ */
+void spawn_timerandom()
+{
+    int numSpotsLeft = 0;
+
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(game_field[i] == getSign(0)) numSpotsLeft++;
+    }
+
+    if (numSpotsLeft > 0)
+    {
+        srand((unsigned int) time(NULL));
+
+        // 10% chance for 4, else 2
+        int value = (rand() % 10 == 0) ? 2 : 1;
+
+        int spot = rand() % numSpotsLeft;
+        int s = 0;
+
+        for (int i = 0; i < NUM_FIELDS; i++)
+        {
+            if (game_field[i] == getSign(0))
+            {
+                if (s == spot) 
+                {
+                    game_field[i] = getSign(value);
+                    game_lastSpawn = value;
+                    return;
+                }
+
+                s += 1;
+            }
+        }
+        printf("s: %d\n", s);
+    }
+}
+
+/*
+    select where to spawn a new tile
+ */
+void spawn_manual()
+{
+    bool spawned = false;
+    int spawn;
+    bool spawn4 = false;
+
+    printf("\rspawn?> ");
+
+    do
+    {
+        int ch = GETCH();
+
+        if(ch == KEY_EOF) exit(EXIT_FAILURE);
+        
+        if(ch >= 'a' && ch < 'a' + NUM_FIELDS)      spawn = ch - 'a';
+        else if(ch >= 'A' && ch < 'A' + NUM_FIELDS) { spawn = ch - 'A'; spawn4 = true; }
+        else continue;
+
+        if(spawn < NUM_FIELDS && game_field[spawn] == getSign(0))
+        {
+            game_lastSpawn = spawn;
+            spawned = true;
+            game_field[spawn] = spawn4 ? getSign(2) : getSign(1);
+        }
+
+    } while(!spawned);
+
+}
+
+/*
+    spawn new tiles using  linear feedback shift register 
+ */
+void spawn_tetrisrng()
+{
+  game_rng_value = ((((game_rng_value >> 9) & 1) ^ ((game_rng_value >> 1) & 1)) << 15) | (game_rng_value >> 1);
+}
+
+/*
+    The linear feedback shift register is linear over GF(2): one step is a
+    multiplication of the state with a 16x16 bit matrix
+
+        out[i]  = in[i + 1]             i < 15
+        out[15] = in[9] ^ in[1]
+
+    A matrix is stored as 16 rows, row i holds the input bits which are xored
+    into output bit i. N steps are the matrix to the power of N, which takes
+    O(log N) matrix multiplications.
+*/
+
+typedef struct rng_matrix_st
+{
+    uint16_t row[16];
+} rng_matrix_t;
+
+/*
+    matrix of a single step of spawn_tetrisrng
+*/
+rng_matrix_t rng_matrixStep()
+{
+    rng_matrix_t m;
+
+    for(int i = 0; i < 15; i++) m.row[i] = (uint16_t) (1 << (i + 1));
+    m.row[15] = (1 << 9) | (1 << 1);
+
+    return m;
+}
+
+rng_matrix_t rng_matrixIdentity()
+{
+    rng_matrix_t m;
+
+    for(int i = 0; i < 16; i++) m.row[i] = (uint16_t) (1 << i);
+
+    return m;
+}
+
+/*
+    a * b (b is applied first)
+*/
+rng_matrix_t rng_matrixMul(rng_matrix_t a, rng_matrix_t b)
+{
+    rng_matrix_t m;
+
+    for(int i = 0; i < 16; i++)
+    {
+        uint16_t row = 0;
+
+        for(int j = 0; j < 16; j++)
+        {
+            if(a.row[i] & (1 << j)) row ^= b.row[j];
+        }
+
+        m.row[i] = row;
+    }
+
+    return m;
+}
+
+uint16_t rng_matrixApply(rng_matrix_t m, uint16_t value)
+{
+    uint16_t result = 0;
+
+    for(int i = 0; i < 16; i++)
+    {
+        result |= (uint16_t) ((__builtin_parity(m.row[i] & value)) << i);
+    }
+
+    return result;
+}
+
+/*
+    advance the register by steps in O(log steps)
+*/
+uint16_t rng_jump(uint16_t value, uint64_t steps)
+{
+    rng_matrix_t result = rng_matrixIdentity();
+    rng_matrix_t power  = rng_matrixStep();
+
+    for(; steps; steps >>= 1)
+    {
+        if(steps & 1) result = rng_matrixMul(power, result);
+        power = rng_matrixMul(power, power);
+    }
+
+    return rng_matrixApply(result, value);
+}
+
+/*
+    result of the period analysis of all 2^16 states
+*/
+typedef struct rng_analysis_st
+{
+    int cycleLength;        // length of the cycle reached from RNG_SEED
+    int tailLength;         // steps from RNG_SEED until the cycle is reached
+    int numNoPredecessor;   // states no other state leads to
+    int numNotOnCycle;      // states which are left and never reached again
+    int numCycles;          // number of different cycles
+} rng_analysis_t;
+
+rng_analysis_t rng_analyze()
+{
+    rng_analysis_t analysis = {0};
+
+    // scratch of the call, may run on several threads
+    int32_t *firstSeen      = malloc(sizeof(int32_t) << 16);
+    uint8_t *hasPredecessor = calloc(1 << 16, 1);
+    uint8_t *isOnCycle      = malloc(1 << 16);
+    uint8_t *nextOnCycle    = malloc(1 << 16);
+
+    assert(firstSeen && hasPredecessor && isOnCycle && nextOnCycle);
+
+    rng_matrix_t step = rng_matrixStep();
+
+    memset(firstSeen, 0xff, sizeof(int32_t) << 16);
+
+    // cycle and tail of the seed
+    uint16_t value  = RNG_SEED;
+    int32_t numSeen = 0;
+
+    while(firstSeen[value] < 0)
+    {
+        firstSeen[value] = numSeen++;
+        value = rng_matrixApply(step, value);
+    }
+
+    analysis.tailLength  = firstSeen[value];
+    analysis.cycleLength = numSeen - analysis.tailLength;
+
+    // states without predecessor
+    for(int s = 0; s < (1 << 16); s++)
+    {
+        hasPredecessor[rng_matrixApply(step, (uint16_t) s)] = 1;
+    }
+
+    // states on a cycle: the image of the map applied until it does not shrink anymore
+    memset(isOnCycle, 1, 1 << 16);
+    for(bool changed = true; changed; )
+    {
+        memset(nextOnCycle, 0, 1 << 16);
+
+        for(int s = 0; s < (1 << 16); s++)
+        {
+            if(isOnCycle[s]) nextOnCycle[rng_matrixApply(step, (uint16_t) s)] = 1;
+        }
+
+        changed = memcmp(isOnCycle, nextOnCycle, 1 << 16) != 0;
+        memcpy(isOnCycle, nextOnCycle, 1 << 16);
+    }
+
+    // count the cycles by walking each one once
+    memset(nextOnCycle, 0, 1 << 16);
+    for(int s = 0; s < (1 << 16); s++)
+    {
+        if(!hasPredecessor[s]) analysis.numNoPredecessor++;
+        if(!isOnCycle[s])      analysis.numNotOnCycle++;
+
+        if(isOnCycle[s] && !nextOnCycle[s])
+        {
+            analysis.numCycles++;
+
+            for(uint16_t v = (uint16_t) s; !nextOnCycle[v]; v = rng_matrixApply(step, v)) nextOnCycle[v] = 1;
+        }
+    }
+
+    free(firstSeen);
+    free(hasPredecessor);
+    free(isOnCycle);
+    free(nextOnCycle);
+
+    return analysis;
+}
+
+static int rng_length = 0;
+static pthread_once_t rng_lengthOnce = PTHREAD_ONCE_INIT;
+
+static void rng_initLength()
+{
+    rng_analysis_t analysis = rng_analyze();
+    rng_length = analysis.tailLength + analysis.cycleLength;
+}
+
+/*
+    number of different values of the sequence of RNG_SEED (tail + cycle), analysed once
+*/
+int rng_sequenceLength()
+{
+    pthread_once(&rng_lengthOnce, rng_initLength);
+
+    return rng_length;
+}
+
+/*
+    select one of numStreams non overlapping parts of the sequence of RNG_SEED
+
+    each stream has (tail + cycle) / numStreams values, so parallel runs reproduce
+    the spawn sequence of the hardware without sharing values
+*/
+void spawn_tetrisrng_stream(int stream, int numStreams)
+{
+    assert(stream >= 0 && stream < numStreams);
+
+    uint64_t streamLength = (uint64_t) rng_sequenceLength() / (uint64_t) numStreams;
+    game_rng_value = rng_jump(RNG_SEED, (uint64_t) stream * streamLength);
+}
+
+void spawn()
+{
+    TRACE_SCOPE("spawn");
+
+    if(SPAWN == 0) return spawn_manual();
+    if(SPAWN == 1) return spawn_timerandom();
+    if(SPAWN == 2) return spawn_tetrisrng();
+
+    assert(false);
+}
+
+
+/* = SCORE = */
+
+uint8_t game_addScore1(int addScoreBit)
+{
+    uint8_t decSep   = 0;
+    uint8_t carries  = 0;
+    bool carry   = false;
+    int addScore = 1 << addScoreBit;
+
+    game_scoreAddCycles += NUM_SCORE;
+    
+    if(DEBUG_SCORE && debug) printf("'%s' + %2d(%6d)\n", game_score, addScoreBit, addScore);
+
+    for(int ctr = NUM_SCORE -1; ctr >= 0; ctr--)
+    {
+        int  pos        = NUM_SCORE - ctr - 1;
+        char cOld       = game_score[ctr];     
+        bool isOldEmtpy = game_score[ctr] == ' ';
+
+        int vOld;
+        switch(game_score[ctr])
+        {
+            case ' ':
+            case '0': vOld = 0; break;
+            case '1': vOld = 1; break;
+            case '2': vOld = 2; break;
+            case '3': vOld = 3; break;
+            case '4': vOld = 4; break;
+            case '5': vOld = 5; break;
+            case '6': vOld = 6; break;
+            case '7': vOld = 7; break;
+            case '8': vOld = 8; break;
+            case '9': vOld = 9; break;
+        }
+
+        int vAdd   = addScore % 10;
+        int nNew   = vOld + vAdd + carry;
+        int vNew   =  nNew % 10;
+        carry      = (nNew / 10) > 0;
+        if(carry) carries |= 1 << pos;
+
+        char cNew = ' ';
+        bool isNewEmpty = (isOldEmtpy && !carry && vNew == 0);
+
+        if(!isNewEmpty)
+        {
+            switch(vNew)
+            {
+                case 0: cNew = '0'; break;
+                case 1: cNew = '1'; break;
+                case 2: cNew = '2'; break;
+                case 3: cNew = '3'; break;
+                case 4: cNew = '4'; break;
+                case 5: cNew = '5'; break;
+                case 6: cNew = '6'; break;
+                case 7: cNew = '7'; break;
+                case 8: cNew = '8'; break;
+                case 9: cNew = '9'; break;
+            }
+        }
+
+        bool isDecSepPos = (pos == 3 || pos == 6);
+        bool hasDecSep   = isDecSepPos && !isNewEmpty;
+
+        if(DEBUG_SCORE && debug) printf(" %d:'%c'(%2d)  + %2d = '%c'(%6d) (+%d) %c\n", pos, cOld, vOld, vAdd, cNew, vNew, carry, hasDecSep ? '.' : ' ');
+
+        game_score[ctr] = cNew;
+        addScore = addScore / 10;
+        if(hasDecSep) decSep |= 1 << pos;
+
+    }
+    if(DEBUG_SCORE && debug) printf("%s ",game_score);
+    if(DEBUG_SCORE && debug) printBits(sizeof(uint8_t), &decSep);
+    if(DEBUG_SCORE && debug) printf(" ");
+    if(DEBUG_SCORE && debug) for(int i = 0; i < NUM_SCORE; i++) { printf("%c", game_score[i]); if(decSep & (1 << (NUM_SCORE - i - 1)))  printf("."); }
+    if(DEBUG_SCORE && debug) printf("\n");
+
+    if(game_numScoreCarries < NUM_FIELDS) game_scoreCarries[game_numScoreCarries++] = carries;
+
+    return decSep;
+}
+
+uint8_t game_addScore_ref(int value)
+{
+    uint8_t decSep   = 0;
+    int currentScore = atol(game_score);
+    int currentValue = 1 << value;
+    int newScore = currentScore + currentValue;
+
+    if(DEBUG_SCORE && debug) printf("'%s' + %2d(%6d) = ", game_score, value, currentValue);
+
+    if(newScore >= 1000)    decSep |= 1 << 3;
+    
+    if(newScore >= 1000000) 
+    {
+        decSep |= 1 << 6;
+        snprintf(game_score, NUM_SCORE+1, "%07d", newScore % 10000000);
+    }
+    else
+    {
+        snprintf(game_score, NUM_SCORE+1, "%7d", newScore);
+    }
+
+    if(DEBUG_SCORE && debug) printf("'%s' ( %7d ) ", game_score, newScore, currentValue);
+    if(DEBUG_SCORE && debug) printf("[");
+    if(DEBUG_SCORE && debug) printBits(sizeof(uint8_t), &decSep);
+    if(DEBUG_SCORE && debug) printf("] -> '");
+    if(DEBUG_SCORE && debug) for(int i = 0; i < NUM_SCORE; i++) { printf("%c", game_score[i]); if(decSep & (1 << (NUM_SCORE - i - 1)))  printf("."); }
+
+    if(DEBUG_SCORE && debug) printf("'\n");
+    if(DEBUG_SCORE && debug) printf(" %7d\n", currentScore);
+
+    return decSep;
+}
+
+
+
+/*
+    Binary score datapath (v2)
+
+    The score is kept in a binary register and added with one binary adder,
+    the display digits are converted with double dabble (shift and add 3)
+    only when the display needs them:
+
+        score       SCORE_BINARY_BITS bit register, wraps at SCORE_MODULO
+        wrapped     flag, set once the score wrapped around
+        bcd         NUM_SCORE x 4 bit, shifted left once per conversion cycle
+        counter     conversion cycles left
+
+    Adding takes one cycle for the adder and one for the wrap around
+    (compare and subtract), a conversion SCORE_BINARY_BITS cycles with one
+    add-3 unit per digit. v1 adds digit by digit, one cycle per digit.
+
+    The register is the state, game_score is only written by
+    game_scoreRefresh (after a move, before the display is drawn or read).
+    A game_score written from outside (reset, tests, the library) is loaded
+    into the register by the next add.
+*/
+
+#define SCORE_BINARY_BITS 24
+#define SCORE_MODULO 10000000
+#define SCORE_ADD_CYCLES 2
+#define SCORE_CONVERT_CYCLES SCORE_BINARY_BITS
+
+/*
+    convert binary to packed BCD (4 bit per digit, digit 0 = lowest)
+*/
+uint32_t score_doubleDabble(uint32_t binary)
+{
+    uint32_t bcd = 0;
+
+    for(int bit = SCORE_BINARY_BITS - 1; bit >= 0; bit--)
+    {
+        for(int digit = 0; digit < NUM_SCORE; digit++)
+        {
+            if(((bcd >> (4 * digit)) & 0xf) >= 5) bcd += 3u << (4 * digit);
+        }
+
+        bcd = (bcd << 1) | ((binary >> bit) & 1);
+    }
+
+    game_scoreConvertCycles += SCORE_CONVERT_CYCLES;
+
+    return bcd;
+}
+
+/*
+    load the register from a game_score written from outside (blanks are 0)
+*/
+void game_scoreLoad()
+{
+    game_scoreBinary = 0;
+
+    for(int i = 0; i < NUM_SCORE; i++)
+    {
+        game_scoreBinary = (game_scoreBinary * 10) + (isdigit((unsigned char) game_score[i]) ? (uint32_t) (game_score[i] - '0') : 0);
+    }
+
+    memcpy(game_scoreShown, game_score, NUM_SCORE + 1);
+    game_scoreConverted = true;
+}
+
+uint8_t game_addScore2(int value)
+{
+    if(memcmp(game_score, game_scoreShown, NUM_SCORE) != 0) game_scoreLoad();
+
+    uint32_t sum  = game_scoreBinary + (1u << value);
+    bool     wrap = sum >= SCORE_MODULO;
+
+    assert(sum < (1u << SCORE_BINARY_BITS));
+
+    game_scoreAddCycles += SCORE_ADD_CYCLES;
+    game_scoreWrapped   |= wrap;
+
+    uint8_t decSep = 0;
+    if(sum >= 1000)    decSep |= 1 << 3;
+    if(sum >= 1000000) decSep |= 1 << 6;
+
+    // leading digits are shown as 0 if the score has all digits
+    game_scorePadded    = sum >= 1000000;
+    game_scoreBinary    = wrap ? sum - SCORE_MODULO : sum;
+    game_scoreConverted = false;
+
+    return decSep;
+}
+
+/*
+    convert the register to game_score if it changed since the last conversion
+*/
+void game_scoreRefresh()
+{
+    if(game_scoreConverted) return;
+
+    uint32_t bcd = score_doubleDabble(game_scoreBinary);
+
+    for(int pos = NUM_SCORE - 1; pos >= 0; pos--)
+    {
+        int  digit   = (bcd >> (4 * pos)) & 0xf;
+        bool leading = (bcd >> (4 * pos)) == 0 && pos > 0;
+
+        game_score[NUM_SCORE - pos - 1] = (leading && !game_scorePadded) ? ' ' : (char) ('0' + digit);
+    }
+
+    memcpy(game_scoreShown, game_score, NUM_SCORE + 1);
+    game_scoreConverted = true;
+}
+
+uint8_t game_addScore(int value)
+{
+    TRACE_SCOPE("game_addScore");
+
+    if(game_scoreVersion == 2) return game_scoreDecSep = game_addScore2(value);
+    if(game_scoreVersion == 1) return game_scoreDecSep = game_addScore1(value);
+    if(game_scoreVersion == 0) return game_scoreDecSep = game_addScore_ref(value);
+
+    assert(false);
+}
+
+
+/* = MOVE = */
+
+/*
+    uses a buffer to hold a value and the current shift register value to updat the field based on the move
+    only two values are loaded each step. A field is loaded into Base and then compared with View. View itereates
+    over all elements. Base is adopted if tiles where moved or merged.
+
+    # Evaluation #
+
+    position    0   1   2   3 
+
+                ╟───╫───╫───╫───╢
+    lane        ║ B ║ V ║   ║   ║   <-- move direction
+                ╟───╫───╫───╫───╢
+
+              
+    A. fetch                                                                        B       V       score   posBase
+                                                                                    p0      p1              0                      
+
+
+    B. eval                                 C. write                    D. next     a       d
+                  0   1   2   3              
+    2.1         ║ 0 ║ 0 ║   ║   ║                                                           p2              0
+    2.2         ║ x ║ 0 ║   ║   ║                                                           p2              0
+    2.3         ║ x ║ y ║   ║   ║                                                   d       p2              1
+    2.4         ║ x ║ x ║   ║   ║           ║ y ║ 0 ║   ║   ║                       0       p2      +y      1
+    2.5         ║ 0 ║ y ║   ║   ║           ║ y ║ 0 ║   ║   ║                       d       p2              0
+
+
+    B. eval                                 C. write                    D. next     a       d
+                  0   1   2   3
+    2.1.1       ║ 0 ║ 0 ║ 0 ║   ║                                                           p3              0
+    2.1.2       ║ 0 ║ 0 ║ x ║   ║           ║ x ║ 0 ║ 0 ║   ║                       d       p3              0
+
+    2.2.1       ║ x ║ 0 ║ 0 ║   ║                                                           p3              0
+    2.2.2       ║ x ║ 0 ║ x ║   ║           ║ y ║ 0 ║ 0 ║   ║                       d       p3      +y      1
+    2.2.3       ║ x ║ 0 ║ y ║   ║           ║ x ║ y ║ 0 ║   ║                       0       p3              1
+    
+    2.3.1       ║ x ║ y ║ 0 ║   ║                                                           p3              1
+    2.3.2       ║ x ║ y ║ x ║   ║                                                           p3              2
+    2.3.3       ║ x ║ y ║ y ║   ║           ║ x ║ z ║   ║   ║                       d       p3      +z      2
+
+    2.4.1       ║ y ║ 0 ║ 0 ║   ║                                                           p3              1
+    2.4.2       ║ y ║ 0 ║ x ║   ║           ║ y ║ x ║ 0 ║   ║                       d       p3              1
+    2.4.3       ║ y ║ 0 ║ y ║   ║           ║ y ║ y ║ 0 ║   ║                       0       p3              1
+
+    2.5.1       ║ y ║ 0 ║ 0 ║   ║                                                           p3              0
+    2.5.2       ║ y ║ 0 ║ x ║   ║           ║ y ║ x ║ 0 ║   ║                       d       p3              1
+    2.5.3       ║ y ║ 0 ║ y ║   ║           ║ z ║ 0 ║ 0 ║   ║                       d       p3              1
+
+
+    B. eval                                 C. write                                
+                  0   1   2   3
+    2.1.1.1     ║ 0 ║ 0 ║ 0 ║ 0 ║                                                  l1p0     l1p1           
+    2.1.1.2     ║ 0 ║ 0 ║ 0 ║ x ║           ║ x ║ 0 ║ 0 ║ 0 ║         
+
+    
+    2.2.1.2     ║ x ║ 0 ║ 0 ║ x ║           ║ y ║ 0 ║ 0 ║ 0 ║                                       +y
+    2.2.1.3     ║ x ║ 0 ║ 0 ║ y ║           ║ x ║ y ║ 0 ║ 0 ║         
+
+    etc.
+
+    == Memory Access ==        
+    
+    B = current, N = next = buff + 1
+
+                            pos      buff   data        0   1   2   3       score
+
+                LOAD(0)     <0>              a        ║<a>║ b ║   ║   ║
+                STORE        0       <a>     a        ║ a ║ b ║   ║   ║
+                LOAD(1)     <1>       a     <b>       ║ a ║<b>║   ║   ║
+    ------------------------------------------------------------------------------
+
+    -->                      1        a      b        ║ a ║<b>║   ║   ║
+    2.3         STORE        1       <b>     b        ║ a ║ b ║   ║   ║
+
+    -->                      1        a      b        ║ a ║ b ║   ║   ║
+    2.4         STORE_NEXT   1       <n>     b        ║ a ║ b ║   ║   ║
+    2.4         CLEAR,1     <1>       n     <0>       ║ a ║<0>║   ║   ║
+    2.4         WRITE,0     <0>       n     <n>       ║<n>║ 0 ║   ║   ║
+    2.4         CLEAR        0       <0>     n        ║ n ║ 0 ║   ║   ║
+
+    -->                      1        a      b        ║ a ║ b ║   ║   ║
+    2.3         STORE        1        b      b        ║ a ║ 0 ║   ║   ║
+    2.5         CLEAR,1     <1>       b     <0>       ║ a ║<0>║   ║   ║
+    2.5         WRITE,0     <0>       b     <b>       ║<b>║ 0 ║   ║   ║
+
+
+
+                            pos      buff   data        0   1   2   3       score
+
+                LOAD(3)     <3>       a     <b>       ║ a ║ 0 ║ 0 ║<b>║
+    ------------------------------------------------------------------------------
+
+    -->                      3        a      b        ║ a ║   ║   ║ b ║
+    2.2.1.3     STORE        3       <b>     b        ║ a ║   ║   ║<b>║
+
+    -->                      3        a      b        ║ a ║   ║   ║ b ║
+    2.2.1.2     STORE_NEXT   3       <n>     b        ║ a ║   ║   ║ b ║
+    2.2.1.2     CLEAR,3     <3>       n     <0>       ║ a ║   ║   ║<0>║
+    2.2.1.2     WRITE,0     <0>       n     <n>       ║<n>║   ║   ║ 0 ║
+    2.2.1.2     CLEAR        3       <0>     n        ║ n ║   ║   ║ 0 ║
+
+    -->                      3        a      b        ║ a ║   ║   ║ b ║
+    2.2.1.3     STORE        3       <b>     b        ║ a ║   ║   ║<b>║
+    2.2.1.3     CLEAR,3     <3>       b     <0>       ║ a ║   ║   ║<0>║
+    2.2.1.3     WRITE,1     <1>       b     <b>       ║ a ║<b>║   ║   ║
+
+
+*/
+
+/*
+    Logic table
+
+    The decision of a step only depends on 7 conditions, the logic is a table
+    of 128 decisions. The table is computed from the equations in move4_decide,
+    the emulator only looks up the table and move4_writeLogic generates the
+    same table as SystemVerilog (MoveLogic.sv).
+*/
+
+// conditions (bit of the table index)
+typedef enum move4_condition_en {
+    MOVE4_C_START       = 0,    // first step of the move
+    MOVE4_C_BASE_ZERO   = 1,    // buff is empty
+    MOVE4_C_VIEW_ZERO   = 2,    // data is empty
+    MOVE4_C_EQUAL       = 3,    // buff == data
+    MOVE4_C_GAP         = 4,    // posView - posBase > 1
+    MOVE4_C_LAST_POS    = 5,    // posView is the last position of the lane
+    MOVE4_C_LAST_LANE   = 6,    // lane is the last lane
+    MOVE4_NUM_CONDITIONS = 7,
+} move4_condition_t;
+
+// decisions (bit of a table entry)
+typedef enum move4_decision_en {
+    MOVE4_D_SET_VALUE      = 1 << 0,     // buff = merged or data
+    MOVE4_D_MEM_WRITE      = 1 << 1,     // clear posView, write buff to posBase(+1)
+    MOVE4_D_ADD_SCORE      = 1 << 2,     // merge
+    MOVE4_D_MEM_READ_B     = 1 << 3,     // read buff
+    MOVE4_D_MEM_READ_V     = 1 << 4,     // read data
+    MOVE4_D_CLR_VALUE      = 1 << 5,     // clear buff
+    MOVE4_D_DONE           = 1 << 6,     // last step
+    MOVE4_D_BASE_WRITE_INC = 1 << 7,     // write to posBase + 1
+    MOVE4_D_BASE_INC       = 1 << 8,     // posBase + 1
+    MOVE4_D_LANE_INC       = 1 << 9,     // next lane, posBase = 0, posView = 1
+    MOVE4_D_BASE_READ_ZERO = 1 << 10,    // read buff from position 0
+    MOVE4_NUM_DECISIONS    = 11,
+} move4_decision_t;
+
+static const char *move4_conditionNames[MOVE4_NUM_CONDITIONS] = {
+    "start", "isBaseZero", "isViewZero", "eqBaseView", "hasGap", "incLane", "lastLane"
+};
+
+static const char *move4_decisionNames[MOVE4_NUM_DECISIONS] = {
+    "setValue", "memWrite", "addScore", "memReadB", "memReadV", "clrValue", 
+    "done", "baseWriteInc", "baseInc", "laneInc", "baseReadZero"
+};
+
+#define MOVE4_TABLE_SIZE (1 << MOVE4_NUM_CONDITIONS)
+
+static uint16_t move4_table[MOVE4_TABLE_SIZE];
+
+/*
+    Coverage
+
+    Every step counts its condition index and marks the pair of the previous
+    and the current condition (the first step of a move has the previous
+    condition MOVE4_TABLE_SIZE). Pairs capture sequences like a merge followed
+    by a lane increment.
+
+    Only recorded while move4_recordCoverage is set (fuzz_search, compact_init),
+    the step of a normal move is the table lookup alone.
+*/
+static _Thread_local bool     move4_recordCoverage = false;
+static _Thread_local uint32_t move4_coverage[MOVE4_TABLE_SIZE];
+static _Thread_local uint8_t  move4_pairCoverage[MOVE4_TABLE_SIZE + 1][MOVE4_TABLE_SIZE];
+static _Thread_local int      move4_numConditions = 0;
+static _Thread_local int      move4_numPairs = 0;
+
+// conditions of the steps of the last move (recorded with the coverage)
+#define MOVE4_MAX_PATH 256
+static _Thread_local uint8_t  move4_path[MOVE4_MAX_PATH];
+static _Thread_local int      move4_pathLength = 0;
+
+/*
+    decision of a step for a set of conditions
+*/
+uint16_t move4_decide(int condition)
+{
+    bool start      = condition & (1 << MOVE4_C_START);
+    bool isBaseZero = condition & (1 << MOVE4_C_BASE_ZERO);
+    bool isViewZero = condition & (1 << MOVE4_C_VIEW_ZERO);
+    bool eqBaseView = condition & (1 << MOVE4_C_EQUAL);
+    bool gap        = condition & (1 << MOVE4_C_GAP);
+    bool incLane    = condition & (1 << MOVE4_C_LAST_POS);
+    bool lastLane   = condition & (1 << MOVE4_C_LAST_LANE);
+
+    bool hasTwoTiles = !start && !isBaseZero && !isViewZero;
+    bool canMerge    = hasTwoTiles && eqBaseView;
+    bool hasGap      = hasTwoTiles && gap;
+    bool moveTile    = !start && !isViewZero && (isBaseZero || canMerge || hasGap);
+    bool advanceBase = !canMerge && hasGap; 
+    bool done        = lastLane && incLane;
+    bool memReadB    = !done && (start || incLane);
+    
+    uint16_t decision = 0;
+
+    if(hasTwoTiles || moveTile)     decision |= MOVE4_D_SET_VALUE;
+    if(moveTile)                    decision |= MOVE4_D_MEM_WRITE;
+    if(canMerge)                    decision |= MOVE4_D_ADD_SCORE;
+    if(memReadB)                    decision |= MOVE4_D_MEM_READ_B;
+    if(!done)                       decision |= MOVE4_D_MEM_READ_V;
+    if(!memReadB && canMerge)       decision |= MOVE4_D_CLR_VALUE;
+    if(done)                        decision |= MOVE4_D_DONE;
+    if(advanceBase)                 decision |= MOVE4_D_BASE_WRITE_INC;
+    if(!incLane && hasTwoTiles)     decision |= MOVE4_D_BASE_INC;
+    if(incLane)                     decision |= MOVE4_D_LANE_INC;
+    if(start || incLane)            decision |= MOVE4_D_BASE_READ_ZERO;
+
+    return decision;
+}
+
+__attribute__((constructor)) void move4_initTable()
+{
+    for(int condition = 0; condition < MOVE4_TABLE_SIZE; condition++)
+    {
+        move4_table[condition] = move4_decide(condition);
+    }
+}
+
+/*
+    write the table as SystemVerilog module MoveLogic
+*/
+void move4_writeLogic(FILE *f)
+{
+    fprintf(f, "`default_nettype none\n\n");
+    fprintf(f, "/*\n");
+    fprintf(f, "    MoveLogic\n\n");
+    fprintf(f, "    Decision of one step of a move (v4), generated from the table of the emulator\n");
+    fprintf(f, "    (emu/emu.c, move4_decide) - do not edit, set GENERATE_LOGIC and run the emulator.\n\n");
+    fprintf(f, "    condition bits:\n");
+    for(int c = 0; c < MOVE4_NUM_CONDITIONS; c++) fprintf(f, "        [%d] %s\n", c, move4_conditionNames[c]);
+    fprintf(f, "\n    decision bits:\n");
+    for(int d = 0; d < MOVE4_NUM_DECISIONS; d++) fprintf(f, "        [%2d] %s\n", d, move4_decisionNames[d]);
+    fprintf(f, "*/\n\n");
+
+    fprintf(f, "module MoveLogic (\n");
+    for(int c = 0; c < MOVE4_NUM_CONDITIONS; c++) fprintf(f, "  input %s,\n", move4_conditionNames[c]);
+    for(int d = 0; d < MOVE4_NUM_DECISIONS; d++) fprintf(f, "  output %s%s\n", move4_decisionNames[d], d < MOVE4_NUM_DECISIONS - 1 ? "," : "");
+    fprintf(f, ");\n\n");
+
+    fprintf(f, "  wire [%d:0] condition = {", MOVE4_NUM_CONDITIONS - 1);
+    for(int c = MOVE4_NUM_CONDITIONS - 1; c >= 0; c--) fprintf(f, "%s%s", move4_conditionNames[c], c ? ", " : "};\n");
+    fprintf(f, "  reg [%d:0] decision;\n\n", MOVE4_NUM_DECISIONS - 1);
+
+    fprintf(f, "  assign {");
+    for(int d = MOVE4_NUM_DECISIONS - 1; d >= 0; d--) fprintf(f, "%s%s", move4_decisionNames[d], d ? ", " : "} = decision;\n\n");
+
+    fprintf(f, "  always @(*) begin\n");
+    fprintf(f, "    case(condition)\n");
+    for(int condition = 0; condition < MOVE4_TABLE_SIZE; condition++)
+    {
+        fprintf(f, "      %d'd%-3d: decision = %d'b", MOVE4_NUM_CONDITIONS, condition, MOVE4_NUM_DECISIONS);
+        for(int d = MOVE4_NUM_DECISIONS - 1; d >= 0; d--) fprintf(f, "%d", (move4_table[condition] >> d) & 1);
+        fprintf(f, ";\n");
+    }
+    fprintf(f, "      default: decision = %d'b0;\n", MOVE4_NUM_DECISIONS);
+    fprintf(f, "    endcase\n");
+    fprintf(f, "  end\n\n");
+    fprintf(f, "endmodule\n");
+}
+
+/*
+    state of a v4 move, the move can run at once (game_move4) or as coroutine
+    (move4_step) which returns after every logic step and every memory shift
+
+    A logic step queues its memory accesses, they are executed in order. The
+    data of a write is fixed when it is queued, a read loads buff or data.
+*/
+
+typedef enum move4_event_en {
+    MOVE4_DONE  = 0,
+    MOVE4_STEP  = 1,
+    MOVE4_SHIFT = 2,
+} move4_event_t;
+
+typedef enum move4_target_en {
+    MOVE4_NONE = 0,
+    MOVE4_BUFF = 1,
+    MOVE4_DATA = 2,
+} move4_target_t;
+
+typedef struct move4_access_st
+{
+    int            index;
+    bool           write;
+    int            value;
+    move4_target_t target;
+} move4_access_t;
+
+typedef struct move4_st
+{
+    move_direction_t dir;
+
+    bool start;
+    bool done;
+    bool hasMoved;
+
+    int buff;
+    int data;
+    int lane;
+    int posBase;
+    int posView;
+    int condition;
+
+    int numAccesses;
+    int access;
+    move4_access_t accesses[4];
+} move4_t;
+
+void move4_begin(move4_t *m, move_direction_t dir)
+{
+    memset(m, 0, sizeof(*m));
+
+    m->dir       = dir;
+    m->start     = true;
+    m->condition = MOVE4_TABLE_SIZE;
+    m->buff  = getSign(0);
+    m->data  = getSign(0);
+}
+
+static inline void move4_queue(move4_t *m, int index, bool write, int value, move4_target_t target)
+{
+    m->accesses[m->numAccesses++] = (move4_access_t) { index, write, value, target };
+}
+
+/*
+    write MoveLogic.sv to GENERATE_LOGIC_FILE
+*/
+void move4_generateLogic()
+{
+    FILE *f = fopen(GENERATE_LOGIC_FILE, "w");
+
+    if(!f)
+    {
+        printf(" Can not write: %s\n", GENERATE_LOGIC_FILE);
+        return;
+    }
+
+    move4_writeLogic(f);
+    fclose(f);
+
+    printf(" Generated: %s\n", GENERATE_LOGIC_FILE);
+}
+
+/*
+    one logic step, queues the memory accesses of the step
+*/
+void move4_logic(move4_t *m)
+{
+    game_numSteps += 1;
+
+    int condition = (m->start                              << MOVE4_C_START)     |
+                    ((m->buff == getSign(0))               << MOVE4_C_BASE_ZERO) |
+                    ((m->data == getSign(0))               << MOVE4_C_VIEW_ZERO) |
+                    ((m->buff == m->data)                  << MOVE4_C_EQUAL)     |
+                    ((m->posView - m->posBase > 1)         << MOVE4_C_GAP)       |
+                    ((m->posView + 1 >= NUM_FIELDW)        << MOVE4_C_LAST_POS)  |
+                    ((m->lane + 1 >= NUM_FIELDW)           << MOVE4_C_LAST_LANE);
+
+    uint16_t decision = move4_table[condition];
+
+    if(move4_recordCoverage)
+    {
+        if(move4_coverage[condition]++ == 0) move4_numConditions++;
+        if(!move4_pairCoverage[m->condition][condition]) 
+        {
+            move4_pairCoverage[m->condition][condition] = 1;
+            move4_numPairs++;
+        }
+
+        // the first step of a move starts a new path
+        if(m->condition == MOVE4_TABLE_SIZE) move4_pathLength = 0;
+        if(move4_pathLength < MOVE4_MAX_PATH) move4_path[move4_pathLength++] = (uint8_t) condition;
+        m->condition = condition;
+    }
+
+    bool setValue = decision & MOVE4_D_SET_VALUE;
+    bool memWrite = decision & MOVE4_D_MEM_WRITE;
+    bool addScore = decision & MOVE4_D_ADD_SCORE;
+    bool memReadB = decision & MOVE4_D_MEM_READ_B;
+    bool memReadV = decision & MOVE4_D_MEM_READ_V;
+    bool clrValue = decision & MOVE4_D_CLR_VALUE;
+    bool laneInc  = decision & MOVE4_D_LANE_INC;
+
+    int laneNext    = m->lane + laneInc;
+    int posBaseNext = laneInc ? 0 : m->posBase + !!(decision & MOVE4_D_BASE_INC);
+    int posViewNext = laneInc ? 1 : m->posView + 1;
+
+    int laneWrite = m->lane;
+    int laneRead  = laneNext;
+    int posClear  = m->posView;
+    int posWrite  = m->posBase + !!(decision & MOVE4_D_BASE_WRITE_INC);
+    int posReadB  = (decision & MOVE4_D_BASE_READ_ZERO) ? 0 : m->posBase;
+    int posReadV  = posViewNext;
+
+    m->done     = decision & MOVE4_D_DONE;
+    m->start    = false;
+    m->lane     = laneNext;
+    m->posBase  = posBaseNext;
+    m->posView  = posViewNext;
+    m->hasMoved = m->hasMoved || memWrite;
+
+    // Process
+    int nextValue = getSignValue(m->buff) + 1; 
+    int next      = getSign(nextValue);
+
+    // Memory
+    if(setValue) m->buff = addScore ? next : m->data;
+
+    int indexClear = computeIndex(laneWrite, posClear, m->dir);
+    int indexWrite = computeIndex(laneWrite, posWrite, m->dir);
+    int indexReadB = computeIndex(laneRead,  posReadB, m->dir);
+    int indexReadV = computeIndex(laneRead,  posReadV, m->dir);
+
+    m->numAccesses = 0;
+    m->access      = 0;
+
+    if(memWrite) move4_queue(m, indexClear, true, getSign(0), MOVE4_NONE);
+    if(memWrite) move4_queue(m, indexWrite, true, m->buff, MOVE4_NONE);
+
+    if(addScore) game_addScore(nextValue); 
+
+    if(clrValue) m->buff = getSign(0);       
+    if(memReadB) move4_queue(m, indexReadB, false, 0, MOVE4_BUFF);
+    if(memReadV) move4_queue(m, indexReadV, false, 0, MOVE4_DATA);
+}
+
+/*
+    execute the next queued access
+*/
+static inline void move4_access(move4_t *m)
+{
+    move4_access_t *a = &m->accesses[m->access++];
+    int value = accessMemory(a->index, a->write, a->value);
+
+    if(a->target == MOVE4_BUFF) m->buff = value;
+    if(a->target == MOVE4_DATA) m->data = value;
+}
+
+static inline bool move4_end(move4_t *m)
+{
+    if(DEBUG_MOVE && debug) print_game();
+
+    if(m->hasMoved) game_lastMove = m->dir;
+    
+    return m->hasMoved;
+}
+
+/*
+    advance the move by one logic step or by one memory shift (one field)
+*/
+move4_event_t move4_step(move4_t *m)
+{
+    while(m->access < m->numAccesses)
+    {
+        int index = m->accesses[m->access].index;
+
+        if(memory_model->distance(index) > 0)
+        {
+            if(TOGGLE) memory_toggleShift(index, 1);
+
+            game_numIterations += 1;
+            memory_model->shift(index);
+
+            return MOVE4_SHIFT;
+        }
+
+        move4_access(m);
+    }
+
+    if(m->done) return MOVE4_DONE;
+
+    move4_logic(m);
+
+    return MOVE4_STEP;
+}
+
+bool game_move4(move_direction_t dir)
+{
+    TRACE_SCOPE("game_move4");
+
+    move4_t m;
+    move4_begin(&m, dir);
+
+    do
+    {
+        move4_logic(&m);
+
+        while(m.access < m.numAccesses) move4_access(&m);
+    }
+    while(!m.done);
+
+    return move4_end(&m);
+}
+
+/*
+    run a move started with move4_begin with move4_step until it is done
+*/
+bool game_move4_steps(move4_t *m)
+{
+    while(move4_step(m) != MOVE4_DONE);
+
+    return move4_end(m);
+}
+
+bool game_move3(move_direction_t dir)
+{
+    TRACE_SCOPE("game_move3");
+
+    bool hasMoved = false;
+    
+    int buff     = getSign(0);
+    int data     = getSign(0);
+    int lane     = 0;
+    int posBase  = 0;
+    int posView  = 0;
+    
+    bool start = true;
+    bool done = false;
+
+    if(DEBUG_MOVE && debug) printf("dir: %s\n", game_moveLabels[dir]);
+    if(DEBUG_MOVE && debug) print_game();
+
+    do
+    {       
+        game_numSteps += 1;
+
+        // Logic
+        bool isBaseZero  = (buff == getSign(0));
+        bool isViewZero  = (data == getSign(0));    
+        bool eqBaseView  = (buff == data);        
+        bool hasTwoTiles = !start && !isBaseZero && !isViewZero;
+        bool canMerge    = hasTwoTiles && eqBaseView;
+        bool hasGap      = hasTwoTiles && (posView - posBase > 1);
+        bool moveTile    = !start && !isViewZero && (isBaseZero || canMerge || hasGap);
+
+        int posBaseNext  = posBase + 1;
+        int posViewNext  = posView + 1;
+        int laneNext     = lane + 1;
+        int incLane      = (posViewNext >= NUM_FIELDW);
+        done             = incLane && (laneNext >= NUM_FIELDW);
+        int posBaseRead  = start || incLane ? 0 : posBase;
+        int posBaseWrite = !canMerge && hasGap ? posBaseNext : posBase;
+
+        int nextLane     = incLane ? laneNext : lane;
+        int nextPosBase  = incLane ? 0 : (hasTwoTiles ? posBaseNext : posBase);
+        int nextPosView  = incLane ? 1 : posViewNext;
+        
+        // Process
+        int nextValue = getSignValue(data) + 1; 
+        int next      = getSign(nextValue);
+        if(canMerge) game_addScore(nextValue); 
+
+        // Memory
+        int indexClear = computeIndex(lane,     posView,      dir);
+        int indexWrite = computeIndex(lane,     posBaseWrite, dir);
+        int indexReadB = computeIndex(nextLane, posBaseRead,  dir);
+        int indexReadD = computeIndex(nextLane, nextPosView,  dir);
+
+        if(DEBUG_MOVE && debug) printf("[%d:%d-%d] %x '%c' '%c' ", lane, posBase, posView, game_fieldIndex, buff, data);
+        if(DEBUG_MOVE && debug) printf("(%d%d%d%d%d%d%d) ", start, isViewZero, isBaseZero, canMerge, hasGap, hasTwoTiles,moveTile);
+        if(DEBUG_MOVE && debug) print_lane(lane, dir);
+
+        unsigned char hex[] = "0123456789abcdef";
+
+        if(DEBUG_MOVE && debug) printf(" C %c W %c R %c %c]", 
+            moveTile                    ? hex[posView]      : ' ',
+            moveTile                    ? hex[posBaseWrite] : ' ',
+            !done && (start || incLane) ? hex[posBaseRead]  : ' ',
+            !done                       ? hex[nextPosView]  : ' ');
+
+        if(DEBUG_MOVE && debug) printf(" ---> ");
+
+        if(hasTwoTiles || moveTile)
+        {
+            buff = canMerge ? next : data;
+
+            if(moveTile)
+            {
+                accessMemory(indexClear, true, getSign(0));
+                accessMemory(indexWrite, true, buff);
+
+                if(canMerge)
+                {
+                    game_addScore(nextValue);
+                    buff = getSign(0);
+                } 
+            }
+        }        
+
+        if(!done)
+        {
+            if(start || incLane) buff = accessMemory(indexReadB, false, 0);
+            data = accessMemory(indexReadD, false, 0);            
+        }
+
+        if(DEBUG_MOVE && debug) printf("%x '%c' '%c' [%d:%d-%d] ", game_fieldIndex, buff, data, nextLane, nextPosBase, nextPosView);
+        if(DEBUG_MOVE && debug) print_lane(lane, dir);
+        if(DEBUG_MOVE && debug) printf("\n");
+
+        start    = false;
+        lane     = nextLane;
+        posBase  = nextPosBase;
+        posView  = nextPosView;
+        hasMoved = hasMoved || moveTile;  
+
+
+    } while(!done);
+
+    if(DEBUG_MOVE && debug) print_game();
+
+    if(hasMoved) game_lastMove = dir;
+    
+    return hasMoved;
+}
+
+bool game_move2(move_direction_t dir)
+{
+    TRACE_SCOPE("game_move2");
+
+    bool hasMoved = false;
+    int base = 0, data = 0;
+
+    int lane = 0;
+    int posBase = 0;
+    int posData = 0;
+    bool done = false;
+
+    do
+    {       
+        game_numSteps += 1;
+
+        int index1   = computeIndex(lane, posBase, dir);
+        int index1p1 = computeIndex(lane, posBase+1, dir);
+        int index2   = computeIndex(lane, posData, dir);
+            
+        data = accessMemory(index2, false, 0);
+  
+        bool start       = (posBase == 0) && (posData == 0);
+        bool isBaseZero  = (base == getSign(0));
+        bool isDataZero  = (data == getSign(0));    
+        bool eqBaseData  = (base == data);        
+        bool hasTwoTiles = !start && !isBaseZero && !isDataZero;
+        bool canMerge    = hasTwoTiles && eqBaseData;
+        bool hasGap      = hasTwoTiles && (posData - posBase > 1);
+        bool moveTile    = !start && !isDataZero && (isBaseZero || canMerge || hasGap);
+
+        bool incData     = canMerge;
+        bool clear       = !start && !isDataZero && canMerge;
+        bool load        = start || (!start && !isDataZero && !canMerge);
+
+        int posBaseNext  = posBase + 1;
+        int posDataNext  = posData + 1;
+        int laneNext     = lane + 1;
+        int incLane      = (posDataNext >= NUM_FIELDW);
+        done             = incLane && (laneNext >= NUM_FIELDW);
+
+        int nextLane     = incLane ? laneNext : lane;
+        int nextPosBase  = incLane ? 0 : (hasTwoTiles ? posBaseNext : posBase);
+        int nextPosData  = incLane ? 0 : posDataNext;
+
+        assert(game_fieldIndex == index2);
+
+        int nextValue = getSignValue(base) + 1;    
+
+        if(moveTile) 
+        {
+                 
+            int writeIndex = !canMerge && hasGap ? index1p1 : index1;
+            int setData    = incData ? getSign(nextValue) : data;
+
+            int distW = computeMemoryDistance(writeIndex);
+            int dist2 = computeMemoryDistance(index2);
+            assert(dist2 < distW || dist2 == 0);
+
+            accessMemory(index2, true, getSign(0));
+            accessMemory(writeIndex, true, setData);
+        }
+
+        
+        if(canMerge) game_addScore(nextValue);
+
+        lane     = nextLane;
+        posBase  = nextPosBase;
+        posData  = nextPosData;
+        
+        if(load)  base = data;
+        if(clear) base = getSign(0);
+
+        hasMoved = hasMoved || moveTile;   
+
+    } while(!done);
+
+    if(hasMoved) game_lastMove = dir;
+    
+    return hasMoved;
+}
+
+bool game_move1(move_direction_t dir)
+{
+    TRACE_SCOPE("game_move1");
+
+    bool hasMoved = false;
+    int data1, data2;
+
+    for(int lane = 0; lane < NUM_FIELDW; lane++)
+    {
+        int pos1 = 0;
+        int pos2 = 1;
+    
+        bool fetch1 = true;
+        bool done = false;
+
+        do
+        {    
+            game_numSteps += 1;   
+
+            bool writeData1 = false;
+            bool clearData2 = false;
+            bool updateScore = false;
+
+            int nextPos1 = pos1;
+            int nextPos2 = pos2 + 1;
+
+            int index1 = computeIndex(lane, pos1, dir);
+            int index2 = computeIndex(lane, pos2, dir);
+            int index1p1 = computeIndex(lane, pos1+1, dir);
+            
+            if(fetch1) data1 = accessMemory(index1, false, 0);
+            data2 = accessMemory(index2, false, 0);
+
+            fetch1 = false;
+
+            int nextData1 = data1;
+            int writeData1Value;
+
+            bool pos1empty = (data1 == getSign(0));
+            bool pos2empty = (data2 == getSign(0));            
+            bool canMerge  = (data1 == data2);
+            int nextValue  = getSignValue(data1) + 1;
+            bool hasGap = (pos2 - pos1 > 1);
+
+            if(!pos2empty)
+            {
+                if(pos1empty)
+                {
+                    /*
+                        move
+                        1   2       1     2 
+                        . . 1 1 --> 1 . . 1 
+                    */
+
+                    writeData1 = true;
+                    writeData1Value = data2;
+                    nextData1 = data2;
+                    clearData2 = true;
+                }  
+                else  // both not empty
+                {
+                    if(canMerge)
+                    {
+                        /*
+                            merge
+                            1 2           1 2
+                            1 1 2 . --> 2 . 2 . 
+
+                        */
+                        writeData1 = true;
+                        writeData1Value = getSign(nextValue);
+
+                        nextData1 = getSign(0);
+
+                        updateScore = true;
+                        clearData2  = true;
+
+                    }
+                    else // both not empty, but can't merge
+                    {
+                        if(hasGap) 
+                        {
+                            /*
+                                shift value 2 to first gap spot
+                                1   2         1   2
+                                1 . 2 2 --> 1 2 . 2  
+                            */
+
+                            index1 = index1p1;
+
+                            writeData1 = true;
+                            writeData1Value = data2;                        
+
+                            nextData1  = data2;
+
+                            clearData2 = true;
+                        }
+                        else
+                        {
+                            /*
+                                check next value
+                                1 2           1 2
+                                1 2 . 2 --> 1 2 . 2
+                            */
+                            nextData1 = data2;
+                            nextPos2 = pos1 + 2; 
+                        }
+                    }
+                    
+                    nextPos1 = pos1 + 1;
+                }
+            }   
+
+            if(DEBUG_MOVE && debug)  printf("\n%d:%d-%d empty:%d:%d gap:%d canMerge:%d", lane, pos1, pos2, pos1empty, pos2empty, hasGap, canMerge);  
+            if(DEBUG_MOVE && debug)  if(writeData1) printf(" [%d]<-%c", pos1, writeData1Value);
+            if(DEBUG_MOVE && debug)  if(clearData2) printf(" [%d]<-0", pos2);
+
+            if(writeData1) accessMemory(index1, true, writeData1Value);
+            if(clearData2) accessMemory(index2, true, getSign(0));
+            if(updateScore) game_addScore(nextValue);
+
+            pos1 = nextPos1;
+            pos2 = nextPos2;
+
+            data1 = nextData1;
+
+            if(nextPos2 >= NUM_FIELDW) done = true;
+
+            hasMoved = hasMoved || writeData1;   
+
+        } while(!done);
+
+    }
+
+    if(DEBUG_MOVE && debug)  printf("\n");
+    if(DEBUG_MOVE && debug)  print_game();
+
+    if(hasMoved) game_lastMove = dir;
+    
+    return hasMoved;
+}
+
+/*
+    Buffer count engine (vK)
+
+    A lane is read from position 0 to NUM_FIELDW - 1 into a queue of K tile
+    buffers. Only the last buffer can still merge, so if a new tile needs a
+    buffer and all K are used, the oldest one is written to the next output
+    position. At the end of the lane all buffers are written and the positions
+    behind the last output tile which held a tile are cleared.
+
+    With a full lane buffer (K = NUM_FIELDW) the lane does not have to be read
+    in position order: it is read in the order the memory reaches the fields
+    (nearest first), merged in one step and the changed fields are written
+    in the same order.
+
+    Each memory access is one step. More buffers cost more flip-flops:
+
+        buffers     K x (MEM_DATA_WIDTH + position)
+        counters    lane, read and write position
+        control     merged flag, number of used buffers
+
+    Only two sizes are useful. A buffer that can no longer merge is written
+    at once, so the in-order engine never holds more than the last tile and
+    the tile waiting for its output position: any K from 3 to NUM_FIELDW - 1
+    gives the same accesses as K = 2 with more flip-flops. Only the full lane
+    buffer changes the schedule.
+*/
+
+#define MOVEK_MIN_BUFFERS 2
+#define MOVEK_MAX_BUFFERS NUM_FIELDW
+
+/*
+    number of flip-flops of the engine with numBuffers buffers
+*/
+int game_moveK_registerBits(int numBuffers)
+{
+    int posBits   = 32 - __builtin_clz(NUM_FIELDW - 1);
+    int countBits = 32 - __builtin_clz((unsigned) numBuffers);
+
+    return (numBuffers * (MEM_DATA_WIDTH + posBits)) + (3 * posBits) + 1 + countBits;
+}
+
+/*
+    next position of a lane to access (nearest in memory), -1 if all are done
+*/
+static int game_moveK_nearest(int lane, move_direction_t dir, const bool done[NUM_FIELDW])
+{
+    int nearest = -1, nearestDistance = 0;
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        if(done[pos]) continue;
+
+        int distance = memory_model->distance(computeIndex(lane, pos, dir));
+
+        if(nearest < 0 || distance < nearestDistance)
+        {
+            nearest = pos;
+            nearestDistance = distance;
+        }
+    }
+
+    return nearest;
+}
+
+/*
+    move a lane with a full lane buffer
+*/
+static bool game_moveK_lane(int lane, move_direction_t dir)
+{
+    uint8_t in[NUM_FIELDW], out[NUM_FIELDW];
+    bool done[NUM_FIELDW] = {false};
+    int pos;
+
+    while((pos = game_moveK_nearest(lane, dir, done)) >= 0)
+    {
+        game_numSteps += 1;
+        in[pos] = (uint8_t) getSignValue((char) accessMemory(computeIndex(lane, pos, dir), false, 0));
+        done[pos] = true;
+    }
+
+    // merge in one step
+    game_numSteps += 1;
+
+    int  numTiles = 0;
+    bool merged   = false;
+
+    for(pos = 0; pos < NUM_FIELDW; pos++) out[pos] = 0;
+
+    for(pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        if(in[pos] == 0) continue;
+
+        if(numTiles > 0 && !merged && out[numTiles - 1] == in[pos])
+        {
+            out[numTiles - 1] = (uint8_t) (in[pos] + 1);
+            game_addScore(in[pos] + 1);
+            merged = true;
+        }
+        else
+        {
+            out[numTiles++] = in[pos];
+            merged = false;
+        }
+    }
+
+    bool moved = false;
+
+    for(pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        done[pos] = (in[pos] == out[pos]);
+        moved = moved || !done[pos];
+    }
+
+    while((pos = game_moveK_nearest(lane, dir, done)) >= 0)
+    {
+        game_numSteps += 1;
+        accessMemory(computeIndex(lane, pos, dir), true, getSign(out[pos]));
+        done[pos] = true;
+    }
+
+    return moved;
+}
+
+bool game_moveK(move_direction_t dir, int numBuffers)
+{
+    TRACE_SCOPE("game_moveK");
+
+    assert(numBuffers == MOVEK_MIN_BUFFERS || numBuffers == MOVEK_MAX_BUFFERS);
+
+    bool hasMoved = false;
+
+    for(int lane = 0; lane < NUM_FIELDW && numBuffers == NUM_FIELDW; lane++)
+    {
+        hasMoved = game_moveK_lane(lane, dir) || hasMoved;
+    }
+
+    for(int lane = 0; lane < NUM_FIELDW && numBuffers < NUM_FIELDW; lane++)
+    {
+        int  value[MOVEK_MAX_BUFFERS];
+        int  source[MOVEK_MAX_BUFFERS];
+        int  numUsed  = 0;
+        int  posWrite = 0;
+        bool merged   = false;
+        bool occupied[NUM_FIELDW] = {false};
+
+        for(int pos = 0; pos <= NUM_FIELDW; pos++)
+        {
+            bool endOfLane = (pos == NUM_FIELDW);
+            int  data      = getSign(0);
+
+            if(!endOfLane)
+            {
+                game_numSteps += 1;
+                data = accessMemory(computeIndex(lane, pos, dir), false, 0);
+                occupied[pos] = (data != getSign(0));
+
+                if(!occupied[pos]) continue;
+
+                if(numUsed > 0 && !merged && value[numUsed - 1] == data)
+                {
+                    int nextValue = getSignValue((char) data) + 1;
+
+                    value[numUsed - 1]  = getSign(nextValue);
+                    source[numUsed - 1] = -1;
+                    merged = true;
+                    game_addScore(nextValue);
+                    continue;
+                }
+            }
+
+            // write the oldest buffers which are no longer needed
+            int numKeep = endOfLane ? 0 : numBuffers - 1;
+
+            while(numUsed > numKeep)
+            {
+                if(source[0] != posWrite)
+                {
+                    game_numSteps += 1;
+                    accessMemory(computeIndex(lane, posWrite, dir), true, value[0]);
+                    hasMoved = true;
+                }
+
+                occupied[posWrite] = false;
+                posWrite++;
+                numUsed--;
+
+                for(int i = 0; i < numUsed; i++)
+                {
+                    value[i]  = value[i + 1];
+                    source[i] = source[i + 1];
+                }
+            }
+
+            if(endOfLane) break;
+
+            value[numUsed]  = data;
+            source[numUsed] = pos;
+            numUsed++;
+            merged = false;
+        }
+
+        // clear the fields the tiles were moved away from
+        for(int pos = posWrite; pos < NUM_FIELDW; pos++)
+        {
+            if(!occupied[pos]) continue;
+
+            game_numSteps += 1;
+            accessMemory(computeIndex(lane, pos, dir), true, getSign(0));
+            hasMoved = true;
+        }
+    }
+
+    if(DEBUG_MOVE && debug) print_game();
+
+    if(hasMoved) game_lastMove = dir;
+
+    return hasMoved;
+}
+
+#if NUM_FIELDW == 4
+
+/*
+    hardcoded evaluation of one lane for refernce and testing
+ */
+bool game_move_ref_lane(int lane, int dir)
+{
+    bool moved = false;
+
+    int indexPos1 = computeIndex(lane, 0, dir);
+    int indexPos2 = computeIndex(lane, 1, dir);
+    int indexPos3 = computeIndex(lane, 2, dir);
+    int indexPos4 = computeIndex(lane, 3, dir);
+
+    int data[13] = {
+        0,
+        getSignValue(game_field[indexPos1]),
+        getSignValue(game_field[indexPos2]),
+        getSignValue(game_field[indexPos3]),
+        getSignValue(game_field[indexPos4])
+    };
+
+    data[0xa] = data[1] + 1;
+    data[0xb] = data[2] + 1;
+    data[0xc] = data[3] + 1;
+
+    int value1 = moveRefLastValues[indexPos1] =                                                                                                    (data[1] == 0) ? 0 : 1;
+    int value2 = moveRefLastValues[indexPos2] =                                                                   (data[2] == data[1]) ? value1 : ((data[2] == 0) ? 0 : 2);
+    int value3 = moveRefLastValues[indexPos3] =                                 (data[3] == data[2])  ? value2 : ((data[3] == data[1]) ? value1 : ((data[3] == 0) ? 0 : 3));
+    int value4 = moveRefLastValues[indexPos4] =(data[4] == data[3]) ? value3 : ((data[4] == data[2])  ? value2 : ((data[4] == data[1]) ? value1 : ((data[4] == 0) ? 0 : 4)));
+
+    int value = (value4 << 12) | (value3 << 8) | (value2 << 4) | (value1 << 0);
+    int start = value; 
+
+    if(DEBUG_MOVE_REF && debug) printf("%04x (%2d %2d %2d %2d) ", value, data[1], data[2], data[3], data[4]);
+    if(DEBUG_MOVE_REF && debug) print_lane(lane, dir);
+    if(DEBUG_MOVE_REF && debug) printf(" --> ");
+
+    switch (value)
+    {
+        case 0x0000: 
+        case 0x0001: 
+        case 0x0021:
+        case 0x0121:  
+        case 0x0321:  
+        case 0x1321:   
+        case 0x2121:   
+        case 0x2321: 
+        case 0x4121:
+        case 0x4321:break;
+
+        case 0x0020: value = 0x0002; break;
+        case 0x0300: value = 0x0003; break;
+        case 0x4000: value = 0x0004; break;
+        case 0x1001: 
+        case 0x0101:
+        case 0x0011: value = 0x000a; break;
+        case 0x0220: 
+        case 0x2020: value = 0x000b; break;
+        case 0x3300: value = 0x000c; break;
+        case 0x1101:
+        case 0x1011: value = 0x001a; break;
+        case 0x0111: value = 0x001a; break;
+        case 0x2220: value = 0x002b; break;
+        case 0x0301: value = 0x0031; break;
+        case 0x0320: value = 0x0032; break;
+        case 0x0311: value = 0x003a; break;
+        case 0x4001: value = 0x0041; break;
+        case 0x4020: value = 0x0042; break;
+        case 0x4300: value = 0x0043; break;
+        case 0x4101: 
+        case 0x4011: value = 0x004a; break;
+        case 0x4220: value = 0x004b; break;
+        case 0x1111: value = 0x00aa; break;
+        case 0x2021: value = 0x00b1; break;
+        case 0x0221: value = 0x00b1; break;
+        case 0x3301: value = 0x00c1; break;
+        case 0x3320: value = 0x00c2; break;
+        case 0x3311: value = 0x00ca; break;
+        case 0x1021: value = 0x0121; break;
+        case 0x1301: value = 0x0131; break;
+        case 0x1311: value = 0x013a; break;
+        case 0x1221: value = 0x01b1; break;
+        case 0x2320: value = 0x0232; break;
+        case 0x2221: value = 0x02b1; break;
+        case 0x4111: value = 0x041a; break;
+        case 0x4021: value = 0x0421; break;
+        case 0x4301: value = 0x0431; break;
+        case 0x4320: value = 0x0432; break;
+        case 0x4311: value = 0x043a; break;
+        case 0x4221: value = 0x04b1; break;
+        case 0x1121: value = 0x0a21; break;
+        case 0x3321: value = 0x0c21; break;
+
+        default: printf("<%04x>\n", value); fflush(stdout); assert(0);
+    }
+
+    moved = moved || (start != value);
+
+    value1 = ((0xf <<  0) & value) >>  0;
+    value2 = ((0xf <<  4) & value) >>  4;
+    value3 = ((0xf <<  8) & value) >>  8;
+    value4 = ((0xf << 12) & value) >> 12;
+    
+    if(DEBUG_MOVE_REF && debug) printf("%04x (%2d %2d %2d %2d):(%2x %2x %2x %2x) ", value, data[value1], data[value2], data[value3], data[value4], 
+                                                                                getSign(data[value1]), getSign(data[value2]), getSign(data[value3]), getSign(data[value4]));
+    if(DEBUG_MOVE_REF && debug) print_lane(lane, dir);
+    if(DEBUG_MOVE_REF && debug) printf("\n");
+
+
+    assert(getSign(data[value1]) > 0);
+    assert(getSign(data[value2]) > 0);
+    assert(getSign(data[value3]) > 0);
+    assert(getSign(data[value4]) > 0);
+
+    game_field[indexPos1] = getSign(data[value1]);
+    game_field[indexPos2] = getSign(data[value2]);
+    game_field[indexPos3] = getSign(data[value3]);
+    game_field[indexPos4] = getSign(data[value4]);
+
+    return moved;
+}
+
+#else
+
+/*
+    evaluation of one lane for refernce and testing (any board width)
+
+    the variant of each position is stored the same way as in the hardcoded 4x4 version:
+    the position (1..n) of the first tile with the same value or 0 if the position is empty
+ */
+bool game_move_ref_lane(int lane, int dir)
+{
+    bool moved = false;
+
+    int data[NUM_FIELDW];
+    int variant[NUM_FIELDW];
+    int result[NUM_FIELDW] = {0};
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        data[pos]    = getSignValue(game_field[computeIndex(lane, pos, dir)]);
+        variant[pos] = (data[pos] == 0) ? 0 : pos + 1;
+
+        for(int prev = pos - 1; prev >= 0; prev--)
+        {
+            if(data[pos] == data[prev])
+            {
+                variant[pos] = variant[prev];
+                break;
+            }
+        }
+
+        moveRefLastValues[computeIndex(lane, pos, dir)] = variant[pos];
+    }
+
+    if(DEBUG_MOVE_REF && debug) print_lane(lane, dir);
+    if(DEBUG_MOVE_REF && debug) printf(" --> ");
+
+    int  numTiles = 0;
+    bool merged   = false;
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        if(data[pos] == 0) continue;
+
+        if(numTiles > 0 && !merged && result[numTiles - 1] == data[pos])
+        {
+            result[numTiles - 1] += 1;
+            merged = true;
+        }
+        else
+        {
+            result[numTiles++] = data[pos];
+            merged = false;
+        }
+    }
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        moved = moved || (result[pos] != data[pos]);
+        game_field[computeIndex(lane, pos, dir)] = getSign(result[pos]);
+    }
+
+    if(DEBUG_MOVE_REF && debug) print_lane(lane, dir);
+    if(DEBUG_MOVE_REF && debug) printf("\n");
+
+    return moved;
+}
+
+#endif
+
+/*
+    hardcoded move function for refernce and testing
+ */
+bool game_move_ref(int dir)
+{
+    TRACE_SCOPE("game_move_ref");
+
+
+    if(DEBUG_MOVE_REF && debug) printf("dir: %s\n", game_moveLabels[dir]);
+    if(DEBUG_MOVE_REF && debug) print_game();
+
+    bool moved = false;
+
+    for(int lane = 0; lane < NUM_FIELDW; lane++)
+    {
+        bool laneMoved = game_move_ref_lane(lane, dir);
+        moved = moved || laneMoved;
+    }
+
+    if(moved) game_lastMove = dir;
+
+    if(DEBUG_MOVE_REF && debug) print_game();
+
+    return moved;
+}
+
+static bool game_moveSelected(int dir)
+{
+
+    /*
+        ref
+     */
+    if(MOVE_ALGO == 0) return game_move_ref(dir);
+
+    /*
+        Iterations: 11120
+        Steps: 1053
+    */
+    if(MOVE_ALGO == 4) return game_move4(dir);
+
+    /*
+        Iterations: 11120
+        Steps: 1053
+    */
+    if(MOVE_ALGO == 3) return game_move3(dir);
+
+    /*
+        Iterations: 11120
+        Steps: 1296
+    */
+    if(MOVE_ALGO == 2) return game_move2(dir);
+
+    /*
+        Iterations: 12674
+        Steps: 972
+    */
+    if(MOVE_ALGO == 1) return game_move1(dir);
+
+    assert(false);
+}
+
+/*
+    move with the selected implementation
+*/
+bool game_move(int dir)
+{
+    TRACE_SCOPE("game_move");
+
+    int numIterations = game_numIterations;
+    bool moved = game_moveSelected(dir);
+
+    metrics_add(&metrics->moves, 1);
+    metrics_add(&metrics->shiftedMoves, 1);
+    metrics_add(&metrics->shifts, (uint64_t) (game_numIterations - numIterations));
+
+    game_scoreRefresh();
+
+    return moved;
+}
+
+/*
+    result of all four directions of one board (indexed by move_direction_t)
+ */
+typedef struct game_moves_st
+{
+    char     field[NUM_DIRS + 1][NUM_FIELDS + 1];
+    bool     moved[NUM_DIRS + 1];
+    uint32_t score[NUM_DIRS + 1];
+} game_moves_t;
+
+/*
+    move and merge the values of one lane towards position 0
+
+    returns true if a value was moved or merged, the merged values are added to score
+ */
+static inline bool game_moveLane(const uint8_t in[NUM_FIELDW], uint8_t out[NUM_FIELDW], uint32_t *score)
+{
+    int  numTiles = 0;
+    bool merged   = false;
+    bool moved    = false;
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++) out[pos] = 0;
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        int value = in[pos];
+
+        if(value == 0) continue;
+
+        if(numTiles > 0 && !merged && out[numTiles - 1] == value)
+        {
+            out[numTiles - 1] = (uint8_t) (value < NUM_SIGNS ? value + 1 : NUM_SIGNS);
+            *score += 1u << (value + 1);
+            merged = true;
+        }
+        else
+        {
+            out[numTiles++] = (uint8_t) value;
+            merged = false;
+        }
+    }
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++) moved = moved || (out[pos] != in[pos]);
+
+    return moved;
+}
+
+/*
+    compute the successors of a board for all directions in one pass
+
+    The board is decoded once. Rows are the lanes of MV_LEFT / MV_RIGHT and columns
+    (the transposed board) the lanes of MV_UP / MV_DOWN, each lane is read once and
+    evaluated forwards and backwards.
+ */
+void game_moveAll(const char *field, game_moves_t *moves)
+{
+    TRACE_SCOPE("game_moveAll");
+
+    uint8_t values[NUM_FIELDS];
+
+    for(int i = 0; i < NUM_FIELDS; i++) values[i] = (uint8_t) getSignValue(field[i]);
+
+    for(int dir = 1; dir <= NUM_DIRS; dir++)
+    {
+        moves->moved[dir] = false;
+        moves->score[dir] = 0;
+        moves->field[dir][NUM_FIELDS] = '\0';
+    }
+
+    for(int lane = 0; lane < NUM_FIELDW; lane++)
+    {
+        for(int axis = 0; axis < 2; axis++)
+        {
+            // MV_RIGHT / MV_DOWN read the lane from position 0, MV_LEFT / MV_UP backwards
+            int forward  = axis ? MV_DOWN : MV_RIGHT;
+            int backward = axis ? MV_UP   : MV_LEFT;
+
+            uint8_t in[NUM_FIELDW], inReverse[NUM_FIELDW];
+            uint8_t out[NUM_FIELDW], outReverse[NUM_FIELDW];
+            int index[NUM_FIELDW];
+
+            for(int pos = 0; pos < NUM_FIELDW; pos++)
+            {
+                index[pos] = computeIndex(lane, pos, forward);
+                in[pos] = inReverse[NUM_FIELDW - pos - 1] = values[index[pos]];
+            }
+
+            moves->moved[forward]  |= game_moveLane(in,        out,        &moves->score[forward]);
+            moves->moved[backward] |= game_moveLane(inReverse, outReverse, &moves->score[backward]);
+
+            for(int pos = 0; pos < NUM_FIELDW; pos++)
+            {
+                moves->field[forward][index[pos]]  = getSign(out[pos]);
+                moves->field[backward][index[pos]] = getSign(outReverse[NUM_FIELDW - pos - 1]);
+            }
+        }
+    }
+}
+
+bool canmove()
+{
+    game_moves_t moves;
+
+    game_moveAll(game_field, &moves);
+
+    for(int dir = 1; dir <= NUM_DIRS; dir++)
+    {
+        if(moves.moved[dir]) return true;
+    }
+
+    return false;
+}
+
+
+/* === BATCH FUNCTIONS ==== */
+
+    /*
+        Batch moves
+
+        Applies one direction to many boards at once. The boards are stored as
+        numbers (sign values) in structure of arrays layout:
+
+            cells[(index * stride) + board]     value of field index on board
+
+        so the same field of consecutive boards is contiguous and one vector
+        register holds the same field of 16 (SSE4) or 32 (AVX2) boards.
+
+        Each lane is evaluated without branches:
+
+            1. compact      NUM_FIELDW - 1 passes, an empty position takes the next value
+            2. merge        equal neighbours are merged, the rest of the lane moves up
+
+        The merged values are collected per block and summed up to the score delta
+        afterwards (1 << value for each merge, the same value game_addScore gets).
+    */
+
+// number of merges per board and direction
+#define BATCH_NUM_MERGES (NUM_FIELDW * (NUM_FIELDW - 1))
+// largest number of boards per vector
+#define BATCH_MAX_WIDTH 32
+
+/*
+    convert a board between signs and values
+*/
+void game_fieldToValues(const char *field, uint8_t *values, size_t stride)
+{
+    for(int i = 0; i < NUM_FIELDS; i++) values[i * stride] = (uint8_t) getSignValue(field[i]);
+}
+
+void game_valuesToField(const uint8_t *values, size_t stride, char *field)
+{
+    for(int i = 0; i < NUM_FIELDS; i++) field[i] = getSign(values[i * stride]);
+}
+
+/*
+    lane kernel for WIDTH boards
+
+    the vector operations are passed as macros, so the scalar, SSE4 and AVX2
+    versions share the same evaluation
+*/
+#define BATCH_KERNEL(VEC, WIDTH, LOAD, STORE, SET1, CMPEQ, AND, ANDNOT, OR, XOR, BLEND, ADD, MIN)    \
+    {                                                                                                   \
+        VEC zero = SET1(0);                                                                             \
+        VEC one  = SET1(1);                                                                             \
+        VEC top  = SET1(NUM_SIGNS);                                                                     \
+        VEC diff = zero;                                                                                \
+        int merge = 0;                                                                                  \
+                                                                                                        \
+        for(int lane = 0; lane < NUM_FIELDW; lane++)                                                    \
+        {                                                                                               \
+            VEC c[NUM_FIELDW];                                                                          \
+            VEC o[NUM_FIELDW];                                                                          \
+            uint8_t *p[NUM_FIELDW];                                                                     \
+                                                                                                        \
+            for(int pos = 0; pos < NUM_FIELDW; pos++)                                                   \
+            {                                                                                           \
+                p[pos] = cells + ((size_t) computeIndex(lane, pos, dir) * stride) + board;              \
+                c[pos] = o[pos] = LOAD(p[pos]);                                                         \
+            }                                                                                           \
+                                                                                                        \
+            for(int pass = 0; pass < NUM_FIELDW - 1; pass++)                                            \
+            {                                                                                           \
+                for(int pos = 0; pos < NUM_FIELDW - 1; pos++)                                           \
+                {                                                                                       \
+                    VEC isZero = CMPEQ(c[pos], zero);                                                   \
+                    c[pos]     = BLEND(c[pos], c[pos + 1], isZero);                                     \
+                    c[pos + 1] = ANDNOT(isZero, c[pos + 1]);                                            \
+                }                                                                                       \
+            }                                                                                           \
+                                                                                                        \
+            for(int pos = 0; pos < NUM_FIELDW - 1; pos++, merge++)                                      \
+            {                                                                                           \
+                VEC canMerge = ANDNOT(CMPEQ(c[pos], zero), CMPEQ(c[pos], c[pos + 1]));                  \
+                VEC next     = ADD(c[pos], one);                                                        \
+                                                                                                        \
+                STORE(&merged[merge * BATCH_MAX_WIDTH], AND(canMerge, next));                           \
+                c[pos] = BLEND(c[pos], MIN(next, top), canMerge);                                       \
+                                                                                                        \
+                for(int shift = pos + 1; shift < NUM_FIELDW - 1; shift++)                               \
+                {                                                                                       \
+                    c[shift] = BLEND(c[shift], c[shift + 1], canMerge);                                 \
+                }                                                                                       \
+                c[NUM_FIELDW - 1] = ANDNOT(canMerge, c[NUM_FIELDW - 1]);                                \
+            }                                                                                           \
+                                                                                                        \
+            for(int pos = 0; pos < NUM_FIELDW; pos++)                                                   \
+            {                                                                                           \
+                diff = OR(diff, XOR(c[pos], o[pos]));                                                   \
+                STORE(p[pos], c[pos]);                                                                  \
+            }                                                                                           \
+        }                                                                                               \
+                                                                                                        \
+        uint8_t changed[BATCH_MAX_WIDTH];                                                               \
+        STORE(changed, diff);                                                                           \
+                                                                                                        \
+        uint32_t delta[BATCH_MAX_WIDTH] = {0};                                                          \
+                                                                                                        \
+        for(int m = 0; m < BATCH_NUM_MERGES; m++)                                                       \
+        {                                                                                               \
+            for(int i = 0; i < WIDTH; i++)                                                              \
+            {                                                                                           \
+                uint32_t value = merged[(m * BATCH_MAX_WIDTH) + i];                                     \
+                delta[i] += (1u << value) & (value ? ~0u : 0u);                                         \
+            }                                                                                           \
+        }                                                                                               \
+                                                                                                        \
+        for(int i = 0; i < WIDTH; i++)                                                                  \
+        {                                                                                               \
+            moved[board + i] = (changed[i] != 0);                                                       \
+            score[board + i] = delta[i];                                                                \
+        }                                                                                               \
+    }
+
+#define SCALAR_LOAD(p)          (*(p))
+#define SCALAR_STORE(p, a)      (*(p) = (a))
+#define SCALAR_SET1(v)          ((uint8_t) (v))
+#define SCALAR_CMPEQ(a, b)      ((uint8_t) ((a) == (b) ? 0xff : 0))
+#define SCALAR_AND(a, b)        ((uint8_t) ((a) & (b)))
+#define SCALAR_ANDNOT(m, a)     ((uint8_t) (~(m) & (a)))
+#define SCALAR_OR(a, b)         ((uint8_t) ((a) | (b)))
+#define SCALAR_XOR(a, b)        ((uint8_t) ((a) ^ (b)))
+#define SCALAR_BLEND(a, b, m)   ((uint8_t) ((m) ? (b) : (a)))
+#define SCALAR_ADD(a, b)        ((uint8_t) ((a) + (b)))
+#define SCALAR_MIN(a, b)        ((uint8_t) ((a) < (b) ? (a) : (b)))
+
+/*
+    portable version, one board per iteration
+*/
+void game_moveBatch_scalar(int dir, size_t num, size_t stride, uint8_t *cells, bool *moved, uint32_t *score)
+{
+    uint8_t merged[BATCH_NUM_MERGES * BATCH_MAX_WIDTH];
+
+    for(size_t board = 0; board < num; board++)
+    {
+        BATCH_KERNEL(uint8_t, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, SCALAR_CMPEQ, SCALAR_AND, SCALAR_ANDNOT,
+                     SCALAR_OR, SCALAR_XOR, SCALAR_BLEND, SCALAR_ADD, SCALAR_MIN)
+    }
+}
+
+#if BATCH_SIMD && defined(__x86_64__)
+
+#define SSE_LOAD(p)         _mm_loadu_si128((const __m128i *) (p))
+#define SSE_STORE(p, a)     _mm_storeu_si128((__m128i *) (p), (a))
+
+/*
+    SSE4.1 version, 16 boards per iteration
+*/
+__attribute__((target("sse4.1")))
+void game_moveBatch_sse4(int dir, size_t num, size_t stride, uint8_t *cells, bool *moved, uint32_t *score)
+{
+    uint8_t merged[BATCH_NUM_MERGES * BATCH_MAX_WIDTH];
+    size_t board = 0;
+
+    for(; board + 16 <= num; board += 16)
+    {
+        BATCH_KERNEL(__m128i, 16, SSE_LOAD, SSE_STORE, _mm_set1_epi8, _mm_cmpeq_epi8, _mm_and_si128, _mm_andnot_si128,
+                     _mm_or_si128, _mm_xor_si128, _mm_blendv_epi8, _mm_add_epi8, _mm_min_epu8)
+    }
+
+    game_moveBatch_scalar(dir, num - board, stride, cells + board, moved + board, score + board);
+}
+
+#define AVX2_LOAD(p)        _mm256_loadu_si256((const __m256i *) (p))
+#define AVX2_STORE(p, a)    _mm256_storeu_si256((__m256i *) (p), (a))
+
+/*
+    AVX2 version, 32 boards per iteration
+*/
+__attribute__((target("avx2")))
+void game_moveBatch_avx2(int dir, size_t num, size_t stride, uint8_t *cells, bool *moved, uint32_t *score)
+{
+    uint8_t merged[BATCH_NUM_MERGES * BATCH_MAX_WIDTH];
+    size_t board = 0;
+
+    for(; board + 32 <= num; board += 32)
+    {
+        BATCH_KERNEL(__m256i, 32, AVX2_LOAD, AVX2_STORE, _mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_and_si256, _mm256_andnot_si256,
+                     _mm256_or_si256, _mm256_xor_si256, _mm256_blendv_epi8, _mm256_add_epi8, _mm256_min_epu8)
+    }
+
+    game_moveBatch_scalar(dir, num - board, stride, cells + board, moved + board, score + board);
+}
+
+#endif
+
+/*
+    move all boards of a batch in the same direction
+
+    dir     direction
+    num     number of boards
+    stride  distance between two fields of the same board (>= num)
+    cells   board values, see above (updated in place)
+    moved   per board: true if a tile was moved or merged
+    score   per board: value added to the score
+*/
+void game_moveBatch(int dir, size_t num, size_t stride, uint8_t *cells, bool *moved, uint32_t *score)
+{
+    assert(stride >= num);
+
+#if BATCH_SIMD && defined(__x86_64__)
+    if(__builtin_cpu_supports("avx2"))   return game_moveBatch_avx2(dir, num, stride, cells, moved, score);
+    if(__builtin_cpu_supports("sse4.1")) return game_moveBatch_sse4(dir, num, stride, cells, moved, score);
+#endif
+
+    game_moveBatch_scalar(dir, num, stride, cells, moved, score);
+}
+
+/* === DISPLAY FUNCTIONS ==== */
+
+    /*
+        Display chain
+
+        The CPU shifts the display content through SR_Display (208 bit). Each digit
+        is one byte, segments a-g as defined in decoder.v plus the dot h:
+
+                  -- a --
+                 |       |              bit   7 6 5 4 3 2 1 0
+                 f       b                    a b c d e f g h
+                 |       |
+                  -- g --
+                 |       |
+                 e       c
+                 |       |
+                  -- d --       |h|
+
+        digit       content
+        0  .. 15    tiles (field index)
+        16 .. 22    score, lowest digit first, h = decimal seperator
+        23 .. 25    unused (blank)
+
+        (for other board sizes the score follows the last tile)
+
+        ShiftRegister shifts towards bit 0 (SR <= {SER, SR[WIDTH-1:1]}), so bit 0 of
+        the chain is shifted out first and has reached its position after all 208 bits.
+    */
+
+// number of digits in the display chain (26 for the 4x4 board, grows with larger boards)
+#define DISPLAY_NUM_DIGITS (NUM_FIELDS + NUM_SCORE > 26 ? NUM_FIELDS + NUM_SCORE : 26)
+// width of the display chain in bits (SR_Display in project.sv)
+#define DISPLAY_NUM_BITS (DISPLAY_NUM_DIGITS * 8)
+// first digit of the score in the chain
+#define DISPLAY_SCORE_DIGIT NUM_FIELDS
+// clock cycles to shift one byte (ShiftRegisterLoop: START, 8 x ACTIVE, DONE, IDLE)
+#define DISPLAY_CYCLES_PER_BYTE (8 + 3)
+// clock cycles for one frame
+#define DISPLAY_FRAME_CYCLES (DISPLAY_NUM_DIGITS * DISPLAY_CYCLES_PER_BYTE)
+
+// segments (abcdefg) for the signs 0 - h (decoder.v)
+static const uint8_t display_segments[18] = {
+    0x7e, // 0  1111110
+    0x30, // 1  0110000
+    0x6d, // 2  1101101
+    0x79, // 3  1111001
+    0x33, // 4  0110011
+    0x5b, // 5  1011011
+    0x5f, // 6  1011111
+    0x70, // 7  1110000
+    0x7f, // 8  1111111
+    0x7b, // 9  1111011
+    0x77, // a  1110111
+    0x1f, // b  0011111
+    0x0d, // c  0001101
+    0x3d, // d  0111101
+    0x4f, // e  1001111
+    0x47, // f  1000111
+    0x5e, // g  1011110
+    0x17, // h  0010111
+};
+
+// segments (abcdefg) for the letters of the splash text (decoder.v)
+static const struct { char letter; uint8_t segments; } display_letters[] = {
+    {'P', 0x67}, {'E', 0x4f}, {'R', 0x05}, {'G', 0x5e}, {'A', 0x77}, {'Y', 0x3b},
+    {'X', 0x37}, {'Z', 0x6c}, {'S', 0x5a}, {'I', 0x10}, {'C', 0x0d},
+};
+
+typedef struct display_frame_st
+{
+    uint8_t digit[DISPLAY_NUM_DIGITS];
+} display_frame_t;
+
+/*
+    segments (abcdefg) of a tile or score sign
+*/
+uint8_t display_encodeSign(char sign)
+{
+    if(sign >= '0' && sign <= '9') return display_segments[sign - '0'];
+    if(sign >= 'a' && sign <= 'h') return display_segments[sign - 'a' + 10];
+
+    for(size_t i = 0; i < sizeof(display_letters) / sizeof(display_letters[0]); i++)
+    {
+        if(toupper((unsigned char) sign) == display_letters[i].letter) return display_letters[i].segments;
+    }
+
+    return 0;
+}
+
+/*
+    encode board and score (with the decimal seperators returned by game_addScore)
+*/
+void display_encode(display_frame_t *frame, uint8_t decSep)
+{
+    game_scoreRefresh();
+    memset(frame, 0, sizeof(*frame));
+
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        frame->digit[i] = (uint8_t) (display_encodeSign(game_field[i]) << 1);
+    }
+
+    for(int pos = 0; pos < NUM_SCORE; pos++)
+    {
+        uint8_t dot = (decSep >> pos) & 1;
+        frame->digit[DISPLAY_SCORE_DIGIT + pos] = (uint8_t) (display_encodeSign(game_score[NUM_SCORE - pos - 1]) << 1) | dot;
+    }
+}
+
+/*
+    encode a text (e.g. the splash screen), starting at the first tile
+*/
+void display_encodeText(display_frame_t *frame, const char *text)
+{
+    memset(frame, 0, sizeof(*frame));
+
+    for(int i = 0; i < DISPLAY_NUM_DIGITS && text[i]; i++)
+    {
+        frame->digit[i] = (uint8_t) (display_encodeSign(text[i]) << 1);
+    }
+}
+
+/*
+    pack the frame into the bit vector of the display chain (bit n = display[n])
+*/
+void display_pack(const display_frame_t *frame, uint64_t chain[(DISPLAY_NUM_BITS + 63) / 64])
+{
+    memset(chain, 0, sizeof(uint64_t) * ((DISPLAY_NUM_BITS + 63) / 64));
+
+    for(int i = 0; i < DISPLAY_NUM_DIGITS; i++)
+    {
+        int bit = i * 8;
+        chain[bit / 64] |= (uint64_t) frame->digit[i] << (bit % 64);
+    }
+}
+
+/*
+    number of bits which differ between two frames
+*/
+int display_diffBits(const display_frame_t *a, const display_frame_t *b)
+{
+    int bits = 0;
+
+    for(int i = 0; i < DISPLAY_NUM_DIGITS; i++)
+    {
+        bits += __builtin_popcount(a->digit[i] ^ b->digit[i]);
+    }
+
+    return bits;
+}
+
+/* = SCHEDULE = */
+
+    /*
+        The move and the display refresh share the clock of the chip. Every
+        period cycles a frame (DISPLAY_FRAME_CYCLES) is due, it starts at the
+        next step or shift boundary of the move (move4_step). A logic step takes
+        one cycle and a memory shift MEM_DATA_WIDTH cycles.
+    */
+
+typedef struct schedule_st
+{
+    long period;        // cycles between two frames (0 = no display)
+    long time;          // current cycle
+    long nextFrame;     // cycle the next frame is due
+    long numFrames;
+    long sumDelay;      // cycles frames started late
+    long maxDelay;
+} schedule_t;
+
+void schedule_init(schedule_t *s, long period)
+{
+    memset(s, 0, sizeof(*s));
+    s->period = period;
+}
+
+/*
+    refresh the display until no frame is due
+*/
+static inline void schedule_display(schedule_t *s)
+{
+    while(s->period && s->time >= s->nextFrame)
+    {
+        long delay = s->time - s->nextFrame;
+
+        s->sumDelay += delay;
+        if(delay > s->maxDelay) s->maxDelay = delay;
+
+        s->numFrames++;
+        s->time      += DISPLAY_FRAME_CYCLES;
+        s->nextFrame += s->period;
+    }
+}
+
+/*
+    run a v4 move interleaved with the display, returns the latency in cycles
+*/
+long schedule_move(schedule_t *s, move_direction_t dir, bool *moved)
+{
+    long begin = s->time;
+    move4_t m;
+    move4_event_t event;
+
+    move4_begin(&m, dir);
+
+    do
+    {
+        schedule_display(s);
+
+        event = move4_step(&m);
+
+        if(event == MOVE4_STEP)  s->time += 1;
+        if(event == MOVE4_SHIFT) s->time += MEM_DATA_WIDTH;
+    }
+    while(event != MOVE4_DONE);
+
+    *moved = move4_end(&m);
+
+    return s->time - begin;
+}
+
+/* === SHARED TEST CASES ==== */
+
+struct test_fields_t
+{
+    char test[NUM_FIELDS + 1];
+    move_direction_t dir;
+    char result[NUM_FIELDS + 1];
+    bool moved;
+};
+
+#if NUM_FIELDW == 4
+
+struct test_fields_t test_fields[] = {
+    {"                ", MV_LEFT,  "                ", false},
+    {"                ", MV_RIGHT, "                ", false},
+    {"                ", MV_UP,    "                ", false},
+    {"                ", MV_DOWN,  "                ", false},
+    {"123456789abcdefg", MV_LEFT,  "123456789abcdefg", false},
+    {"123456789abcdefg", MV_RIGHT, "123456789abcdefg", false},
+    {"123456789abcdefg", MV_UP,    "123456789abcdefg", false},
+    {"123456789abcdefg", MV_DOWN,  "123456789abcdefg", false},
+    
+    // move #8
+    {"     1          ", MV_LEFT,  "       1        ", true},
+    {"     1          ", MV_RIGHT, "    1           ", true},
+    {"     1          ", MV_UP,    "             1  ", true},
+    {"     1          ", MV_DOWN,  " 1              ", true},
+
+    // merge 0 #12
+    {" 11             ", MV_LEFT,  "   2            ", true},
+    {" 11             ", MV_RIGHT, "2               ", true},
+    {"     1   1      ", MV_UP,    "             2  ", true},
+    {"     1   1      ", MV_DOWN,  " 2              ", true},
+
+    // move with gap 1 #16
+    {"    1 2         ", MV_LEFT,  "      12        ", true},
+    {"     1 2        ", MV_RIGHT, "    12          ", true},
+    {" 1       2      ", MV_UP,    "         1   2  ", true},
+    {"     1       2  ", MV_DOWN,  " 1   2          ", true},
+
+    // merge with gap 1 #20
+    {"    2 2         ", MV_LEFT,  "       3        ", true},
+    {"     2 2        ", MV_RIGHT, "    3           ", true},
+    {" 2       2      ", MV_UP,    "             3  ", true},
+    {"     2       2  ", MV_DOWN,  " 3              ", true},
+
+    // move with gap 2 #24
+    {"    2  2        ", MV_LEFT,  "       3        ", true},
+    {"    2  2        ", MV_RIGHT, "    3           ", true},
+    {"  1           2 ", MV_UP,    "          1   2 ", true},
+    {"  1           2 ", MV_DOWN,  "  1   2         ", true},
+
+    // merge with gap 2 #28
+    {"    2  2        ", MV_LEFT,  "       3        ", true},
+    {"    2  2        ", MV_RIGHT, "    3           ", true},
+    {"  2           2 ", MV_UP,    "              3 ", true},
+    {"  2           2 ", MV_DOWN,  "  3             ", true},
+
+    // combined test #32
+    {"3311            ", MV_LEFT,  "  42            ", true},
+    {"3311            ", MV_RIGHT, "42              ", true},
+    {"3   3   1   1   ", MV_UP,    "        4   2   ", true},
+    {"3   3   1   1   ", MV_DOWN,  "4   2           ", true},
+
+    // multi merge #36
+    {"1111            ", MV_LEFT,  "  22            ", true},
+    {"1111            ", MV_RIGHT, "22              ", true},
+    {"1   1   1   1   ", MV_UP,    "        2   2   ", true},
+    {"1   1   1   1   ", MV_DOWN,  "2   2           ", true},
+
+    // shift
+    {"121             ", MV_LEFT,  " 121            ", true},
+    {" 121            ", MV_RIGHT, "121             ", true},
+    {"1   2   1       ", MV_UP,    "    1   2   1   ", true},
+    {"    1   2   1   ", MV_DOWN,  "1   2   1       ", true},
+
+    //shift and merge
+    {"111             ", MV_LEFT,  "  12            ", true},
+    {"111             ", MV_RIGHT, "21              ", true},
+    {"1   1   1       ", MV_UP,    "        1   2   ", true},
+    {"    1   1   1   ", MV_DOWN,  "2   1           ", true},
+
+    //edge cases *pun intended*
+    {"1231123112311231", MV_LEFT,  "1231123112311231", false},
+    {"1231123112311231", MV_RIGHT, "1231123112311231", false},
+    {"1111222233331111", MV_UP,    "1111222233331111", false},
+    {"1111222233331111", MV_DOWN,  "1111222233331111", false},
+
+
+    // variants
+    {"7 4efe722284g2a ", MV_LEFT,  " 74efe72 384 g2a", true }, // 4021432133214320
+    {"7 4efe722284g2a ", MV_RIGHT, "74e fe72384 g2a ", true }, // 1034123411341230
+    {"c2a7gf7  g2ggdgh", MV_UP,    " 2a  f77cg2ghdgh", true }, // 4444133002221111
+    {"2fge5815d 6e 9gc", MV_DOWN,  "2fge5815d96e  gc", true }, // 1111222230310414
+    {"b2 9h6e57gg1f3b ", MV_LEFT,  " b29h6e5 7h1 f3b", true }, // 4301432142214320
+    {"d257b6bh5fc299 d", MV_RIGHT, "d257b6bh5fc2ad  ", true }, // 1234121412341104
+    {"h9b6dg6d133c39f9", MV_RIGHT, "h9b6dg6d14c 39f9", true }, // 1234123112241232
+    {"chdg3 1a8f 49f29", MV_DOWN , "chdg3g1a8 249  9", true }, // 1111202233034344
+    {" g2 21d7b3af87g2", MV_LEFT , "  g221d7b3af87g2", true }, // 0320432143214321
+    {"49g79hfgfd 6b f9", MV_DOWN , "49g79hggfd 6b  9", true }, // 1111222233034024
+    {"6 16e4 bhh2hgag ", MV_LEFT , " 616 e4b x2h gag", true }, // 1021430111212320
+    {"6 16e4 bhh2hgag ", MV_RIGHT, "616 e4b x2h gag ", true }, // 1031120411311210
+    {"fb d629f435fcc6d", MV_UP   , "fb  629d435gcc6d", true }, // 4401333222221111
+    {"8 2c aa3bf 374h7", MV_LEFT , " 82c  b3 bf374h7", true }, // 4021022143011321
+    {"8 2c aa3bf 374h7", MV_RIGHT, "82c b3  bf3 74h7", true }, // 1034022412041231
+    {"94f25cd21dcbach ", MV_UP   , "94f 5cd 1dc3achb", true }, // 4443313322221110
+    {"94f25cd21dcbach ", MV_DOWN , "94f35cdb1dc ach ", true }, // 1111222133334240
+    {"bbb1g38defahb4b4", MV_LEFT , " bc1g38defahb4b4", true }, // 2221432143212121
+    {"bbb1g38defahb4b4", MV_RIGHT, "cb1 g38defahb4b4", true }, // 1114123412341212
+    {"gg g 997c eae9g5", MV_LEFT , "  gh  a7 ceae9g5", true }, // 1101022140214321
+    {"gg g 997c eae9g5", MV_RIGHT, "hg  a7  cea e9g5", true }, // 1101022410341234
+    {"  7e96f78e1d b31", MV_LEFT , "  7e96f78e1d b31", false}, // 0021432143210321
+    {"  7e96f78e1d b31", MV_RIGHT, "7e  96f78e1db31 ", true }, // 0034123412340234
+    {"7 98efg65 f5668 ", MV_UP   , "7 9 e g85ff66685", true }, // 4044333320221110
+    {" 2 2g4h23e7 e c1", MV_LEFT , "   3g4h2 3e7 ec1", true }, // 0101432143204021
+    {"7198b4dbgecc   e", MV_LEFT , "7198b4db ged   e", true }, // 4321132143110001
+    {"7198b4dbgecc   e", MV_RIGHT, "7198b4dbged e   ", true }, // 1234123112330004
+    {"6bb 6 dd d73 369", MV_UP   , "  b  bdd d737369", true }, // 3440303302220111
+    {"6bb 6 dd d73 369", MV_DOWN , "7bbd dd3 379  6 ", true }, // 1110102203330444
+};
+
+#elif NUM_FIELDW == 3
+
+struct test_fields_t test_fields[] = {
+    {"         ", MV_LEFT,  "         ", false},
+    {"         ", MV_RIGHT, "         ", false},
+    {"         ", MV_UP,    "         ", false},
+    {"         ", MV_DOWN,  "         ", false},
+    {"12345678a", MV_LEFT,  "12345678a", false},
+    {"12345678a", MV_RIGHT, "12345678a", false},
+    {"12345678a", MV_UP,    "12345678a", false},
+    {"12345678a", MV_DOWN,  "12345678a", false},
+
+    // move
+    {"    1    ", MV_LEFT,  "     1   ", true},
+    {"    1    ", MV_RIGHT, "   1     ", true},
+    {"    1    ", MV_UP,    "       1 ", true},
+    {"    1    ", MV_DOWN,  " 1       ", true},
+
+    // merge
+    {"11       ", MV_LEFT,  "  2      ", true},
+    {"11       ", MV_RIGHT, "2        ", true},
+    {"1  1     ", MV_UP,    "      2  ", true},
+    {"1  1     ", MV_DOWN,  "2        ", true},
+
+    // merge with gap, shift and merge
+    {"2 2      ", MV_LEFT,  "  3      ", true},
+    {"111      ", MV_LEFT,  " 12      ", true},
+    {"111      ", MV_RIGHT, "21       ", true},
+    {"121      ", MV_LEFT,  "121      ", false},
+    {"121      ", MV_RIGHT, "121      ", false},
+};
+
+#elif NUM_FIELDW == 5
+
+struct test_fields_t test_fields[] = {
+    {"                         ", MV_LEFT,  "                         ", false},
+    {"                         ", MV_RIGHT, "                         ", false},
+    {"                         ", MV_UP,    "                         ", false},
+    {"                         ", MV_DOWN,  "                         ", false},
+
+    // move
+    {"            1            ", MV_LEFT,  "              1          ", true},
+    {"            1            ", MV_RIGHT, "          1              ", true},
+    {"            1            ", MV_UP,    "                      1  ", true},
+    {"            1            ", MV_DOWN,  "  1                      ", true},
+
+    // multi merge
+    {"11111                    ", MV_LEFT,  "  122                    ", true},
+    {"11111                    ", MV_RIGHT, "221                      ", true},
+
+    // move with gaps
+    {"1 2 1                    ", MV_LEFT,  "  121                    ", true},
+    {"1 2 1                    ", MV_RIGHT, "121                      ", true},
+
+    // merge with gap
+    {"2    2         3    3    ", MV_UP,    "               3    4    ", true},
+    {"2    2         3    3    ", MV_DOWN,  "3    4                   ", true},
+};
+
+#endif
+
+struct test_score_t
+{
+    char test[NUM_SCORE+ 1];
+    int addScore;
+    char result[NUM_SCORE + 1];
+    char resultWithDecSep[NUM_SCORE_WITH_DECSEP + 1];
+};
+
+struct test_score_t test_scores[] = {
+    {"      0",  2, "      4", "        4"},
+    {"     12",  2, "     16", "       16"},
+    {"     16",  4, "     32", "       32"},
+    {"     32",  5, "     64", "       64"},
+    {"     64",  6, "    128", "      128"},
+    {"    128",  7, "    256", "      256"},
+    {"    256",  8, "    512", "      512"},
+    {"    512",  9, "   1024", "    1.024"},
+    {"   1024", 10, "   2048", "    2.048"},
+    {"   2048", 11, "   4096", "    4.096"},
+    {"   4096", 12, "   8192", "    8.192"},
+    {"   8192", 13, "  16384", "   16.384"},
+    {"  16384", 14, "  32768", "   32.768"},
+    {"  32768", 15, "  65536", "   65.536"},
+    {"  65536", 16, " 131072", "  131.072"},
+    {" 131072", 17, " 262144", "  262.144"},
+    {"3801028", 17, "3932100", "3.932.100"},
+    {"3932100",  2, "3932104", "3.932.104"},
+    {"3932100", 17, "4063172", "4.063.172"},
+    {"9999996",  2, "0000000", "0.000.000"},
+};
+
+
+/* === CORPUS ==== */
+
+    /*
+        Test corpus
+
+        The move and score cases of the tests are kept in a memory mapped file
+        (CORPUS_FILE, one per board width). A new file is seeded with
+        test_fields[] and test_scores[], search_variants_rnd appends the cases
+        which found new variants, so the corpus grows without recompiling. All
+        numbers are in host byte order.
+
+            header      corpus_header_t
+            cases       numCases x corpus_case_t
+            index       optional, uint32_t at indexOffset
+
+                kindStart[CORPUS_NUM_KINDS + 1]     cases of a kind (file order)
+                dirStart[NUM_DIRS + 1]              move cases by direction
+                variantStart[NUM_VARIANTS + 1]      move cases by variant class
+                kindCases[numCases]
+                dirCases[numMoves]
+                variantCases[variantStart[NUM_VARIANTS]]
+
+        Appending drops the index, the next corpus_open builds it and writes it
+        back. If the built-in tables change the file is seeded again and the
+        appended cases are kept; a file of another version or width or with an
+        invalid case is replaced. An invalid index is built again.
+        Without a file name (or if the file can not be written) the corpus is
+        built in memory.
+    */
+
+#define CORPUS_MAGIC 0x73707263
+#define CORPUS_VERSION 1
+
+#define CORPUS_MOVE 0
+#define CORPUS_SCORE 1
+#define CORPUS_NUM_KINDS 2
+
+// size of the fixed part of the index (in uint32_t)
+#define CORPUS_INDEX_STARTS ((CORPUS_NUM_KINDS + 1) + (NUM_DIRS + 1) + (NUM_VARIANTS + 1))
+
+_Static_assert(NUM_SCORE <= NUM_FIELDS, "scores are stored in the board strings");
+
+typedef struct corpus_case_st
+{
+    char     test[NUM_FIELDS + 1];      // move: board, score: score
+    char     result[NUM_FIELDS + 1];    // move: board, score: score
+    char     resultWithDecSep[NUM_SCORE_WITH_DECSEP + 1];
+    uint8_t  kind;
+    uint8_t  dir;                       // move: direction
+    uint8_t  moved;                     // move: result of the move
+    uint8_t  addScore;                  // score: value added
+    uint16_t variants[NUM_FIELDW];      // move: variant class of every lane
+} corpus_case_t;
+
+typedef struct corpus_header_st
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numFieldW;
+    uint32_t caseSize;
+    uint64_t seedHash;      // hash of the built-in tables
+    uint64_t numSeed;       // cases from the built-in tables
+    uint64_t numCases;
+    uint64_t indexOffset;   // 0 = no index
+    uint64_t numIndexed;    // cases covered by the index
+} corpus_header_t;
+
+typedef struct corpus_st
+{
+    const corpus_header_t *header;
+    const corpus_case_t   *cases;
+    const uint32_t        *kindStart;
+    const uint32_t        *dirStart;
+    const uint32_t        *variantStart;
+    const uint32_t        *kindCases;
+    const uint32_t        *dirCases;
+    const uint32_t        *variantCases;
+    void                  *map;         // file or memory image
+    size_t                 mapSize;
+    bool                   mapped;      // image is a mapped file
+    uint32_t              *index;       // built index (NULL if in the file)
+    char                   file[PATH_MAX];
+} corpus_t;
+
+static corpus_t corpus;
+
+static inline size_t corpus_numMoves()
+{
+    return corpus.kindStart[CORPUS_MOVE + 1] - corpus.kindStart[CORPUS_MOVE];
+}
+
+static inline const corpus_case_t *corpus_move(size_t i)
+{
+    return &corpus.cases[corpus.kindCases[corpus.kindStart[CORPUS_MOVE] + i]];
+}
+
+static inline size_t corpus_numScores()
+{
+    return corpus.kindStart[CORPUS_SCORE + 1] - corpus.kindStart[CORPUS_SCORE];
+}
+
+static inline const corpus_case_t *corpus_score(size_t i)
+{
+    return &corpus.cases[corpus.kindCases[corpus.kindStart[CORPUS_SCORE] + i]];
+}
+
+/*
+    variant class of a lane of the last reference move
+*/
+int corpus_variant(int lane, int dir)
+{
+    int variant = 0;
+
+    for(int pos = 0; pos < NUM_FIELDW; pos++)
+    {
+        variant = (variant * (NUM_FIELDW + 1)) + moveRefLastValues[computeIndex(lane, pos, dir)];
+    }
+
+    return variant;
+}
+
+/*
+    move case of a board, the result is computed with the reference
+*/
+void corpus_makeMove(corpus_case_t *c, const char *test, int dir)
+{
+    memset(c, 0, sizeof(*c));
+    c->kind = CORPUS_MOVE;
+    c->dir  = (uint8_t) dir;
+    memcpy(c->test, test, NUM_FIELDS);
+
+    memcpy(game_field, test, NUM_FIELDS);
+    c->moved = game_move_ref(dir);
+    memcpy(c->result, game_field, NUM_FIELDS);
+
+    for(int lane = 0; lane < NUM_FIELDW; lane++) c->variants[lane] = (uint16_t) corpus_variant(lane, dir);
+}
+
+static uint64_t corpus_hash(uint64_t hash, const void *data, size_t size)
+{
+    for(size_t i = 0; i < size; i++) hash = (hash ^ ((const uint8_t *) data)[i]) * 0x100000001b3ull;
+
+    return hash;
+}
+
+/*
+    hash of the built-in tables, a changed table seeds the corpus again
+*/
+uint64_t corpus_seedHash()
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    int numFields = sizeof(test_fields)/sizeof(test_fields[0]);
+    int numScores = sizeof(test_scores)/sizeof(test_scores[0]);
+
+    for(int i = 0; i < numFields; i++)
+    {
+        hash = corpus_hash(hash, test_fields[i].test, NUM_FIELDS);
+        hash = corpus_hash(hash, &test_fields[i].dir, sizeof(test_fields[i].dir));
+        hash = corpus_hash(hash, test_fields[i].result, NUM_FIELDS);
+        hash = corpus_hash(hash, &test_fields[i].moved, sizeof(test_fields[i].moved));
+    }
+
+    for(int i = 0; i < numScores; i++)
+    {
+        hash = corpus_hash(hash, test_scores[i].test, NUM_SCORE);
+        hash = corpus_hash(hash, &test_scores[i].addScore, sizeof(test_scores[i].addScore));
+        hash = corpus_hash(hash, test_scores[i].result, NUM_SCORE);
+        hash = corpus_hash(hash, test_scores[i].resultWithDecSep, NUM_SCORE_WITH_DECSEP);
+    }
+
+    return hash;
+}
+
+/*
+    image of a corpus (header and cases) with the built-in tables and extra cases
+*/
+void *corpus_image(const corpus_case_t *extra, size_t numExtra, size_t *size)
+{
+    size_t numFields = sizeof(test_fields)/sizeof(test_fields[0]);
+    size_t numScores = sizeof(test_scores)/sizeof(test_scores[0]);
+    size_t numCases  = numFields + numScores + numExtra;
+
+    *size = sizeof(corpus_header_t) + numCases * sizeof(corpus_case_t);
+
+    void *image = calloc(1, *size);
+    assert(image);
+
+    corpus_header_t *header = image;
+    corpus_case_t   *cases  = (corpus_case_t *) (header + 1);
+
+    *header = (corpus_header_t) {
+        .magic     = CORPUS_MAGIC,
+        .version   = CORPUS_VERSION,
+        .numFieldW = NUM_FIELDW,
+        .caseSize  = sizeof(corpus_case_t),
+        .seedHash  = corpus_seedHash(),
+        .numSeed   = numFields + numScores,
+        .numCases  = numCases,
+    };
+
+    for(size_t i = 0; i < numFields; i++)
+    {
+        corpus_makeMove(&cases[i], test_fields[i].test, test_fields[i].dir);
+
+        // the table is the reference of the test, not the reference move
+        memcpy(cases[i].result, test_fields[i].result, NUM_FIELDS);
+        cases[i].moved = test_fields[i].moved;
+    }
+
+    for(size_t i = 0; i < numScores; i++)
+    {
+        corpus_case_t *c = &cases[numFields + i];
+
+        c->kind     = CORPUS_SCORE;
+        c->addScore = (uint8_t) test_scores[i].addScore;
+        memcpy(c->test, test_scores[i].test, NUM_SCORE);
+        memcpy(c->result, test_scores[i].result, NUM_SCORE);
+        memcpy(c->resultWithDecSep, test_scores[i].resultWithDecSep, NUM_SCORE_WITH_DECSEP);
+    }
+
+    if(numExtra) memcpy(&cases[numFields + numScores], extra, numExtra * sizeof(corpus_case_t));
+
+    return image;
+}
+
+bool corpus_writeImage(const char *file, const void *image, size_t size)
+{
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+
+    FILE *f = fopen(tmp, "wb");
+    if(!f) return false;
+
+    bool ok = fwrite(image, size, 1, f) == 1 && fflush(f) == 0 && fsync(fileno(f)) == 0;
+
+    ok = (fclose(f) == 0) && ok;
+
+    return ok && rename(tmp, file) == 0;
+}
+
+/*
+    build the index of the current corpus, returns its size in bytes
+*/
+size_t corpus_buildIndex(uint32_t **index)
+{
+    const corpus_case_t *cases = corpus.cases;
+    size_t numCases = corpus.header->numCases;
+    size_t numMoves = 0, numVariantCases = 0;
+    size_t starts[CORPUS_INDEX_STARTS] = {0};
+    size_t *kindStart = starts, *dirStart = kindStart + CORPUS_NUM_KINDS + 1, *variantStart = dirStart + NUM_DIRS + 1;
+
+    assert(numCases <= UINT32_MAX);
+
+    // count
+    for(size_t i = 0; i < numCases; i++)
+    {
+        const corpus_case_t *c = &cases[i];
+
+        kindStart[c->kind + 1]++;
+        if(c->kind != CORPUS_MOVE) continue;
+
+        numMoves++;
+        dirStart[c->dir]++;
+
+        for(int lane = 0; lane < NUM_FIELDW; lane++)
+        {
+            bool seen = false;
+            for(int l = 0; l < lane; l++) seen |= c->variants[l] == c->variants[lane];
+            if(!seen) variantStart[c->variants[lane] + 1]++;
+        }
+    }
+
+    for(int i = 0; i < CORPUS_NUM_KINDS; i++) kindStart[i + 1] += kindStart[i];
+    for(int i = 0; i < NUM_DIRS; i++) dirStart[i + 1] += dirStart[i];
+    for(int i = 0; i < NUM_VARIANTS; i++) variantStart[i + 1] += variantStart[i];
+    numVariantCases = variantStart[NUM_VARIANTS];
+
+    size_t size = (CORPUS_INDEX_STARTS + numCases + numMoves + numVariantCases) * sizeof(uint32_t);
+    uint32_t *out = malloc(size > 0 ? size : 1);
+    assert(out);
+
+    for(int i = 0; i < CORPUS_INDEX_STARTS; i++) out[i] = (uint32_t) starts[i];
+
+    // fill, the starts are used as positions
+    uint32_t *kindCases = out + CORPUS_INDEX_STARTS;
+    uint32_t *dirCases = kindCases + numCases;
+    uint32_t *variantCases = dirCases + numMoves;
+
+    for(size_t i = 0; i < numCases; i++)
+    {
+        const corpus_case_t *c = &cases[i];
+
+        kindCases[kindStart[c->kind]++] = (uint32_t) i;
+        if(c->kind != CORPUS_MOVE) continue;
+
+        dirCases[dirStart[c->dir - 1]++] = (uint32_t) i;
+
+        for(int lane = 0; lane < NUM_FIELDW; lane++)
+        {
+            bool seen = false;
+            for(int l = 0; l < lane; l++) seen |= c->variants[l] == c->variants[lane];
+            if(!seen) variantCases[variantStart[c->variants[lane]]++] = (uint32_t) i;
+        }
+    }
+
+    *index = out;
+
+    return size;
+}
+
+static void corpus_setIndex(const uint32_t *index)
+{
+    corpus.kindStart    = index;
+    corpus.dirStart     = corpus.kindStart + CORPUS_NUM_KINDS + 1;
+    corpus.variantStart = corpus.dirStart + NUM_DIRS + 1;
+    corpus.kindCases    = index + CORPUS_INDEX_STARTS;
+    corpus.dirCases     = corpus.kindCases + corpus.header->numCases;
+    corpus.variantCases = corpus.dirCases + (corpus.kindStart[CORPUS_MOVE + 1] - corpus.kindStart[CORPUS_MOVE]);
+}
+
+void corpus_close()
+{
+    if(corpus.mapped) munmap(corpus.map, corpus.mapSize);
+    else              free(corpus.map);
+
+    free(corpus.index);
+
+    memset(&corpus, 0, sizeof(corpus));
+}
+
+/*
+    a case of a file can be used as index of the lists
+*/
+static bool corpus_validCase(const corpus_case_t *c)
+{
+    if(c->kind >= CORPUS_NUM_KINDS) return false;
+    if(c->kind != CORPUS_MOVE) return true;
+    if(c->dir < 1 || c->dir > NUM_DIRS) return false;
+
+    for(int lane = 0; lane < NUM_FIELDW; lane++)
+    {
+        if(c->variants[lane] >= NUM_VARIANTS) return false;
+    }
+
+    return true;
+}
+
+/*
+    the stored index of the mapped corpus fits into the map and lists valid cases
+*/
+static bool corpus_validIndex()
+{
+    const corpus_header_t *header = corpus.header;
+    size_t casesEnd = sizeof(corpus_header_t) + header->numCases * sizeof(corpus_case_t);
+
+    if(header->indexOffset == 0 || header->numIndexed != header->numCases) return false;
+    if(header->indexOffset < casesEnd || header->indexOffset % sizeof(uint32_t) != 0) return false;
+    if(header->indexOffset + CORPUS_INDEX_STARTS * sizeof(uint32_t) > corpus.mapSize) return false;
+
+    const uint32_t *index = (const uint32_t *) ((const char *) corpus.map + header->indexOffset);
+    const uint32_t *kindStart = index, *dirStart = kindStart + CORPUS_NUM_KINDS + 1, *variantStart = dirStart + NUM_DIRS + 1;
+
+    // starts begin at 0 and do not decrease
+    for(int i = 0; i < CORPUS_NUM_KINDS; i++) if(kindStart[i] > kindStart[i + 1]) return false;
+    for(int i = 0; i < NUM_DIRS; i++) if(dirStart[i] > dirStart[i + 1]) return false;
+    for(int i = 0; i < NUM_VARIANTS; i++) if(variantStart[i] > variantStart[i + 1]) return false;
+
+    size_t numMoves = kindStart[CORPUS_MOVE + 1] - kindStart[CORPUS_MOVE];
+
+    if(kindStart[0] != 0 || kindStart[CORPUS_NUM_KINDS] != header->numCases) return false;
+    if(dirStart[0] != 0 || dirStart[NUM_DIRS] != numMoves || variantStart[0] != 0) return false;
+
+    size_t numEntries = header->numCases + numMoves + variantStart[NUM_VARIANTS];
+
+    if(numEntries * sizeof(uint32_t) > corpus.mapSize - header->indexOffset - CORPUS_INDEX_STARTS * sizeof(uint32_t)) return false;
+
+    for(size_t i = 0; i < numEntries; i++)
+    {
+        if(index[CORPUS_INDEX_STARTS + i] >= header->numCases) return false;
+    }
+
+    return true;
+}
+
+/*
+    map a corpus file, returns 1 if it is valid, 0 if the seed is outdated and -1 if it is invalid
+*/
+int corpus_map(const char *file)
+{
+    int fd = open(file, O_RDONLY);
+    if(fd < 0) return -1;
+
+    struct stat st;
+    void *map = MAP_FAILED;
+
+    if(fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(corpus_header_t))
+    {
+        map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    close(fd);
+
+    if(map == MAP_FAILED) return -1;
+
+    const corpus_header_t *header = map;
+    size_t size = (size_t) st.st_size;
+
+    bool valid = header->magic == CORPUS_MAGIC && header->version == CORPUS_VERSION && header->numFieldW == NUM_FIELDW &&
+                 header->caseSize == sizeof(corpus_case_t) && header->numCases <= UINT32_MAX && header->numSeed <= header->numCases &&
+                 sizeof(corpus_header_t) + header->numCases * sizeof(corpus_case_t) <= size;
+
+    const corpus_case_t *cases = (const corpus_case_t *) (header + 1);
+
+    for(size_t i = 0; valid && i < header->numCases; i++) valid = corpus_validCase(&cases[i]);
+
+    if(!valid)
+    {
+        munmap(map, size);
+        return -1;
+    }
+
+    corpus.header  = header;
+    corpus.cases   = (const corpus_case_t *) (header + 1);
+    corpus.map     = map;
+    corpus.mapSize = size;
+    corpus.mapped  = true;
+
+    return header->seedHash == corpus_seedHash() ? 1 : 0;
+}
+
+/*
+    use an image in memory as corpus
+*/
+static void corpus_useImage(void *image, size_t size)
+{
+    corpus.header  = image;
+    corpus.cases   = (const corpus_case_t *) (corpus.header + 1);
+    corpus.map     = image;
+    corpus.mapSize = size;
+    corpus.mapped  = false;
+}
+
+/*
+    append the index to the file (the index of an indexed file is replaced)
+*/
+bool corpus_writeIndex(const char *file, const uint32_t *index, size_t size)
+{
+    int fd = open(file, O_RDWR);
+    if(fd < 0) return false;
+
+    corpus_header_t header = *corpus.header;
+    off_t offset = (off_t) ((sizeof(corpus_header_t) + header.numCases * sizeof(corpus_case_t) + 7) & ~(size_t) 7);
+
+    header.indexOffset = (uint64_t) offset;
+    header.numIndexed  = header.numCases;
+
+    bool ok = ftruncate(fd, offset) == 0 &&
+              pwrite(fd, index, size, offset) == (ssize_t) size &&
+              pwrite(fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header);
+
+    ok = (close(fd) == 0) && ok;
+
+    return ok;
+}
+
+/*
+    open the corpus, file is CORPUS_FILE with the board width ("" = in memory)
+*/
+void corpus_open(const char *file)
+{
+    corpus_close();
+
+    snprintf(corpus.file, sizeof(corpus.file), file, NUM_FIELDW);
+
+    int state = strlen(corpus.file) ? corpus_map(corpus.file) : -1;
+
+    if(state < 1)
+    {
+        // seed again, keep the appended cases of an outdated seed
+        size_t numExtra = 0, size;
+        corpus_case_t *extra = NULL;
+
+        if(state == 0)
+        {
+            numExtra = corpus.header->numCases - corpus.header->numSeed;
+            extra = malloc((numExtra > 0 ? numExtra : 1) * sizeof(corpus_case_t));
+            assert(extra);
+            memcpy(extra, corpus.cases + corpus.header->numSeed, numExtra * sizeof(corpus_case_t));
+        }
+
+        char name[PATH_MAX];
+        memcpy(name, corpus.file, sizeof(name));
+        corpus_close();
+        memcpy(corpus.file, name, sizeof(name));
+
+        void *image = corpus_image(extra, numExtra, &size);
+        free(extra);
+
+        if(strlen(corpus.file) && corpus_writeImage(corpus.file, image, size) && corpus_map(corpus.file) == 1)
+        {
+            free(image);
+        }
+        else
+        {
+            if(strlen(corpus.file)) printf(" Corpus: %s can not be written, using memory\n", corpus.file);
+            corpus.file[0] = '\0';
+            corpus_useImage(image, size);
+        }
+    }
+
+    const corpus_header_t *header = corpus.header;
+
+    if(corpus.mapped && corpus_validIndex())
+    {
+        corpus_setIndex((const uint32_t *) ((const char *) corpus.map + header->indexOffset));
+        return;
+    }
+
+    size_t size = corpus_buildIndex(&corpus.index);
+    corpus_setIndex(corpus.index);
+
+    // the next open maps the index
+    if(corpus.mapped) corpus_writeIndex(corpus.file, corpus.index, size);
+}
+
+/*
+    append cases to the corpus and open it again
+*/
+void corpus_append(const corpus_case_t *cases, size_t num)
+{
+    if(num == 0) return;
+
+    if(!corpus.mapped)
+    {
+        size_t size = corpus.mapSize + num * sizeof(corpus_case_t);
+        void *image = realloc(corpus.map, size);
+        assert(image);
+
+        memcpy((char *) image + corpus.mapSize, cases, num * sizeof(corpus_case_t));
+        ((corpus_header_t *) image)->numCases += num;
+
+        corpus.map = NULL;
+        corpus_close();
+        corpus_useImage(image, size);
+
+        corpus_buildIndex(&corpus.index);
+        corpus_setIndex(corpus.index);
+        return;
+    }
+
+    char file[PATH_MAX];
+    memcpy(file, corpus.file, sizeof(file));
+
+    corpus_header_t header = *corpus.header;
+    off_t offset = (off_t) (sizeof(corpus_header_t) + header.numCases * sizeof(corpus_case_t));
+
+    header.numCases   += num;
+    header.indexOffset = 0;
+    header.numIndexed  = 0;
+
+    corpus_close();
+
+    int fd = open(file, O_RDWR);
+    bool ok = fd >= 0 &&
+              ftruncate(fd, offset) == 0 &&
+              pwrite(fd, cases, num * sizeof(corpus_case_t), offset) == (ssize_t) (num * sizeof(corpus_case_t)) &&
+              pwrite(fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header);
+
+    if(fd >= 0) ok = (close(fd) == 0) && ok;
+    if(!ok) printf(" Corpus: appending to %s failed\n", file);
+
+    // the pattern has no conversion anymore
+    corpus_open(file);
+}
+
+/* === VARIANT SEARCH ==== */
+
+bool updateVariant(variant_store_t *variants, int lane, int dir)
+{    
+    int variant = corpus_variant(lane, dir);
+
+    bool *v = &(variants->v[variant]);
+
+    if(!*v)
+    {
+        *v = true;
+        variants->num++;
+        return true;
+    }
+
+    return false;
+}
+
+variant_store_t* validate_move_tests(variant_store_t *variants)
+{
+    // variant classes with at least one case in the index
+    for(int variant = 0; variant < NUM_VARIANTS; variant++)
+    {
+        if(corpus.variantStart[variant + 1] > corpus.variantStart[variant] && !variants->v[variant])
+        {
+            variants->v[variant] = true;
+            variants->num++;
+        }
+    }
+
+    return variants;
+}
+
+void printLastVariante()
+{
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        printf("%x", moveRefLastValues[i]);
+    }
+}
+
+    /*
+        Checkpoints
+
+        A long search writes its state (known variants, rng, iteration and the
+        cases found so far) every SEARCH_CHECKPOINT_INTERVAL seconds and when it is
+        stopped by a signal. The file is written to <file>.tmp and renamed, so a
+        checkpoint is either the old or the new one.
+
+        A search with the same limit and board width resumes from the checkpoint,
+        the checkpoint is removed when the search is done.
+    */
+
+#define SEARCH_CHECKPOINT_MAGIC 0x6b706373
+#define SEARCH_CHECKPOINT_VERSION 1
+// iterations between two checks of the checkpoint timer
+#define SEARCH_CHECKPOINT_CHECK 4096
+
+typedef struct search_case_st
+{
+    char    test[NUM_FIELDS + 1];
+    char    result[NUM_FIELDS + 1];
+    uint8_t dir;
+    bool    moved;
+    uint8_t values[NUM_FIELDS];
+} search_case_t;
+
+typedef struct search_state_st
+{
+    uint32_t        magic;
+    uint32_t        version;
+    uint32_t        numFieldW;
+    uint32_t        rng;
+    uint64_t        limit;
+    uint64_t        iteration;
+    uint32_t        numCases;
+    uint32_t        maxCases;
+    variant_store_t variants;
+    search_case_t   *cases;
+} search_state_t;
+
+static volatile sig_atomic_t search_stop = 0;
+
+void search_signal(int sig)
+{
+    (void) sig;
+    search_stop = 1;
+}
+
+/*
+    the state is stored as the struct (without the case pointer) followed by the cases
+*/
+bool search_saveCheckpoint(const search_state_t *state, const char *file)
+{
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+
+    FILE *f = fopen(tmp, "wb");
+    if(!f) return false;
+
+    bool ok = fwrite(state, offsetof(search_state_t, cases), 1, f) == 1 &&
+              fwrite(state->cases, sizeof(search_case_t), state->numCases, f) == state->numCases &&
+              fflush(f) == 0 && fsync(fileno(f)) == 0;
+
+    ok = (fclose(f) == 0) && ok;
+
+    return ok && rename(tmp, file) == 0;
+}
+
+bool search_loadCheckpoint(search_state_t *state, const char *file)
+{
+    search_state_t loaded;
+
+    FILE *f = fopen(file, "rb");
+    if(!f) return false;
+
+    bool ok = fread(&loaded, offsetof(search_state_t, cases), 1, f) == 1 &&
+              loaded.magic == SEARCH_CHECKPOINT_MAGIC && loaded.version == SEARCH_CHECKPOINT_VERSION &&
+              loaded.numFieldW == NUM_FIELDW && loaded.limit == state->limit;
+
+    if(ok)
+    {
+        loaded.maxCases = loaded.numCases > 0 ? loaded.numCases : 1;
+        loaded.cases = malloc(sizeof(search_case_t) * loaded.maxCases);
+        ok = loaded.cases && fread(loaded.cases, sizeof(search_case_t), loaded.numCases, f) == loaded.numCases;
+
+        if(ok)
+        {
+            free(state->cases);
+            *state = loaded;
+        }
+        else free(loaded.cases);
+    }
+
+    fclose(f);
+
+    return ok;
+}
+
+void search_printCase(const search_case_t *c)
+{
+    printf(" {\"%s\", %s, \"%s\", %s}, // (", c->test, game_moveNames[c->dir], c->result, c->moved ? "true " : "false");
+    for(int i = 0; i < NUM_FIELDS; i++) printf("%x", c->values[i]);
+    printf(")");
+}
+
+/*
+    search random boards for new variants, checkpoint is the checkpoint file ("" = none)
+*/
+void search_variants_rnd(size_t limit, const char *checkpoint)
+{
+    TRACE_SCOPE("search_variants_rnd");
+
+    printf("\n=== search_variants_rnd ===\n");
+
+    search_state_t state = {
+        .magic     = SEARCH_CHECKPOINT_MAGIC,
+        .version   = SEARCH_CHECKPOINT_VERSION,
+        .numFieldW = NUM_FIELDW,
+        .rng       = (uint32_t) time(NULL) | 1,
+        .limit     = limit,
+        .maxCases  = 64,
+        .cases     = malloc(sizeof(search_case_t) * 64),
+    };
+    assert(state.cases);
+
+    bool useCheckpoint = strlen(checkpoint) > 0;
+
+    if(useCheckpoint && search_loadCheckpoint(&state, checkpoint))
+    {
+        testVariants = state.variants;
+        printf("\n Resumed: %s (iteration %" PRIu64 ", %u cases)\n\n", checkpoint, state.iteration, state.numCases);
+        for(uint32_t c = 0; c < state.numCases; c++)
+        {
+            search_printCase(&state.cases[c]);
+            printf("\n");
+        }
+    }
+
+    else
+    {
+        validate_move_tests(&testVariants);
+    }
+
+    printf("\n Limit: %lu", limit);
+    printf("\n Known Variants: %d\n\n", testVariants.num);
+
+    void (*oldInt)(int)  = SIG_DFL;
+    void (*oldTerm)(int) = SIG_DFL;
+    if(useCheckpoint)
+    {
+        search_stop = 0;
+        oldInt  = signal(SIGINT,  search_signal);
+        oldTerm = signal(SIGTERM, search_signal);
+    }
+
+    char test[NUM_FIELDS + 1] = {0};
+    time_t lastCheckpoint = time(NULL);
+
+    metrics_begin("search");
+    metrics_set(&metrics->iterations, state.iteration);
+    metrics_set(&metrics->variants, (uint64_t) testVariants.num);
+
+    while(state.iteration < limit && !search_stop)
+    {
+        for(int j = 0; j < NUM_FIELDS; j++)
+        {
+            state.rng ^= state.rng << 13;
+            state.rng ^= state.rng >> 17;
+            state.rng ^= state.rng << 5;
+
+            test[j] = getSign((int) (state.rng % NUM_SIGNS));
+        }
+
+        for(int dir = 1; dir <= NUM_DIRS; dir++)
+        {
+            memcpy(game_field, test, NUM_FIELDS);
+            bool moved = game_move_ref(dir);
+
+            bool newVariantFound = false;
+
+            for(int lane = 0; lane < NUM_FIELDW; lane++)
+            {
+                if(updateVariant(&testVariants, lane, dir))
+                {
+                    newVariantFound = true;
+                }
+            }
+
+            if(newVariantFound || DEBUG_SEARCH)
+            {
+                search_case_t found = { .dir = (uint8_t) dir, .moved = moved };
+                memcpy(found.test, test, NUM_FIELDS + 1);
+                memcpy(found.result, game_field, NUM_FIELDS + 1);
+                for(int i = 0; i < NUM_FIELDS; i++) found.values[i] = (uint8_t) moveRefLastValues[i];
+
+                if(newVariantFound)
+                {
+                    if(state.numCases == state.maxCases)
+                    {
+                        state.maxCases *= 2;
+                        state.cases = realloc(state.cases, sizeof(search_case_t) * state.maxCases);
+                        assert(state.cases);
+                    }
+
+                    state.cases[state.numCases++] = found;
+                    metrics_set(&metrics->variants, (uint64_t) testVariants.num);
+                }
+
+                search_printCase(&found);
+                if(DEBUG_SEARCH && newVariantFound) printf(" (new)");
+                printf("\n");
+            }
+        }
+
+        state.iteration++;
+        metrics_add(&metrics->iterations, 1);
+        metrics_add(&metrics->moves, NUM_DIRS);
+
+        if(useCheckpoint && (state.iteration % SEARCH_CHECKPOINT_CHECK) == 0 && time(NULL) - lastCheckpoint >= SEARCH_CHECKPOINT_INTERVAL)
+        {
+            state.variants = testVariants;
+            if(!search_saveCheckpoint(&state, checkpoint)) printf(" Checkpoint failed: %s\n", checkpoint);
+            lastCheckpoint = time(NULL);
+        }
+    }
+
+    metrics_end();
+
+    if(useCheckpoint)
+    {
+        signal(SIGINT,  oldInt);
+        signal(SIGTERM, oldTerm);
+
+        if(search_stop)
+        {
+            state.variants = testVariants;
+            bool saved = search_saveCheckpoint(&state, checkpoint);
+            printf("\n Stopped: %s (iteration %" PRIu64 ")\n", saved ? checkpoint : "checkpoint failed", state.iteration);
+            free(state.cases);
+            exit(EXIT_FAILURE);
+        }
+
+        remove(checkpoint);
+    }
+
+    printf("\n New Variants: %u", state.numCases);
+
+    if(state.numCases > 0)
+    {
+        corpus_case_t *cases = malloc(sizeof(corpus_case_t) * state.numCases);
+        assert(cases);
+
+        for(uint32_t c = 0; c < state.numCases; c++) corpus_makeMove(&cases[c], state.cases[c].test, state.cases[c].dir);
+
+        corpus_append(cases, state.numCases);
+        printf("\n Corpus: %zu moves (%s)", corpus_numMoves(), strlen(corpus.file) ? corpus.file : "memory");
+
+        free(cases);
+    }
+
+    printf("\n");
+
+    free(state.cases);
+}
+
+
+/* === FUZZING ==== */
+
+    /*
+        Coverage guided fuzzing
+
+        Boards which reach a new condition or a new pair of conditions of move4
+        (see Coverage) are kept in a corpus. Most new boards are mutations of a
+        corpus board: set or clear a field, copy a neighbour (makes merges
+        likely) or swap two fields. Every board is moved in all directions with
+        game_move4 and compared with game_move_ref (board and moved) and
+        game_moveAll (score).
+
+        The same number of uniform random boards (as in search_variants_rnd) is
+        run for comparison.
+    */
+
+// maximum number of boards in the corpus
+#define FUZZ_CORPUS_SIZE 4096
+// maximum number of mutations of a board
+#define FUZZ_MUTATIONS 4
+// number of mismatches printed
+#define FUZZ_NUM_EXAMPLES 5
+
+typedef struct fuzz_st
+{
+    char     corpus[FUZZ_CORPUS_SIZE][NUM_FIELDS + 1];
+    int      numCorpus;
+    uint32_t rng;
+    long     numMismatches;
+    long     lastNew;           // iteration which reached the last new coverage
+    long     reached;           // iteration which reached the coverage goal (-1 = not reached)
+} fuzz_t;
+
+static inline uint32_t fuzz_random(uint32_t *rng)
+{
+    *rng ^= *rng << 13;
+    *rng ^= *rng >> 17;
+    *rng ^= *rng << 5;
+
+    return *rng;
+}
+
+void fuzz_resetCoverage()
+{
+    memset(move4_coverage, 0, sizeof(move4_coverage));
+    memset(move4_pairCoverage, 0, sizeof(move4_pairCoverage));
+    move4_numConditions = 0;
+    move4_numPairs = 0;
+}
+
+/*
+    move board in all directions with v4 and ref, returns true if it reached new coverage
+*/
+bool fuzz_run(fuzz_t *f, const char *board)
+{
+    int covered = move4_numConditions + move4_numPairs;
+    game_moves_t moves;
+
+    game_moveAll(board, &moves);
+
+    for(int dir = 1; dir <= NUM_DIRS; dir++)
+    {
+        char field[NUM_FIELDS + 1], score[NUM_SCORE + 1];
+
+        // leading zeros, the score is compared as a number
+        memcpy(game_field, board, NUM_FIELDS);
+        strncpy(game_score, "0000000", NUM_SCORE + 1);
+        game_fieldIndex = 0;
+        bool moved = game_move4(dir);
+        game_scoreRefresh();
+        memcpy(field, game_field, NUM_FIELDS + 1);
+        memcpy(score, game_score, NUM_SCORE + 1);
+
+        memcpy(game_field, board, NUM_FIELDS);
+        bool movedRef = game_move_ref(dir);
+
+        if(moved == movedRef && strncmp(field, game_field, NUM_FIELDS) == 0 && (uint32_t) atol(score) == moves.score[dir]) continue;
+
+        if(f->numMismatches++ < FUZZ_NUM_EXAMPLES)
+        {
+            printf(" mismatch '%s' %s: v4 '%s' %s ref '%s' %" PRIu32 "\n", board, game_moveLabels[dir], field, score, game_field, moves.score[dir]);
+        }
+    }
+
+    return move4_numConditions + move4_numPairs > covered;
+}
+
+void fuzz_mutate(char *board, uint32_t *rng)
+{
+    int numMutations = 1 + (int) (fuzz_random(rng) % FUZZ_MUTATIONS);
+
+    for(int i = 0; i < numMutations; i++)
+    {
+        int field = (int) (fuzz_random(rng) % NUM_FIELDS);
+        int other = (int) (fuzz_random(rng) % NUM_FIELDS);
+
+        switch(fuzz_random(rng) % 4)
+        {
+            case 0: board[field] = getSign((int) (fuzz_random(rng) % NUM_SIGNS)); break;
+            case 1: board[field] = getSign(0); break;
+            case 2: 
+            {
+                // copy the right or the lower neighbour
+                bool right = fuzz_random(rng) & 1;
+                int  next  = right ? field + 1 : field + NUM_FIELDW;
+                if(right && (next % NUM_FIELDW) == 0) next = field - 1;
+                if(!right && next >= NUM_FIELDS) next = field - NUM_FIELDW;
+                board[field] = board[next];
+                break;
+            }
+            case 3:
+            {
+                char swap    = board[field];
+                board[field] = board[other];
+                board[other] = swap;
+                break;
+            }
+        }
+    }
+}
+
+/*
+    run iterations boards, guided uses the corpus, goal is a coverage to reach (0 = none)
+*/
+void fuzz_search(fuzz_t *f, long iterations, bool guided, int goal)
+{
+    char board[NUM_FIELDS + 1] = {0};
+
+    fuzz_resetCoverage();
+    move4_recordCoverage = true;
+    f->numCorpus = 0;
+    f->numMismatches = 0;
+    f->lastNew = 0;
+    f->reached = -1;
+
+    for(long i = 0; i < iterations; i++)
+    {
+        if(guided && f->numCorpus > 0 && (fuzz_random(&f->rng) % 8) != 0)
+        {
+            memcpy(board, f->corpus[fuzz_random(&f->rng) % (uint32_t) f->numCorpus], NUM_FIELDS + 1);
+            fuzz_mutate(board, &f->rng);
+        }
+        else
+        {
+            for(int j = 0; j < NUM_FIELDS; j++) board[j] = getSign((int) (fuzz_random(&f->rng) % NUM_SIGNS));
+        }
+
+        if(fuzz_run(f, board))
+        {
+            f->lastNew = i + 1;
+            if(guided && f->numCorpus < FUZZ_CORPUS_SIZE) memcpy(f->corpus[f->numCorpus++], board, NUM_FIELDS + 1);
+        }
+
+        if(goal && f->reached < 0 && move4_numConditions + move4_numPairs >= goal) f->reached = i + 1;
+
+        metrics_add(&metrics->iterations, 1);
+        metrics_add(&metrics->moves, NUM_DIRS);
+    }
+    move4_recordCoverage = false;
+}
+
+/*
+    compare uniform random boards with coverage guided boards
+*/
+void fuzz()
+{
+    TRACE_SCOPE("fuzz");
+
+    printf("\n=== fuzz ===\n\n");
+
+    static fuzz_t f;
+    f.rng = (uint32_t) time(NULL) | 1;
+
+    metrics_begin("fuzz");
+
+    fuzz_search(&f, FUZZ_ITERATIONS, false, 0);
+    int randomConditions = move4_numConditions, randomPairs = move4_numPairs;
+    long randomLastNew = f.lastNew, randomMismatches = f.numMismatches;
+
+    fuzz_search(&f, FUZZ_ITERATIONS, true, randomConditions + randomPairs);
+
+    metrics_set(&metrics->mismatches, (uint64_t) (randomMismatches + f.numMismatches));
+    metrics_end();
+
+    printf(" mode     conditions  pairs  last new  mismatches\n");
+    printf(" random   %10d %6d %9ld %11ld\n", randomConditions, randomPairs, randomLastNew, randomMismatches);
+    printf(" guided   %10d %6d %9ld %11ld\n", move4_numConditions, move4_numPairs, f.lastNew, f.numMismatches);
+    printf("\n");
+    printf(" Boards: %d\n", FUZZ_ITERATIONS);
+    printf(" Corpus: %d\n", f.numCorpus);
+    if(f.reached > 0) printf(" Guided reached the random coverage after %ld boards (random: %ld)\n", f.reached, randomLastNew);
+}
+
+/* === COMPACTION ==== */
+
+    /*
+        Stimulus compaction
+
+        Gate level simulation is slow per cycle, so the vectors for it are
+        selected from many candidates to cover every goal reached by any
+        candidate with as few vectors as possible:
+
+            variants    variant class of every lane (corpus_variant)
+            conditions  condition of every move4 step
+            pairs       pair of the previous and the current condition
+            carries     digit carries of every addScore1 call
+
+        A vector is one move from a preloaded board and score. The candidates are
+        the move cases of the corpus and random boards (half uniform, half with
+        small values which merge more often), all with random scores where most
+        digits are 9 to provoke long carry chains.
+
+        The selection is a greedy set cover: the vector which covers most of the
+        open goals is taken next (lazy with a max heap, the gain of a candidate
+        can only shrink), ties are broken by fewer cycles. The selected vectors
+        are written to COMPACT_FILE as a python module for cocotb, versioned by
+        COMPACT_VERSION. compact_read reads it back.
+
+        The RTL has no board/score preload port yet, the header of the module
+        says so. A cocotb test can import the vectors but not drive them until
+        the port exists.
+    */
+
+#define COMPACT_VERSION 1
+
+#define COMPACT_GOAL_VARIANTS   0
+#define COMPACT_GOAL_CONDITIONS (COMPACT_GOAL_VARIANTS + NUM_VARIANTS)
+#define COMPACT_GOAL_PAIRS      (COMPACT_GOAL_CONDITIONS + MOVE4_TABLE_SIZE)
+#define COMPACT_GOAL_CARRIES    (COMPACT_GOAL_PAIRS + (MOVE4_TABLE_SIZE + 1) * MOVE4_TABLE_SIZE)
+#define COMPACT_NUM_GOALS       (COMPACT_GOAL_CARRIES + (1 << NUM_SCORE))
+
+typedef struct compact_vector_st
+{
+    char     board[NUM_FIELDS + 1];
+    char     score[NUM_SCORE + 1];
+    uint8_t  dir;
+    bool     moved;
+    char     result[NUM_FIELDS + 1];
+    char     resultScore[NUM_SCORE + 1];
+    long     cycles;
+    size_t   firstGoal;
+    int      numGoals;
+} compact_vector_t;
+
+typedef struct compact_st
+{
+    compact_vector_t *vectors;
+    size_t            numVectors;
+    uint32_t         *goals;
+    size_t            numGoals;
+    size_t            maxGoals;
+    uint32_t         *stamp;            // last vector + 1 which reached a goal
+    size_t           *selected;
+    size_t            numSelected;
+    int               reached[4];       // goals reached by the candidates (by kind)
+} compact_t;
+
+static const char *compact_goalNames[] = { "variants", "conditions", "pairs", "carries" };
+
+static int compact_goalKind(uint32_t goal)
+{
+    if(goal >= COMPACT_GOAL_CARRIES)    return 3;
+    if(goal >= COMPACT_GOAL_PAIRS)      return 2;
+    if(goal >= COMPACT_GOAL_CONDITIONS) return 1;
+
+    return 0;
+}
+
+static void compact_addGoal(compact_t *c, size_t vector, uint32_t goal)
+{
+    if(c->stamp[goal] == vector + 1) return;
+    c->stamp[goal] = (uint32_t) (vector + 1);
+
+    if(c->numGoals == c->maxGoals)
+    {
+        c->maxGoals = c->maxGoals ? c->maxGoals * 2 : 4096;
+        c->goals = realloc(c->goals, c->maxGoals * sizeof(uint32_t));
+        assert(c->goals);
+    }
+
+    c->goals[c->numGoals++] = goal;
+    c->vectors[vector].numGoals++;
+}
+
+/*
+    run the next candidate and collect its goals
+*/
+void compact_add(compact_t *c, const char *board, const char *score, int dir)
+{
+    compact_vector_t *v = &c->vectors[c->numVectors];
+    size_t vector = c->numVectors++;
+    corpus_case_t ref;
+
+    corpus_makeMove(&ref, board, dir);
+
+    memset(v, 0, sizeof(*v));
+    memcpy(v->board, board, NUM_FIELDS);
+    memcpy(v->score, score, NUM_SCORE);
+    v->dir = (uint8_t) dir;
+    v->firstGoal = c->numGoals;
+
+    game_reset();
+    memcpy(game_field, board, NUM_FIELDS);
+    memcpy(game_score, score, NUM_SCORE);
+
+    v->moved = game_move4(dir);
+    v->cycles = memory_cycles() + game_numSteps;
+    game_scoreRefresh();
+    memcpy(v->result, game_field, NUM_FIELDS);
+    memcpy(v->resultScore, game_score, NUM_SCORE);
+
+    assert(move4_pathLength < MOVE4_MAX_PATH);
+
+    for(int lane = 0; lane < NUM_FIELDW; lane++) compact_addGoal(c, vector, COMPACT_GOAL_VARIANTS + ref.variants[lane]);
+
+    for(int i = 0; i < move4_pathLength; i++)
+    {
+        int last = i ? move4_path[i - 1] : MOVE4_TABLE_SIZE;
+
+        compact_addGoal(c, vector, COMPACT_GOAL_CONDITIONS + move4_path[i]);
+        compact_addGoal(c, vector, COMPACT_GOAL_PAIRS + last * MOVE4_TABLE_SIZE + move4_path[i]);
+    }
+
+    if(game_scoreVersion == 1)
+    {
+        for(int i = 0; i < game_numScoreCarries; i++) compact_addGoal(c, vector, COMPACT_GOAL_CARRIES + game_scoreCarries[i]);
+    }
+}
+
+/*
+    random score, most digits are 9 (blank leading digits below 10^6)
+*/
+void compact_randomScore(char score[NUM_SCORE + 1], uint32_t *rng)
+{
+    int value = 0;
+
+    for(int i = 0; i < NUM_SCORE; i++)
+    {
+        uint32_t r = fuzz_random(rng);
+        value = value * 10 + (int) ((r & 1) ? 9 : (r >> 1) % 10);
+    }
+
+    value >>= fuzz_random(rng) % 24;
+
+    snprintf(score, NUM_SCORE + 1, value >= 1000000 ? "%07d" : "%7d", value);
+}
+
+typedef struct compact_entry_st
+{
+    int    gain;
+    size_t vector;
+} compact_entry_t;
+
+static bool compact_before(const compact_t *c, compact_entry_t a, compact_entry_t b)
+{
+    if(a.gain != b.gain) return a.gain > b.gain;
+
+    return c->vectors[a.vector].cycles < c->vectors[b.vector].cycles;
+}
+
+static void compact_push(const compact_t *c, compact_entry_t *heap, size_t *num, compact_entry_t e)
+{
+    size_t i = (*num)++;
+
+    while(i > 0 && compact_before(c, e, heap[(i - 1) / 2]))
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+
+    heap[i] = e;
+}
+
+static compact_entry_t compact_pop(const compact_t *c, compact_entry_t *heap, size_t *num)
+{
+    compact_entry_t top = heap[0], e = heap[--(*num)];
+    size_t i = 0;
+
+    while(true)
+    {
+        size_t child = 2 * i + 1;
+        if(child >= *num) break;
+        if(child + 1 < *num && compact_before(c, heap[child + 1], heap[child])) child++;
+        if(!compact_before(c, heap[child], e)) break;
+
+        heap[i] = heap[child];
+        i = child;
+    }
+
+    if(*num > 0) heap[i] = e;
+
+    return top;
+}
+
+/*
+    greedy set cover over the goals of all candidates
+*/
+void compact_select(compact_t *c)
+{
+    bool *covered = calloc(COMPACT_NUM_GOALS, sizeof(bool));
+    compact_entry_t *heap = malloc((c->numVectors > 0 ? c->numVectors : 1) * sizeof(compact_entry_t));
+    size_t numHeap = 0;
+
+    assert(covered && heap);
+
+    c->selected = realloc(c->selected, (c->numVectors > 0 ? c->numVectors : 1) * sizeof(size_t));
+    c->numSelected = 0;
+    assert(c->selected);
+
+    for(size_t i = 0; i < c->numVectors; i++)
+    {
+        if(c->vectors[i].numGoals) compact_push(c, heap, &numHeap, (compact_entry_t) { c->vectors[i].numGoals, i });
+    }
+
+    while(numHeap > 0)
+    {
+        compact_entry_t e = compact_pop(c, heap, &numHeap);
+        compact_vector_t *v = &c->vectors[e.vector];
+
+        int gain = 0;
+        for(int g = 0; g < v->numGoals; g++) gain += !covered[c->goals[v->firstGoal + g]];
+
+        if(gain == 0) continue;
+
+        // the gain is still the best, otherwise queue it with the new gain
+        if(gain < e.gain && numHeap > 0 && compact_before(c, heap[0], (compact_entry_t) { gain, e.vector }))
+        {
+            compact_push(c, heap, &numHeap, (compact_entry_t) { gain, e.vector });
+            continue;
+        }
+
+        for(int g = 0; g < v->numGoals; g++) covered[c->goals[v->firstGoal + g]] = true;
+        c->selected[c->numSelected++] = e.vector;
+    }
+
+    free(heap);
+    free(covered);
+}
+
+/*
+    goals reached by the selected vectors (or all if selected is false), by kind
+*/
+void compact_count(const compact_t *c, bool selected, int counts[4])
+{
+    bool *covered = calloc(COMPACT_NUM_GOALS, sizeof(bool));
+    assert(covered);
+
+    memset(counts, 0, 4 * sizeof(int));
+
+    size_t num = selected ? c->numSelected : c->numVectors;
+
+    for(size_t i = 0; i < num; i++)
+    {
+        const compact_vector_t *v = &c->vectors[selected ? c->selected[i] : i];
+
+        for(int g = 0; g < v->numGoals; g++)
+        {
+            uint32_t goal = c->goals[v->firstGoal + g];
+            if(!covered[goal]) counts[compact_goalKind(goal)]++;
+            covered[goal] = true;
+        }
+    }
+
+    free(covered);
+}
+
+/*
+    candidates: the corpus moves and numRandom random boards
+*/
+void compact_init(compact_t *c, size_t numRandom, uint32_t seed)
+{
+    size_t numCorpus = corpus_numMoves();
+    uint32_t rng = seed | 1;
+
+    memset(c, 0, sizeof(*c));
+    c->vectors = malloc((numCorpus + numRandom + 1) * sizeof(compact_vector_t));
+    c->stamp = calloc(COMPACT_NUM_GOALS, sizeof(uint32_t));
+    assert(c->vectors && c->stamp);
+
+    move4_recordCoverage = true;
+
+    for(size_t i = 0; i < numCorpus; i++)
+    {
+        char score[NUM_SCORE + 1];
+        compact_randomScore(score, &rng);
+        compact_add(c, corpus_move(i)->test, score, corpus_move(i)->dir);
+    }
+
+    for(size_t i = 0; i < numRandom; i++)
+    {
+        char board[NUM_FIELDS + 1] = {0}, score[NUM_SCORE + 1];
+
+        for(int j = 0; j < NUM_FIELDS; j++)
+        {
+            uint32_t r = fuzz_random(&rng);
+            board[j] = getSign((int) ((i & 1) ? r % NUM_SIGNS : r % 4));
+        }
+
+        compact_randomScore(score, &rng);
+        compact_add(c, board, score, 1 + (int) (fuzz_random(&rng) % NUM_DIRS));
+    }
+
+    move4_recordCoverage = false;
+
+    compact_count(c, false, c->reached);
+}
+
+void compact_free(compact_t *c)
+{
+    free(c->vectors);
+    free(c->goals);
+    free(c->stamp);
+    free(c->selected);
+}
+
+/*
+    write the selected vectors as python module
+*/
+void compact_write(const compact_t *c, FILE *f)
+{
+    fprintf(f, "# Gate level stimulus, generated by emu/emu.c (COMPACT), do not edit\n");
+    fprintf(f, "#\n");
+    fprintf(f, "# Every vector is one move from a preloaded board and score:\n");
+    fprintf(f, "#   (board, score, direction, expected board, expected score, moved)\n");
+    fprintf(f, "# board: NUM_FIELDS signs row by row (' ' empty, '1' = 2, '2' = 4, ...)\n");
+    fprintf(f, "# direction: 1 up, 2 down, 3 left, 4 right\n");
+    fprintf(f, "#\n");
+    fprintf(f, "# The RTL has no board/score preload port yet: the vectors can be imported\n");
+    fprintf(f, "# by a cocotb test, but only driven once the port exists.\n\n");
+    fprintf(f, "STIMULUS_VERSION = %d\n", COMPACT_VERSION);
+    fprintf(f, "NUM_FIELDW = %d\n", NUM_FIELDW);
+    fprintf(f, "NUM_SCORE = %d\n\n", NUM_SCORE);
+
+    int counts[4];
+    long cycles = 0;
+    compact_count(c, true, counts);
+    for(size_t i = 0; i < c->numSelected; i++) cycles += c->vectors[c->selected[i]].cycles;
+
+    fprintf(f, "# goals covered (all reached by %zu candidates)\n", c->numVectors);
+    fprintf(f, "coverage = {\n");
+    for(int k = 0; k < 4; k++) fprintf(f, "    \"%s\": %d,\n", compact_goalNames[k], counts[k]);
+    fprintf(f, "}\n\n");
+    fprintf(f, "# emulated cycles of all vectors\n");
+    fprintf(f, "cycles = %ld\n\n", cycles);
+
+    fprintf(f, "vectors = [\n");
+    for(size_t i = 0; i < c->numSelected; i++)
+    {
+        const compact_vector_t *v = &c->vectors[c->selected[i]];
+
+        fprintf(f, "    (\"%s\", \"%s\", %d, \"%s\", \"%s\", %s),\n", v->board, v->score, v->dir, v->result, v->resultScore, v->moved ? "True" : "False");
+    }
+    fprintf(f, "]\n");
+}
+
+/*
+    read the vectors of a module written by compact_write
+
+    returns the number of vectors, -1 if the version, the width or a vector does not match
+*/
+long compact_read(FILE *f, compact_vector_t *vectors, size_t maxVectors)
+{
+    char line[256], moved[8], format[96];
+    int version = -1, fieldW = -1, numScore = -1;
+    bool inVectors = false;
+    long num = 0;
+
+    snprintf(format, sizeof(format), " (\"%%%d[^\"]\", \"%%%d[^\"]\", %%d, \"%%%d[^\"]\", \"%%%d[^\"]\", %%7[A-Za-z])",
+        NUM_FIELDS, NUM_SCORE, NUM_FIELDS, NUM_SCORE);
+
+    while(fgets(line, sizeof(line), f))
+    {
+        if(!inVectors)
+        {
+            if(sscanf(line, "STIMULUS_VERSION = %d", &version) == 1) continue;
+            if(sscanf(line, "NUM_FIELDW = %d", &fieldW) == 1) continue;
+            if(sscanf(line, "NUM_SCORE = %d", &numScore) == 1) continue;
+
+            if(strncmp(line, "vectors = [", 11) == 0)
+            {
+                if(version != COMPACT_VERSION || fieldW != NUM_FIELDW || numScore != NUM_SCORE) return -1;
+                inVectors = true;
+            }
+            continue;
+        }
+
+        if(line[0] == ']') return num;
+        if((size_t) num == maxVectors) return -1;
+
+        compact_vector_t *v = &vectors[num];
+        int dir;
+
+        memset(v, 0, sizeof(*v));
+        if(sscanf(line, format, v->board, v->score, &dir, v->result, v->resultScore, moved) != 6) return -1;
+        if(strlen(v->board) != NUM_FIELDS || strlen(v->result) != NUM_FIELDS) return -1;
+        if(strlen(v->score) != NUM_SCORE || strlen(v->resultScore) != NUM_SCORE) return -1;
+        if(dir < 1 || dir > NUM_DIRS) return -1;
+
+        v->dir = (uint8_t) dir;
+        v->moved = strcmp(moved, "True") == 0;
+        num++;
+    }
+
+    // no closing bracket
+    return -1;
+}
+
+void compact()
+{
+    TRACE_SCOPE("compact");
+
+    printf("\n=== compact ===\n\n");
+
+    static compact_t c;
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    compact_init(&c, COMPACT_CANDIDATES, COMPACT_SEED);
+    compact_select(&c);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int counts[4];
+    long cyclesAll = 0, cyclesSelected = 0;
+
+    compact_count(&c, true, counts);
+    for(size_t i = 0; i < c.numVectors; i++) cyclesAll += c.vectors[i].cycles;
+    for(size_t i = 0; i < c.numSelected; i++) cyclesSelected += c.vectors[c.selected[i]].cycles;
+
+    printf(" goal        reached  covered\n");
+    for(int k = 0; k < 4; k++) printf(" %-10s %8d %8d\n", compact_goalNames[k], c.reached[k], counts[k]);
+
+    printf("\n");
+    printf(" Candidates: %zu (%zu from the corpus)\n", c.numVectors, corpus_numMoves());
+    printf(" Selected: %zu\n", c.numSelected);
+    printf(" Cycles: %ld of %ld (%.3f %%)\n", cyclesSelected, cyclesAll, cyclesAll ? 100.0 * (double) cyclesSelected / (double) cyclesAll : 0.0);
+    printf(" Time: %.1f s\n", (double) (end.tv_sec - begin.tv_sec) + ((double) (end.tv_nsec - begin.tv_nsec) * 1e-9));
+
+    FILE *f = fopen(COMPACT_FILE, "w");
+    if(f)
+    {
+        compact_write(&c, f);
+        fclose(f);
+        printf(" Written: %s\n", COMPACT_FILE);
+    }
+    else printf(" Can not write: %s\n", COMPACT_FILE);
+
+    compact_free(&c);
+    game_reset();
+}
+
+/* === SCORE CHECK ==== */
+
+    /*
+        Every score state is packed into one number:
+
+            state = (value << 1) | zeroPadded
+
+        value       0 .. 9.999.999
+        zeroPadded  leading digits are '0' instead of ' ', this happens after the
+                    score wrapped around (only distinct for values below 1.000.000)
+
+        The states are split into chunks which are taken by the worker threads.
+    */
+
+// number of different score values
+#define CHECK_SCORE_NUM_VALUES 10000000
+// number of packed states
+#define CHECK_SCORE_NUM_STATES ((size_t) CHECK_SCORE_NUM_VALUES * 2)
+// number of states taken by a thread at once
+#define CHECK_SCORE_CHUNK 65536
+// number of mismatches printed per tile value
+#define CHECK_SCORE_NUM_EXAMPLES 3
+
+typedef struct check_score_st
+{
+    atomic_size_t next;
+    atomic_size_t numChecked;
+    atomic_size_t numScore;
+    atomic_size_t numDecSep;
+    atomic_size_t mismatches[NUM_SIGNS + 1][2];
+    atomic_int    examples[NUM_SIGNS + 1];
+    FILE          *file;
+} check_score_t;
+
+/*
+    number of worker threads
+*/
+int get_numThreads()
+{
+    if(NUM_THREADS > 0) return NUM_THREADS;
+
+    long num = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return num > 0 ? (int) num : 1;
+}
+
+/*
+    convert a packed state into the score string
+*/
+void check_score_unpack(size_t state, char score[NUM_SCORE + 1])
+{
+    int  value      = (int) (state >> 1);
+    bool zeroPadded = state & 1;
+
+    for(int i = NUM_SCORE - 1; i >= 0; i--)
+    {
+        bool leading = (value == 0) && (i < NUM_SCORE - 1);
+
+        score[i] = leading ? (zeroPadded ? '0' : ' ') : (char) ('0' + (value % 10));
+        value /= 10;
+    }
+
+    score[NUM_SCORE] = '\0';
+}
+
+void *check_score_worker(void *arg)
+{
+    check_score_t *check = arg;
+
+    char test[NUM_SCORE + 1];
+    char result[NUM_SCORE + 1];
+    size_t begin;
+
+    while((begin = atomic_fetch_add(&check->next, CHECK_SCORE_CHUNK)) < CHECK_SCORE_NUM_STATES)
+    {
+        size_t end = begin + CHECK_SCORE_CHUNK;
+        size_t numChecked = 0;
+
+        if(end > CHECK_SCORE_NUM_STATES) end = CHECK_SCORE_NUM_STATES;
+
+        for(size_t state = begin; state < end; state++)
+        {
+            bool zeroPadded = state & 1;
+
+            // zero padding makes no difference if all digits are used
+            if(zeroPadded && (state >> 1) >= 1000000) continue;
+
+            check_score_unpack(state, test);
+
+            for(int value = 1; value <= NUM_SIGNS; value++)
+            {
+                memcpy(game_score, test, NUM_SCORE + 1);
+                uint8_t decSep = game_addScore1(value);
+                memcpy(result, game_score, NUM_SCORE + 1);
+
+                memcpy(game_score, test, NUM_SCORE + 1);
+                uint8_t decSepRef = game_addScore_ref(value);
+
+                bool testScore  = (strncmp(result, game_score, NUM_SCORE) == 0);
+                bool testDecSep = (decSep == decSepRef);
+
+                numChecked++;
+
+                if(testScore && testDecSep) continue;
+
+                if(!testScore)  atomic_fetch_add(&check->numScore, 1);
+                if(!testDecSep) atomic_fetch_add(&check->numDecSep, 1);
+                atomic_fetch_add(&check->mismatches[value][zeroPadded], 1);
+                metrics_add(&metrics->mismatches, 1);
+
+                if(check->file) fprintf(check->file, "'%s' + %2d: v1 '%s' %02x ref '%s' %02x\n", test, value, result, decSep, game_score, decSepRef);
+
+                if(atomic_fetch_add(&check->examples[value], 1) < CHECK_SCORE_NUM_EXAMPLES)
+                {
+                    printf(" '%s' + %2d(%6d): v1 '%s' [%02x] ref '%s' [%02x]\n", test, value, 1 << value, result, decSep, game_score, decSepRef);
+                }
+            }
+        }
+
+        atomic_fetch_add(&check->numChecked, numChecked);
+        metrics_add(&metrics->iterations, end - begin);
+    }
+
+    return NULL;
+}
+
+/*
+    compare game_addScore1 with game_addScore_ref for every score state and tile value
+*/
+void check_score()
+{
+    TRACE_SCOPE("check_score");
+
+    printf("\n=== check_score ===\n\n");
+
+    static check_score_t check;
+    int numThreads = get_numThreads();
+    pthread_t threads[numThreads];
+
+    check.file = strlen(CHECK_SCORE_FILE) ? fopen(CHECK_SCORE_FILE, "w") : NULL;
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    metrics_begin("check_score");
+
+    for(int i = 0; i < numThreads; i++) pthread_create(&threads[i], NULL, check_score_worker, &check);
+    for(int i = 0; i < numThreads; i++) pthread_join(threads[i], NULL);
+
+    metrics_end();
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if(check.file) fclose(check.file);
+
+    printf("\n value  blank  zero padded\n");
+    for(int value = 1; value <= NUM_SIGNS; value++)
+    {
+        printf(" %5d %7zu %7zu\n", 1 << value, (size_t) check.mismatches[value][0], (size_t) check.mismatches[value][1]);
+    }
+
+    printf("\n");
+    printf(" Threads: %d\n", numThreads);
+    printf(" Checked: %zu\n", (size_t) check.numChecked);
+    printf(" Mismatches (score): %zu\n", (size_t) check.numScore);
+    printf(" Mismatches (decSep): %zu\n", (size_t) check.numDecSep);
+    printf(" Time: %.1f s\n", (double) (end.tv_sec - begin.tv_sec) + ((double) (end.tv_nsec - begin.tv_nsec) * 1e-9));
+    if(check.file) printf(" Mismatches written to: %s\n", CHECK_SCORE_FILE);
+}
+
+/* === TRAINING ==== */
+
+    /*
+        N-tuple network
+
+        The value of a board is the sum of the weights of its tuples. A tuple is a
+        set of fields (every row, every column and every 2x2 square), its weight is
+        selected by the values of the fields (capped at 15):
+
+            index = v[0] | v[1] << 4 | v[2] << 8 | ...
+
+        The network is trained by self-play with TD(0) on afterstates (the board
+        after a move, before the spawn). All threads update the same weights
+        without locks, a lost update only slows down the training a bit.
+
+        The weights are kept in a memory mapped file, a new run continues with
+        the weights of the last one.
+    */
+
+// number of tuples
+#define TRAIN_NUM_TUPLES (2 * NUM_FIELDW + (NUM_FIELDW - 1) * (NUM_FIELDW - 1))
+// maximum number of fields of a tuple
+#define TRAIN_TUPLE_SIZE (NUM_FIELDW > 4 ? NUM_FIELDW : 4)
+// bits per field in the index
+#define TRAIN_VALUE_BITS 4
+// games between two progress reports
+#define TRAIN_REPORT 1000
+
+#define TRAIN_MAGIC 0x656c7074
+#define TRAIN_VERSION 1
+
+typedef struct train_header_st
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numFieldW;
+    uint32_t numTuples;
+    uint64_t numWeights;
+    uint64_t numGames;
+} train_header_t;
+
+typedef struct train_tuple_st
+{
+    int    size;
+    int    field[TRAIN_TUPLE_SIZE];
+    size_t offset;
+} train_tuple_t;
+
+typedef struct train_st
+{
+    train_tuple_t  tuples[TRAIN_NUM_TUPLES];
+    size_t         numWeights;
+
+    train_header_t *header;
+    _Atomic float  *weights;
+    size_t         mapSize;
+
+    atomic_long    next;
+    atomic_long    numMoves;
+    atomic_long    sumScore;
+    atomic_long    maxTile[NUM_SIGNS + 1];
+} train_t;
+
+/*
+    rows, columns and 2x2 squares
+*/
+void train_initTuples(train_t *train)
+{
+    int num = 0;
+
+    for(int lane = 0; lane < NUM_FIELDW; lane++)
+    {
+        train_tuple_t *row = &train->tuples[num++];
+        train_tuple_t *col = &train->tuples[num++];
+
+        row->size = col->size = NUM_FIELDW;
+
+        for(int pos = 0; pos < NUM_FIELDW; pos++)
+        {
+            row->field[pos] = (lane * NUM_FIELDW) + pos;
+            col->field[pos] = (pos * NUM_FIELDW) + lane;
+        }
+    }
+
+    for(int y = 0; y < NUM_FIELDW - 1; y++)
+    {
+        for(int x = 0; x < NUM_FIELDW - 1; x++)
+        {
+            train_tuple_t *square = &train->tuples[num++];
+            int field = (y * NUM_FIELDW) + x;
+
+            square->size = 4;
+            square->field[0] = field;
+            square->field[1] = field + 1;
+            square->field[2] = field + NUM_FIELDW;
+            square->field[3] = field + NUM_FIELDW + 1;
+        }
+    }
+
+    assert(num == TRAIN_NUM_TUPLES);
+
+    train->numWeights = 0;
+    for(int t = 0; t < TRAIN_NUM_TUPLES; t++)
+    {
+        train->tuples[t].offset = train->numWeights;
+        train->numWeights += (size_t) 1 << (TRAIN_VALUE_BITS * train->tuples[t].size);
+    }
+}
+
+/*
+    map the weights of file ("" = anonymous memory), returns false on error
+*/
+bool train_open(train_t *train, const char *file)
+{
+    memset(train, 0, sizeof(*train));
+    train_initTuples(train);
+
+    train->mapSize = sizeof(train_header_t) + (train->numWeights * sizeof(float));
+
+    if(strlen(file) == 0)
+    {
+        train->header = mmap(NULL, train->mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    else
+    {
+        int fd = open(file, O_RDWR | O_CREAT, 0644);
+        if(fd < 0) return false;
+
+        struct stat st;
+        if(fstat(fd, &st) != 0 || ((size_t) st.st_size != train->mapSize && ftruncate(fd, (off_t) train->mapSize) != 0))
+        {
+            close(fd);
+            return false;
+        }
+
+        train->header = mmap(NULL, train->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+    }
+
+    if(train->header == MAP_FAILED) return false;
+
+    train->weights = (_Atomic float *) (train->header + 1);
+
+    train_header_t *header = train->header;
+    bool valid = header->magic == TRAIN_MAGIC && header->version == TRAIN_VERSION && 
+                 header->numFieldW == NUM_FIELDW && header->numTuples == TRAIN_NUM_TUPLES && 
+                 header->numWeights == train->numWeights;
+
+    if(!valid)
+    {
+        memset(train->header, 0, train->mapSize);
+        header->magic      = TRAIN_MAGIC;
+        header->version    = TRAIN_VERSION;
+        header->numFieldW  = NUM_FIELDW;
+        header->numTuples  = TRAIN_NUM_TUPLES;
+        header->numWeights = train->numWeights;
+    }
+
+    return true;
+}
+
+void train_close(train_t *train)
+{
+    munmap(train->header, train->mapSize);
+}
+
+/*
+    weight index of a tuple
+*/
+static inline size_t train_index(const train_tuple_t *tuple, const uint8_t values[NUM_FIELDS])
+{
+    size_t index = 0;
+
+    for(int i = 0; i < tuple->size; i++)
+    {
+        int value = values[tuple->field[i]];
+        index |= (size_t) (value < 15 ? value : 15) << (TRAIN_VALUE_BITS * i);
+    }
+
+    return tuple->offset + index;
+}
+
+/*
+    value of a board
+*/
+float train_value(const train_t *train, const uint8_t values[NUM_FIELDS])
+{
+    float sum = 0;
+
+    for(int t = 0; t < TRAIN_NUM_TUPLES; t++)
+    {
+        sum += atomic_load_explicit(&train->weights[train_index(&train->tuples[t], values)], memory_order_relaxed);
+    }
+
+    return sum;
+}
+
+/*
+    add delta to all weights of a board
+*/
+void train_update(train_t *train, const uint8_t values[NUM_FIELDS], float delta)
+{
+    for(int t = 0; t < TRAIN_NUM_TUPLES; t++)
+    {
+        _Atomic float *weight = &train->weights[train_index(&train->tuples[t], values)];
+        atomic_store_explicit(weight, atomic_load_explicit(weight, memory_order_relaxed) + delta, memory_order_relaxed);
+    }
+}
+
+/*
+    best move of a board (score + value of the afterstate), 0 if no move is possible
+*/
+int train_bestMove(const train_t *train, const char *field, game_moves_t *moves)
+{
+    int   best = 0;
+    float bestValue = 0;
+
+    game_moveAll(field, moves);
+
+    for(int dir = 1; dir <= NUM_DIRS; dir++)
+    {
+        if(!moves->moved[dir]) continue;
+
+        uint8_t values[NUM_FIELDS];
+        game_fieldToValues(moves->field[dir], values, 1);
+
+        float value = (float) moves->score[dir] + train_value(train, values);
+
+        if(best == 0 || value > bestValue)
+        {
+            best = dir;
+            bestValue = value;
+        }
+    }
+
+    return best;
+}
+
+/*
+    spawn a 2 (90%) or a 4 on a random empty field
+*/
+void train_spawn(char *field, uint32_t *rng)
+{
+    int empty[NUM_FIELDS];
+    int numEmpty = 0;
+
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(field[i] == getSign(0)) empty[numEmpty++] = i;
+    }
+
+    if(numEmpty == 0) return;
+
+    *rng ^= *rng << 13;
+    *rng ^= *rng >> 17;
+    *rng ^= *rng << 5;
+
+    field[empty[*rng % (uint32_t) numEmpty]] = getSign(((*rng >> 16) % 10 == 0) ? 2 : 1);
+}
+
+/*
+    board before a move (field), the move and the reference result
+*/
+typedef void (*train_visit_t)(const char *field, int dir, const game_moves_t *moves, void *context);
+
+/*
+    play one game with the policy, learn from it if learn is set, returns the
+    highest tile (visit may be NULL)
+*/
+int train_game(train_t *train, uint32_t *rng, uint32_t *score, long *numMoves, bool learn, train_visit_t visit, void *context)
+{
+    char field[NUM_FIELDS + 1];
+    game_moves_t moves;
+
+    memset(field, getSign(0), NUM_FIELDS);
+    field[NUM_FIELDS] = '\0';
+    train_spawn(field, rng);
+    train_spawn(field, rng);
+
+    *score = 0;
+    *numMoves = 0;
+
+    int dir = train_bestMove(train, field, &moves);
+
+    while(dir)
+    {
+        if(visit) visit(field, dir, &moves, context);
+
+        uint8_t after[NUM_FIELDS];
+        game_fieldToValues(moves.field[dir], after, 1);
+
+        *score += moves.score[dir];
+        (*numMoves)++;
+
+        memcpy(field, moves.field[dir], NUM_FIELDS);
+        train_spawn(field, rng);
+
+        int next = train_bestMove(train, field, &moves);
+
+        if(learn)
+        {
+            float target = 0;
+
+            if(next)
+            {
+                uint8_t nextAfter[NUM_FIELDS];
+                game_fieldToValues(moves.field[next], nextAfter, 1);
+                target = (float) moves.score[next] + train_value(train, nextAfter);
+            }
+
+            train_update(train, after, TRAIN_ALPHA * (target - train_value(train, after)));
+        }
+
+        dir = next;
+    }
+
+    int maxTile = 0;
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(getSignValue(field[i]) > maxTile) maxTile = getSignValue(field[i]);
+    }
+
+    return maxTile;
+}
+
+void *train_worker(void *arg)
+{
+    train_t *train = arg;
+    uint32_t rng = (uint32_t) time(NULL) ^ (uint32_t) (uintptr_t) &rng;
+    long game;
+
+    if(rng == 0) rng = RNG_SEED;
+
+    while((game = atomic_fetch_add(&train->next, 1)) < TRAIN_GAMES)
+    {
+        uint32_t score;
+        long numMoves;
+        int maxTile = train_game(train, &rng, &score, &numMoves, true, NULL, NULL);
+
+        atomic_fetch_add(&train->numMoves, numMoves);
+        metrics_add(&metrics->iterations, 1);
+        metrics_add(&metrics->moves, (uint64_t) numMoves);
+        atomic_fetch_add(&train->sumScore, (long) score);
+        atomic_fetch_add(&train->maxTile[maxTile], 1);
+
+        if((game + 1) % TRAIN_REPORT == 0)
+        {
+            printf(" [%7ld] score: %8.0f moves: %6.0f\n", game + 1, 
+                (double) train->sumScore / (double) (game + 1), (double) train->numMoves / (double) (game + 1));
+        }
+    }
+
+    return NULL;
+}
+
+/*
+    train the network of TRAIN_FILE with TRAIN_GAMES self-play games
+*/
+void train()
+{
+    TRACE_SCOPE("train");
+
+    printf("\n=== train ===\n\n");
+
+    static train_t train;
+    int numThreads = get_numThreads();
+    pthread_t threads[numThreads];
+
+    if(!train_open(&train, TRAIN_FILE))
+    {
+        printf(" Can not open: %s\n", TRAIN_FILE);
+        return;
+    }
+
+    printf(" Tuples: %d\n", TRAIN_NUM_TUPLES);
+    printf(" Weights: %zu (%.1f MB)\n", train.numWeights, (double) train.mapSize / (1 << 20));
+    printf(" Trained games: %" PRIu64 "\n\n", train.header->numGames);
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    metrics_begin("train");
+
+    for(int i = 0; i < numThreads; i++) pthread_create(&threads[i], NULL, train_worker, &train);
+    for(int i = 0; i < numThreads; i++) pthread_join(threads[i], NULL);
+
+    metrics_end();
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    train.header->numGames += TRAIN_GAMES;
+
+    printf("\n tile    games\n");
+    for(int value = 1; value <= NUM_SIGNS; value++)
+    {
+        if(train.maxTile[value] == 0) continue;
+        printf(" %c %10ld\n", getSign(value), (long) train.maxTile[value]);
+    }
+
+    double time = (double) (end.tv_sec - begin.tv_sec) + ((double) (end.tv_nsec - begin.tv_nsec) * 1e-9);
+
+    printf("\n");
+    printf(" Threads: %d\n", numThreads);
+    printf(" Games: %d\n", TRAIN_GAMES);
+    printf(" Moves/s: %.0f\n", (double) train.numMoves / time);
+    printf(" Time: %.1f s\n", time);
+
+    train_close(&train);
+}
+
+/*
+    Policy driven workload
+
+    The trained weights play PLAY_GAMES games without learning. Every move of
+    the policy is also made with game_move and compared with the reference, so
+    the selected algorithm runs on the boards of deep games (high tiles and
+    overflow) which random play does not reach. The boards of the new highest
+    tiles of a game become move cases of the corpus.
+*/
+
+// cases collected from one game (one per tile and direction)
+#define PLAY_GAME_CASES ((NUM_SIGNS + 1) * NUM_DIRS)
+
+typedef struct play_st
+{
+    train_t          train;
+    atomic_long      next;
+    atomic_long      numMoves;
+    atomic_long      numErrors;
+    atomic_long      sumScore;
+    atomic_long      maxTile[NUM_SIGNS + 1];
+    pthread_mutex_t  lock;
+    corpus_case_t   *cases;
+    size_t           numCases;
+} play_t;
+
+typedef struct play_game_st
+{
+    play_t        *play;
+    int            maxTile;
+    long           numErrors;
+    size_t         numCases;
+    corpus_case_t  cases[PLAY_GAME_CASES];
+} play_game_t;
+
+/*
+    check a move of the policy with game_move, keep the board of a new highest tile
+*/
+void play_visit(const char *field, int dir, const game_moves_t *moves, void *context)
+{
+    play_game_t *game = context;
+
+    game_reset();
+    memcpy(game_field, field, NUM_FIELDS);
+
+    bool moved = game_move(dir);
+
+    if(moved != moves->moved[dir] || memcmp(game_field, moves->field[dir], NUM_FIELDS) != 0) game->numErrors++;
+
+    int maxTile = 0;
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(getSignValue(moves->field[dir][i]) > maxTile) maxTile = getSignValue(moves->field[dir][i]);
+    }
+
+    if(maxTile > game->maxTile && maxTile >= PLAY_MIN_TILE)
+    {
+        for(int d = 1; d <= NUM_DIRS && game->numCases < PLAY_GAME_CASES; d++) corpus_makeMove(&game->cases[game->numCases++], field, d);
+    }
+
+    if(maxTile > game->maxTile) game->maxTile = maxTile;
+}
+
+void *play_worker(void *arg)
+{
+    play_t *play = arg;
+    uint32_t rng = (uint32_t) time(NULL) ^ (uint32_t) (uintptr_t) &rng;
+    static _Thread_local play_game_t game;
+
+    if(rng == 0) rng = RNG_SEED;
+
+    while(atomic_fetch_add(&play->next, 1) < PLAY_GAMES)
+    {
+        uint32_t score;
+        long numMoves;
+
+        memset(&game, 0, offsetof(play_game_t, cases));
+        game.play = play;
+
+        int maxTile = train_game(&play->train, &rng, &score, &numMoves, false, play_visit, &game);
+
+        atomic_fetch_add(&play->numMoves, numMoves);
+        atomic_fetch_add(&play->numErrors, game.numErrors);
+        atomic_fetch_add(&play->sumScore, (long) score);
+        atomic_fetch_add(&play->maxTile[maxTile], 1);
+        metrics_add(&metrics->iterations, 1);
+
+        if(game.numCases == 0) continue;
+
+        pthread_mutex_lock(&play->lock);
+        corpus_case_t *cases = realloc(play->cases, (play->numCases + game.numCases) * sizeof(corpus_case_t));
+        assert(cases);
+        memcpy(cases + play->numCases, game.cases, game.numCases * sizeof(corpus_case_t));
+        play->cases = cases;
+        play->numCases += game.numCases;
+        pthread_mutex_unlock(&play->lock);
+    }
+
+    return NULL;
+}
+
+/*
+    play PLAY_GAMES games with the weights of TRAIN_FILE, returns the number of wrong moves
+*/
+long play()
+{
+    TRACE_SCOPE("play");
+
+    printf("\n=== play ===\n\n");
+
+    static play_t play;
+    int numThreads = get_numThreads();
+    pthread_t threads[numThreads];
+
+    if(!train_open(&play.train, TRAIN_FILE))
+    {
+        printf(" Can not open: %s\n", TRAIN_FILE);
+        return 0;
+    }
+
+    printf(" Trained games: %" PRIu64 "%s\n\n", play.train.header->numGames, play.train.header->numGames ? "" : " (run TRAIN first)");
+
+    atomic_store(&play.next, 0);
+    pthread_mutex_init(&play.lock, NULL);
+
+    metrics_begin("play");
+
+    for(int i = 0; i < numThreads; i++) pthread_create(&threads[i], NULL, play_worker, &play);
+    for(int i = 0; i < numThreads; i++) pthread_join(threads[i], NULL);
+
+    metrics_end();
+
+    printf(" tile    games\n");
+    for(int value = 1; value <= NUM_SIGNS; value++)
+    {
+        if(play.maxTile[value] == 0) continue;
+        printf(" %c %10ld\n", getSign(value), (long) play.maxTile[value]);
+    }
+
+    printf("\n");
+    printf(" Games: %d\n", PLAY_GAMES);
+    printf(" Score: %.0f\n", (double) play.sumScore / PLAY_GAMES);
+    printf(" Moves: %ld\n", (long) play.numMoves);
+    printf(" Errors: %ld\n", (long) play.numErrors);
+    printf(" New cases: %zu\n", play.numCases);
+
+    corpus_append(play.cases, play.numCases);
+
+    long numErrors = play.numErrors;
+
+    free(play.cases);
+    pthread_mutex_destroy(&play.lock);
+    train_close(&play.train);
+
+    return numErrors;
+}
+
+/* === FILTER ==== */
+
+    /*
+        Non-interactive filter mode
+
+            emu -f [-b] [-a algo] [file]
+
+        Every record is a board, a direction and an optional score. The board is
+        loaded into a fresh game, moved with the algorithm (0 ref .. 4, default
+        MOVE_ALGO; ref does not add to the score) and the result is written to
+        stdout. Without a file the records are read from stdin, a file is mapped
+        into memory and the records are parsed in place.
+
+        text    one record per line in the format of test_fields[]
+
+                    {"     1          ", MV_LEFT, 12},
+
+                the direction is MV_UP/MV_DOWN/MV_LEFT/MV_RIGHT or 1..4, the score
+                is a number. Everything else is ignored, so the lines of
+                test_fields[] can be used directly. Lines without a board are
+                skipped. Output is one tab separated line per record:
+
+                    moved  "field"  score  iterations  steps
+
+        binary  (-b) filter_record_t in, filter_result_t out, host byte order,
+                cells are values (0 empty, 1 = 2, 2 = 4, ...)
+    */
+
+typedef struct filter_record_st
+{
+    uint32_t score;
+    uint8_t  dir;
+    uint8_t  cells[NUM_FIELDS];
+} filter_record_t;
+
+typedef struct filter_result_st
+{
+    uint32_t score;
+    uint32_t numIterations;
+    uint32_t numSteps;
+    uint8_t  moved;
+    uint8_t  cells[NUM_FIELDS];
+} filter_result_t;
+
+// records read at once from stdin in binary mode
+#define FILTER_CHUNK 4096
+
+/*
+    move the board of the current game, the board and score are already loaded
+*/
+static bool filter_move(int dir, int algo)
+{
+    game_numIterations = 0;
+    game_numSteps = 0;
+
+    if(algo < 0) return game_move(dir);
+
+    return emu_move(dir, algo);
+}
+
+static void filter_setScore(uint32_t score)
+{
+    snprintf(game_score, NUM_SCORE + 1, "%*" PRIu32, NUM_SCORE, score % SCORE_MODULO);
+}
+
+/*
+    value of the score, blank digits are 0 (addScore1 leaves zeros blank)
+*/
+static uint32_t filter_getScore()
+{
+    uint32_t score = 0;
+
+    game_scoreRefresh();
+
+    for(int i = 0; i < NUM_SCORE; i++)
+    {
+        score = score * 10 + (isdigit((unsigned char) game_score[i]) ? (uint32_t) (game_score[i] - '0') : 0);
+    }
+
+    return score;
+}
+
+/*
+    parse one text record from [p, end), returns false if there is no board,
+    *error is set if the record is invalid
+*/
+static bool filter_parseText(const char *p, const char *end, char field[NUM_FIELDS + 1], int *dir, uint32_t *score, bool *error)
+{
+    *error = false;
+
+    while(p < end && *p != '"') p++;
+    if(p == end) return false;
+    p++;
+
+    const char *begin = p;
+    while(p < end && *p != '"') p++;
+
+    if(p == end || p - begin != NUM_FIELDS)
+    {
+        *error = true;
+        return true;
+    }
+
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(getSign(getSignValue(begin[i])) != begin[i]) *error = true;
+        field[i] = begin[i];
+    }
+    field[NUM_FIELDS] = '\0';
+    p++;
+
+    while(p < end && (*p == ',' || isspace((unsigned char) *p))) p++;
+
+    static const char *names[] = { "", "MV_UP", "MV_DOWN", "MV_LEFT", "MV_RIGHT" };
+    *dir = 0;
+
+    if(p < end && *p >= '1' && *p <= '4')
+    {
+        *dir = *p++ - '0';
+    }
+    else
+    {
+        for(int d = NUM_DIRS; d >= 1; d--)
+        {
+            size_t len = strlen(names[d]);
+            if((size_t) (end - p) >= len && memcmp(p, names[d], len) == 0)
+            {
+                *dir = d;
+                p += len;
+                break;
+            }
+        }
+    }
+
+    if(*dir == 0) *error = true;
+
+    while(p < end && (*p == ',' || isspace((unsigned char) *p))) p++;
+
+    *score = 0;
+    while(p < end && isdigit((unsigned char) *p)) *score = *score * 10 + (uint32_t) (*p++ - '0');
+
+    return true;
+}
+
+/*
+    run one text record and print the result to out, returns false if it is invalid
+*/
+static bool filter_text(const char *line, const char *end, int algo, size_t numLine, FILE *out)
+{
+    char field[NUM_FIELDS + 1];
+    int dir;
+    uint32_t score;
+    bool error;
+
+    if(!filter_parseText(line, end, field, &dir, &score, &error)) return true;
+
+    if(error)
+    {
+        fprintf(stderr, "filter: invalid record in line %zu\n", numLine);
+        return false;
+    }
+
+    game_reset();
+    emu_load(field, NULL);
+    filter_setScore(score);
+
+    bool moved = filter_move(dir, algo);
+
+    fprintf(out, "%d\t\"%s\"\t%" PRIu32 "\t%d\t%d\n", moved, game_field, filter_getScore(), game_numIterations, game_numSteps);
+
+    return true;
+}
+
+/*
+    run one binary record, returns false if it is invalid
+*/
+static bool filter_binary(const filter_record_t *record, filter_result_t *result, int algo)
+{
+    if(record->dir < 1 || record->dir > NUM_DIRS) return false;
+
+    game_reset();
+
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(record->cells[i] >= NUM_SIGNS) return false;
+        game_field[i] = getSign(record->cells[i]);
+    }
+
+    filter_setScore(record->score);
+
+    memset(result, 0, sizeof(*result));
+    result->moved         = filter_move(record->dir, algo);
+    result->score         = filter_getScore();
+    result->numIterations = (uint32_t) game_numIterations;
+    result->numSteps      = (uint32_t) game_numSteps;
+
+    for(int i = 0; i < NUM_FIELDS; i++) result->cells[i] = (uint8_t) getSignValue(game_field[i]);
+
+    return true;
+}
+
+static int filter_usage()
+{
+    fprintf(stderr, "usage: emu -f [-b] [-a algo] [file]\n");
+    fprintf(stderr, "  -f       filter mode, records from file or stdin\n");
+    fprintf(stderr, "  -b       binary records (%zu bytes in, %zu bytes out)\n", sizeof(filter_record_t), sizeof(filter_result_t));
+    fprintf(stderr, "  -a algo  move algorithm 0 (ref) .. 4, default %d\n", MOVE_ALGO);
+
+    return EXIT_FAILURE;
+}
+
+/*
+    filter mode with the records of the file argument or in, results to out,
+    returns the exit code
+*/
+int filter_run(int argc, char **argv, FILE *in, FILE *out)
+{
+    bool isFilter = false, isBinary = false;
+    int algo = -1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "fba:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'f': isFilter = true; break;
+        case 'b': isBinary = true; break;
+        case 'a':
+            algo = atoi(optarg);
+            if(algo < 0 || algo > 4) return filter_usage();
+            break;
+        default:
+            return filter_usage();
+        }
+    }
+
+    if(!isFilter || optind < argc - 1) return filter_usage();
+
+    const char *data = NULL;
+    size_t size = 0;
+
+    if(optind < argc)
+    {
+        int fd = open(argv[optind], O_RDONLY);
+        struct stat st;
+
+        if(fd < 0)
+        {
+            perror(argv[optind]);
+            return EXIT_FAILURE;
+        }
+
+        if(fstat(fd, &st) != 0)
+        {
+            perror(argv[optind]);
+            close(fd);
+            return EXIT_FAILURE;
+        }
+
+        size = (size_t) st.st_size;
+        if(size > 0)
+        {
+            data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data == MAP_FAILED)
+            {
+                perror("mmap");
+                close(fd);
+                return EXIT_FAILURE;
+            }
+            madvise((void *) data, size, MADV_SEQUENTIAL);
+        }
+        close(fd);
+    }
+
+    bool ok = true;
+
+    if(isBinary)
+    {
+        filter_result_t result;
+
+        if(optind < argc)
+        {
+            if(size % sizeof(filter_record_t) != 0) fprintf(stderr, "filter: ignoring %zu trailing bytes\n", size % sizeof(filter_record_t));
+
+            const filter_record_t *records = (const filter_record_t *) data;
+
+            for(size_t i = 0; ok && i < size / sizeof(filter_record_t); i++)
+            {
+                ok = filter_binary(&records[i], &result, algo);
+                if(ok) fwrite(&result, sizeof(result), 1, out);
+                else   fprintf(stderr, "filter: invalid record %zu\n", i);
+            }
+        }
+        else
+        {
+            static filter_record_t records[FILTER_CHUNK];
+            size_t num, base = 0;
+
+            while(ok && (num = fread(records, sizeof(filter_record_t), FILTER_CHUNK, in)) > 0)
+            {
+                for(size_t i = 0; ok && i < num; i++)
+                {
+                    ok = filter_binary(&records[i], &result, algo);
+                    if(ok) fwrite(&result, sizeof(result), 1, out);
+                    else   fprintf(stderr, "filter: invalid record %zu\n", base + i);
+                }
+                base += num;
+            }
+        }
+    }
+    else
+    {
+        size_t numLine = 0;
+
+        if(optind < argc)
+        {
+            const char *p = data, *end = data + size;
+
+            while(ok && p < end)
+            {
+                const char *eol = memchr(p, '\n', (size_t) (end - p));
+                if(!eol) eol = end;
+
+                ok = filter_text(p, eol, algo, ++numLine, out);
+                p = eol + 1;
+            }
+        }
+        else
+        {
+            char *line = NULL;
+            size_t capacity = 0;
+            ssize_t len;
+
+            while(ok && (len = getline(&line, &capacity, in)) >= 0)
+            {
+                ok = filter_text(line, line + len, algo, ++numLine, out);
+            }
+
+            free(line);
+        }
+    }
+
+    if(data) munmap((void *) data, size);
+
+    fflush(out);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+    filter mode on stdin and stdout, returns the exit code
+*/
+int filter(int argc, char **argv)
+{
+    static char outBuffer[1 << 20];
+    setvbuf(stdout, outBuffer, _IOFBF, sizeof(outBuffer));
+
+    return filter_run(argc, argv, stdin, stdout);
+}
+
+/* === RUNNER ==== */
+
+    /*
+        Work-stealing test runner
+
+        The cases [0, num) are split into one range per worker. A range is packed
+        into one 64 bit word (begin << 32 | end), the owner takes cases from the
+        front and an idle worker steals the upper half of the largest range, both
+        with compare and swap, so no case is run twice and no lock is taken.
+
+        Every case runs in a fresh game of the worker (all game state is thread
+        local). A failed case is queued for a side thread which runs it again
+        with debug = true, so its verbose output is not mixed with other cases.
+        The iterations and steps of all cases are summed up.
+    */
+
+typedef struct runner_counts_st
+{
+    long numIterations;
+    long numSteps;
+} runner_counts_t;
+
+/*
+    runs case index, returns true if it passed (debug is set for the verbose run)
+*/
+typedef bool (*runner_case_t)(size_t index, void *context, runner_counts_t *counts);
+
+typedef struct runner_result_st
+{
+    size_t numCases;
+    size_t numFailed;
+    long   numIterations;
+    long   numSteps;
+} runner_result_t;
+
+// maximum number of workers
+#define RUNNER_MAX_THREADS 64
+
+typedef struct runner_st
+{
+    runner_case_t       run;
+    void               *context;
+    int                 numThreads;
+    _Atomic uint64_t    ranges[RUNNER_MAX_THREADS];
+    _Atomic long        numIterations;
+    _Atomic long        numSteps;
+    _Atomic size_t      numFailed;
+
+    // failed cases for the side thread
+    pthread_mutex_t     mutex;
+    pthread_cond_t      cond;
+    size_t             *failed;
+    size_t              numQueued;
+    size_t              numVerbose;
+    bool                done;
+} runner_t;
+
+typedef struct runner_worker_st
+{
+    runner_t *runner;
+    int       id;
+} runner_worker_t;
+
+static inline uint64_t runner_pack(uint32_t begin, uint32_t end)
+{
+    return ((uint64_t) begin << 32) | end;
+}
+
+/*
+    take the next case of the own range
+*/
+static bool runner_pop(runner_t *r, int id, size_t *index)
+{
+    uint64_t range = atomic_load(&r->ranges[id]);
+
+    while(true)
+    {
+        uint32_t begin = (uint32_t) (range >> 32), end = (uint32_t) range;
+        if(begin >= end) return false;
+
+        if(atomic_compare_exchange_weak(&r->ranges[id], &range, runner_pack(begin + 1, end)))
+        {
+            *index = begin;
+            return true;
+        }
+    }
+}
+
+/*
+    move the upper half of the largest other range into the own (empty) range
+*/
+static bool runner_steal(runner_t *r, int id)
+{
+    while(true)
+    {
+        int victim = -1;
+        uint64_t range = 0;
+        uint32_t size = 0;
+
+        for(int i = 0; i < r->numThreads; i++)
+        {
+            uint64_t other = atomic_load(&r->ranges[i]);
+            uint32_t begin = (uint32_t) (other >> 32), end = (uint32_t) other;
+
+            if(i != id && end > begin && end - begin > size)
+            {
+                victim = i;
+                range = other;
+                size = end - begin;
+            }
+        }
+
+        if(victim < 0) return false;
+
+        uint32_t begin = (uint32_t) (range >> 32), end = (uint32_t) range;
+        uint32_t mid = begin + size / 2;
+
+        if(atomic_compare_exchange_strong(&r->ranges[victim], &range, runner_pack(begin, mid)))
+        {
+            atomic_store(&r->ranges[id], runner_pack(mid, end));
+            return true;
+        }
+    }
+}
+
+static bool runner_runCase(runner_t *r, size_t index, bool verbose, runner_counts_t *counts)
+{
+    game_reset();
+    debug = verbose;
+
+    bool ok = r->run(index, r->context, counts);
+
+    debug = false;
+
+    return ok;
+}
+
+void *runner_worker(void *arg)
+{
+    runner_worker_t *w = arg;
+    runner_t *r = w->runner;
+    runner_counts_t counts = { 0, 0 };
+    size_t index;
+
+    do
+    {
+        while(runner_pop(r, w->id, &index))
+        {
+            if(runner_runCase(r, index, false, &counts)) continue;
+
+            atomic_fetch_add(&r->numFailed, 1);
+
+            pthread_mutex_lock(&r->mutex);
+            r->failed[r->numQueued++] = index;
+            pthread_cond_signal(&r->cond);
+            pthread_mutex_unlock(&r->mutex);
+        }
+    } while(runner_steal(r, w->id));
+
+    atomic_fetch_add(&r->numIterations, counts.numIterations);
+    atomic_fetch_add(&r->numSteps, counts.numSteps);
+
+    return NULL;
+}
+
+/*
+    side thread, runs the failed cases again in verbose mode
+*/
+void *runner_verbose(void *arg)
+{
+    runner_t *r = arg;
+    runner_counts_t counts = { 0, 0 };
+
+    pthread_mutex_lock(&r->mutex);
+
+    while(true)
+    {
+        while(r->numVerbose == r->numQueued && !r->done) pthread_cond_wait(&r->cond, &r->mutex);
+        if(r->numVerbose == r->numQueued) break;
+
+        size_t index = r->failed[r->numVerbose++];
+
+        pthread_mutex_unlock(&r->mutex);
+
+        printf("\n=== case %zu ===\n", index);
+        runner_runCase(r, index, true, &counts);
+        fflush(stdout);
+
+        pthread_mutex_lock(&r->mutex);
+    }
+
+    pthread_mutex_unlock(&r->mutex);
+
+    return NULL;
+}
+
+/*
+    run all cases on numThreads workers, returns the number of failed cases and the totals
+*/
+runner_result_t runner_runWith(runner_case_t run, void *context, size_t numCases, int numThreads)
+{
+    runner_t r = { .run = run, .context = context };
+
+    assert(numCases <= UINT32_MAX);
+
+    if(numThreads > RUNNER_MAX_THREADS) numThreads = RUNNER_MAX_THREADS;
+    if((size_t) numThreads > numCases) numThreads = numCases > 0 ? (int) numCases : 1;
+
+    r.numThreads = numThreads;
+    r.failed = malloc((numCases > 0 ? numCases : 1) * sizeof(size_t));
+    assert(r.failed);
+    pthread_mutex_init(&r.mutex, NULL);
+    pthread_cond_init(&r.cond, NULL);
+
+    for(int i = 0; i < numThreads; i++)
+    {
+        atomic_init(&r.ranges[i], runner_pack((uint32_t) (numCases * i / numThreads), (uint32_t) (numCases * (i + 1) / numThreads)));
+    }
+
+    pthread_t threads[numThreads], side;
+    runner_worker_t workers[numThreads];
+
+    fflush(stdout);
+    pthread_create(&side, NULL, runner_verbose, &r);
+
+    for(int i = 0; i < numThreads; i++)
+    {
+        workers[i] = (runner_worker_t) { &r, i };
+        pthread_create(&threads[i], NULL, runner_worker, &workers[i]);
+    }
+
+    for(int i = 0; i < numThreads; i++) pthread_join(threads[i], NULL);
+
+    pthread_mutex_lock(&r.mutex);
+    r.done = true;
+    pthread_cond_signal(&r.cond);
+    pthread_mutex_unlock(&r.mutex);
+
+    pthread_join(side, NULL);
+
+    pthread_mutex_destroy(&r.mutex);
+    pthread_cond_destroy(&r.cond);
+    free(r.failed);
+
+    return (runner_result_t) { numCases, r.numFailed, r.numIterations, r.numSteps };
+}
+
+/*
+    run all cases on one worker per core
+*/
+runner_result_t runner_run(runner_case_t run, void *context, size_t numCases)
+{
+    return runner_runWith(run, context, numCases, get_numThreads());
+}
+
+/* === DEBUG FUNCTIONS ==== */
+
+void debug_spawn_tetrisrng()
+{
+    printf("\n=== debug_spawn_tetrisrng ===\n\n");
+
+    for(int i = 0; i < 16; i++)
+    {
+        printf(" ");
+        printBits(sizeof(uint16_t), &game_rng_value); printf(" %04x\n", game_rng_value);
+        spawn_tetrisrng();
+    }
+
+    rng_analysis_t analysis = rng_analyze();
+
+    printf("\n");
+    printf(" Seed: %04x\n", RNG_SEED);
+    printf(" Cycle length: %d\n", analysis.cycleLength);
+    printf(" Tail length: %d\n", analysis.tailLength);
+    printf(" Cycles: %d\n", analysis.numCycles);
+    printf(" States not on a cycle: %d\n", analysis.numNotOnCycle);
+    printf(" States without predecessor: %d\n", analysis.numNoPredecessor);
+}
+
+void debug_display()
+{
+    printf("\n=== debug_display ===\n\n");
+
+    display_frame_t frame, last;
+    uint64_t chain[(DISPLAY_NUM_BITS + 63) / 64];
+
+    display_encodeText(&last, "PEPPERGRAY");
+
+    long changedTotal = 0;
+    int numTests = (int) corpus_numMoves();
+
+    for(int i = 0; i < numTests; i++)
+    {
+        memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+        display_encode(&frame, game_scoreDecSep);
+        changedTotal += display_diffBits(&last, &frame);
+        last = frame;
+    }
+
+    display_pack(&frame, chain);
+
+    printf(" chain: ");
+    for(int i = (DISPLAY_NUM_BITS + 63) / 64 - 1; i >= 0; i--) printf("%016" PRIx64, chain[i]);
+    printf("\n");
+
+    double maxRefresh = (double) DISPLAY_CLOCK_HZ / DISPLAY_FRAME_CYCLES;
+    double load       = (double) DISPLAY_FRAME_CYCLES * DISPLAY_REFRESH_HZ / DISPLAY_CLOCK_HZ;
+
+    printf("\n");
+    printf(" Bits/frame: %d\n", DISPLAY_NUM_BITS);
+    printf(" Cycles/frame: %d\n", DISPLAY_FRAME_CYCLES);
+    printf(" Changed bits/frame: %.1f\n", (double) changedTotal / numTests);
+    printf(" Max refresh: %.0f Hz @ %d Hz\n", maxRefresh, DISPLAY_CLOCK_HZ);
+    printf(" Load @ %d Hz: %.3f %%\n", DISPLAY_REFRESH_HZ, load * 100.0);
+}
+
+void debug_schedule()
+{
+    printf("\n=== debug_schedule ===\n\n");
+
+    long rates[] = { 0, 60, 1000, 5000, 10000, 20000, 30000 };
+    int numRates = sizeof(rates) / sizeof(rates[0]);
+    int numTests = (int) corpus_numMoves();
+    double baseLatency = 0;
+
+    printf("  refresh   latency      max   latency  frame delay  display\n");
+    printf("     (Hz)  (cycles) (cycles)      (us)     max (cy)     load\n");
+
+    for(int r = 0; r < numRates; r++)
+    {
+        long period = rates[r] ? DISPLAY_CLOCK_HZ / rates[r] : 0;
+
+        if(rates[r] && period <= DISPLAY_FRAME_CYCLES) continue;
+
+        schedule_t schedule;
+        schedule_init(&schedule, period);
+
+        long sumLatency = 0, maxLatency = 0;
+
+        for(int i = 0; i < numTests; i++)
+        {
+            bool moved;
+            memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+            game_fieldIndex = 0;
+
+            long latency = schedule_move(&schedule, corpus_move(i)->dir, &moved);
+
+            sumLatency += latency;
+            if(latency > maxLatency) maxLatency = latency;
+        }
+
+        double latency = (double) sumLatency / numTests;
+        if(rates[r] == 0) baseLatency = latency;
+
+        printf(" %8ld %9.1f %8ld %9.1f %12ld %7.1f %%", rates[r], latency, maxLatency, 
+            latency * 1e6 / DISPLAY_CLOCK_HZ, schedule.maxDelay, 
+            schedule.time ? 100.0 * (double) (schedule.numFrames * DISPLAY_FRAME_CYCLES) / (double) schedule.time : 0.0);
+        if(rates[r]) printf("  (+%.0f %%)", 100.0 * (latency - baseLatency) / baseLatency);
+        printf("\n");
+    }
+}
+
+typedef void (*batch_kernel_t)(int dir, size_t num, size_t stride, uint8_t *cells, bool *moved, uint32_t *score);
+
+typedef struct batch_kernel_info_st
+{
+    const char *name;
+    batch_kernel_t kernel;
+    bool supported;
+} batch_kernel_info_t;
+
+/*
+    list of the batch kernels and if the CPU supports them
+*/
+int batch_kernels(batch_kernel_info_t kernels[3])
+{
+    int num = 0;
+
+    kernels[num++] = (batch_kernel_info_t) { "scalar", game_moveBatch_scalar, true };
+#if BATCH_SIMD && defined(__x86_64__)
+    kernels[num++] = (batch_kernel_info_t) { "sse4",   game_moveBatch_sse4,   __builtin_cpu_supports("sse4.1") };
+    kernels[num++] = (batch_kernel_info_t) { "avx2",   game_moveBatch_avx2,   __builtin_cpu_supports("avx2") };
+#endif
+
+    return num;
+}
+
+/*
+    fill a batch with random boards, small values are preferred to get merges
+*/
+void batch_fillRandom(uint8_t *cells, size_t num, size_t stride, uint32_t *rng)
+{
+    for(size_t board = 0; board < num; board++)
+    {
+        for(int i = 0; i < NUM_FIELDS; i++)
+        {
+            *rng ^= *rng << 13;
+            *rng ^= *rng >> 17;
+            *rng ^= *rng << 5;
+
+            cells[(i * stride) + board] = (uint8_t) ((board & 1) ? (*rng % NUM_SIGNS) : (*rng % 4));
+        }
+    }
+}
+
+void debug_batch()
+{
+    printf("\n=== debug_batch ===\n\n");
+
+    enum { NUM = 1 << 16 };
+
+    uint8_t  *cells = malloc(NUM_FIELDS * NUM);
+    bool     *moved = malloc(NUM * sizeof(bool));
+    uint32_t *score = malloc(NUM * sizeof(uint32_t));
+    uint32_t rng    = 1;
+
+    batch_kernel_info_t kernels[3];
+    int numKernels = batch_kernels(kernels);
+
+    for(int k = 0; k < numKernels; k++)
+    {
+        if(!kernels[k].supported) continue;
+
+        batch_fillRandom(cells, NUM, NUM, &rng);
+
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+
+        for(int dir = 1; dir <= NUM_DIRS; dir++)
+        {
+            kernels[k].kernel(dir, NUM, NUM, cells, moved, score);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double seconds = (double) (end.tv_sec - begin.tv_sec) + ((double) (end.tv_nsec - begin.tv_nsec) * 1e-9);
+        printf(" %-6s %8.2f Mmoves/s\n", kernels[k].name, (NUM * NUM_DIRS) / seconds * 1e-6);
+    }
+
+    free(cells);
+    free(moved);
+    free(score);
+}
+
+void debug_score()
+{
+    printf("\n=== debug_score ===\n\n");
+
+    int numTests = (int) corpus_numMoves();
+    int counterBits = 32 - __builtin_clz(SCORE_BINARY_BITS);
+    int version = game_scoreVersion;
+
+    // v1: digits, carry, blank flags, digit counter / v2: score, wrap flag, bcd, counter
+    int bits[] = { 0, (NUM_SCORE * 4) + 1 + NUM_SCORE + 3, SCORE_BINARY_BITS + 1 + (NUM_SCORE * 4) + counterBits };
+
+    printf(" datapath  register bits  add cycles  conversion cycles  score cycles  wraps\n");
+
+    for(int v = 1; v <= 2; v++)
+    {
+        long addCycles = 0, convertCycles = 0;
+        int  numWraps = 0;
+
+        game_scoreVersion = v;
+
+        for(int i = 0; i < numTests; i++)
+        {
+            game_reset();
+            memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+            game_scoreAddCycles = 0;
+            game_scoreConvertCycles = 0;
+
+            // the display shows the score after the move
+            game_move4(corpus_move(i)->dir);
+            game_scoreRefresh();
+
+            addCycles     += game_scoreAddCycles;
+            convertCycles += game_scoreConvertCycles;
+            numWraps      += game_scoreWrapped;
+        }
+
+        printf(" v%d        %13d  %10ld  %17ld  %12ld  %5d\n", v, bits[v], addCycles, convertCycles, addCycles + convertCycles, numWraps);
+    }
+
+    game_scoreVersion = version;
+    game_reset();
+
+    printf("\n");
+    printf(" Moves: %d\n", numTests);
+    printf(" Merge latency v1: %d cycles, v2: %d cycles (+ %d per move for the display)\n", NUM_SCORE, SCORE_ADD_CYCLES, SCORE_CONVERT_CYCLES);
+}
+
+void debug_moveK()
+{
+    printf("\n=== debug_moveK ===\n\n");
+
+    int numTests = (int) corpus_numMoves();
+
+    // v4 for comparison (0) and the two useful sizes of vK
+    static const int engines[] = { 0, MOVEK_MIN_BUFFERS, MOVEK_MAX_BUFFERS };
+
+    printf(" engine  buffers  register bits    steps   shifts  accesses     cycles  cycles/move\n");
+
+    for(size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+    {
+        int k = engines[e];
+        long steps = 0, shifts = 0, accesses = 0, cycles = 0;
+
+        for(int i = 0; i < numTests; i++)
+        {
+            memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+            memory_reset();
+            game_numIterations = 0;
+            game_numAccesses = 0;
+            game_numSteps = 0;
+
+            if(k == 0) game_move4(corpus_move(i)->dir);
+            else       game_moveK(corpus_move(i)->dir, k);
+
+            steps    += game_numSteps;
+            shifts   += game_numIterations;
+            accesses += game_numAccesses;
+            cycles   += memory_cycles() + game_numSteps;
+        }
+
+        // v4: buff, data, lane, posBase, posView and start
+        int posBits = 32 - __builtin_clz(NUM_FIELDW - 1);
+
+        if(k == 0) printf(" v4      %7d  %13d", 2, (2 * MEM_DATA_WIDTH) + (3 * posBits) + 1);
+        else       printf(" vK      %7d  %13d", k, game_moveK_registerBits(k));
+
+        printf(" %8ld %8ld %9ld %10ld %12.1f\n", steps, shifts, accesses, cycles, (double) cycles / numTests);
+    }
+}
+
+void debug_memory()
+{
+    printf("\n=== debug_memory ===\n\n");
+
+    typedef bool (*move_t)(move_direction_t dir);
+
+    move_t moves[] = { NULL, game_move1, game_move2, game_move3, game_move4 };
+    int numAlgos = sizeof(moves) / sizeof(moves[0]);
+    int numTests = (int) corpus_numMoves();
+
+    const memory_model_t *model = memory_model;
+    long baseCycles = 0;
+
+    printf(" model    buffers algo   shifts  accesses     cycles  cycles/move\n");
+
+    for(int m = 0; m < NUM_MEMORY_MODELS; m++)
+    {
+        memory_model = &memory_models[m];
+
+        for(int algo = 1; algo < numAlgos; algo++)
+        {
+            long shifts = 0, accesses = 0, cycles = 0;
+
+            for(int i = 0; i < numTests; i++)
+            {
+                memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+                memory_reset();
+                game_numIterations = 0;
+                game_numAccesses = 0;
+
+                moves[algo](corpus_move(i)->dir);
+
+                shifts   += game_numIterations;
+                accesses += game_numAccesses;
+                cycles   += memory_cycles();
+            }
+
+            if(m == 0 && algo == 4) baseCycles = cycles;
+
+            printf(" %-8s %7d   v%d %8ld %9ld %10ld %12.1f\n", memory_models[m].name, memory_models[m].numBuffers, 
+                algo, shifts, accesses, cycles, (double) cycles / numTests);
+        }
+    }
+
+    memory_model = model;
+
+    printf("\n cycles relative to ring v4 (%ld):\n", baseCycles);
+    for(int m = 0; m < NUM_MEMORY_MODELS; m++)
+    {
+        memory_model = &memory_models[m];
+        long cycles = 0;
+
+        for(int i = 0; i < numTests; i++)
+        {
+            memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+            memory_reset();
+            game_numIterations = 0;
+            game_numAccesses = 0;
+
+            game_move4(corpus_move(i)->dir);
+            cycles += memory_cycles();
+        }
+
+        printf(" %-8s %6.1f %%\n", memory_models[m].name, 100.0 * (double) cycles / (double) baseCycles);
+    }
+
+    memory_model = model;
+}
+
+void debug_toggles()
+{
+    printf("\n=== debug_toggles ===\n");
+
+    typedef bool (*move_t)(move_direction_t dir);
+
+    move_t moves[] = { NULL, game_move1, game_move2, game_move3, game_move4 };
+    int numAlgos = sizeof(moves) / sizeof(moves[0]);
+
+    static toggle_count_t total[5][NUM_DIRS + 1];
+    static long histogram[5][TOGGLE_HIST_BUCKETS];
+    long iterations[5] = {0};
+    int numMoves[5][NUM_DIRS + 1] = {{0}};
+
+    int numTests = (int) corpus_numMoves();
+
+    for(int algo = 1; algo < numAlgos; algo++)
+    {
+        for(int i = 0; i < numTests; i++)
+        {
+            int dir = corpus_move(i)->dir;
+
+            memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+            memory_reset();
+            game_numIterations = 0;
+            toggle_count_t before = game_numToggles;
+
+            moves[algo](dir);
+
+            long memory  = game_numToggles.memory  - before.memory;
+            long buffer  = game_numToggles.buffer  - before.buffer;
+            long counter = game_numToggles.counter - before.counter;
+            long sum     = memory + buffer + counter;
+            int bucket   = (int) (sum / TOGGLE_HIST_WIDTH);
+
+            total[algo][dir].memory  += memory;
+            total[algo][dir].buffer  += buffer;
+            total[algo][dir].counter += counter;
+            numMoves[algo][dir]++;
+            iterations[algo] += game_numIterations;
+            histogram[algo][bucket < TOGGLE_HIST_BUCKETS ? bucket : TOGGLE_HIST_BUCKETS - 1]++;
+        }
+    }
+
+    printf("\n toggles/move       memory  buffer counter\n");
+    for(int algo = 1; algo < numAlgos; algo++)
+    {
+        for(int dir = 1; dir <= NUM_DIRS; dir++)
+        {
+            int n = numMoves[algo][dir] ? numMoves[algo][dir] : 1;
+            printf(" v%d %s         %8.1f %7.1f %7.1f\n", algo, game_moveLabels[dir],
+                (double) total[algo][dir].memory / n, (double) total[algo][dir].buffer / n, (double) total[algo][dir].counter / n);
+        }
+    }
+
+    printf("\n histogram (toggles/move, bucket %d)\n", TOGGLE_HIST_WIDTH);
+    for(int algo = 1; algo < numAlgos; algo++)
+    {
+        printf(" v%d ", algo);
+        for(int b = 0; b < TOGGLE_HIST_BUCKETS; b++) printf("%4ld", histogram[algo][b]);
+        printf("\n");
+    }
+
+    printf("\n algo  iterations  toggles/move\n");
+    for(int algo = 1; algo < numAlgos; algo++)
+    {
+        long sum = 0;
+        for(int dir = 1; dir <= NUM_DIRS; dir++) sum += total[algo][dir].memory + total[algo][dir].buffer + total[algo][dir].counter;
+
+        printf(" v%d %13ld %13.1f\n", algo, iterations[algo], (double) sum / numTests);
+    }
+}
+
+void debug_computeIndex()
+{
+    printf("\n=== debug_computeIndex ===\n");
+
+    for(int dir = 1; dir <= 4; dir++)
+    {
+        printf("\n direction: %s (%d)\n", game_moveLabels[dir], dir);
+
+        for(int lane = 0; lane < NUM_FIELDW; lane++)
+        {
+            for(int pos = 0; pos < NUM_FIELDW; pos++)
+            {
+                printf(" %d.%d (%2d)  ", lane, pos, computeIndex(lane, pos, dir));
+            } 
+            printf("\n");
+        }
+    }
+}
+
+typedef struct debug_move_st
+{
+    int *numSteps;
+    int *numIterations;
+    int (*variant)[NUM_FIELDS];
+} debug_move_t;
+
+static bool debug_moveCase(size_t i, void *context, runner_counts_t *counts)
+{
+    debug_move_t *d = context;
+    char result[NUM_FIELDS + 1] = {0};
+
+    memcpy(game_field, corpus_move(i)->test, NUM_FIELDS); 
+    
+    if(debug) printf("\n");
+    if(debug) printf("[%zu] setup (%s) '%s'\n", i, game_moveLabels[corpus_move(i)->dir], game_field);
+    if(debug) print_game();
+
+    int moved1 = game_move_ref(corpus_move(i)->dir);
+    memcpy(result, game_field, NUM_FIELDS);
+    memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+
+    if(debug) printf("[%zu] mov Ref : %d, '%s'\n", i, moved1, result);
+    if(debug) print_game();
+
+    game_fieldIndex = 0;
+    game_numIterations = 0;
+    game_numSteps = 0;
+    int moved2 = game_move(corpus_move(i)->dir);
+    counts->numIterations += game_numIterations;
+    counts->numSteps += game_numSteps;
+
+    d->numSteps[i] = game_numSteps;
+    d->numIterations[i] = game_numIterations;
+    memcpy(d->variant[i], moveRefLastValues, sizeof(d->variant[i]));
+
+    if(debug) printf("[%zu] test      %s  '%s'\n", i, game_moveLabels[corpus_move(i)->dir], game_field);
+    if(debug) print_game();
+
+    bool testMoved = (moved1 == moved2);
+    bool testField = (strncmp(result, game_field, NUM_FIELDS) == 0);
+
+    if(debug) printf("[%zu] test    : %s  '%s'\n", i, game_moveLabels[corpus_move(i)->dir], game_field);
+    if(debug) printf("[%zu] mov Ref : %d, '%s'\n", i, moved1, result);
+    if(debug) printf("[%zu] mov Test: %d, '%s'\n", i, moved2, game_field);
+    if(debug) printf("\n");
+
+    return testMoved && testField;
+}
+
+void debug_move()
+{
+
+    printf("\n=== debug_move ===\n");
+
+    int numTests = (int) corpus_numMoves();
+
+    debug_move_t d = {
+        .numSteps      = calloc(numTests, sizeof(int)),
+        .numIterations = calloc(numTests, sizeof(int)),
+        .variant       = calloc(numTests, sizeof(int[NUM_FIELDS])),
+    };
+    assert(d.numSteps && d.numIterations && d.variant);
+    runner_result_t run = runner_run(debug_moveCase, &d, numTests);
+
+    printf("\n [ #] ✥ field             variant             St Itr\n");
+
+    for(int i = 0; i < numTests; i++)
+    {
+        printf(" [%2d] %s '%s'(", i, game_moveLabels[corpus_move(i)->dir],  corpus_move(i)->test);
+        for(int j = 0; j < NUM_FIELDS; j++) printf("%x", d.variant[i][j]);
+        printf("): %2d %3d\n", d.numSteps[i], d.numIterations[i]);
+    }
+
+    free(d.numSteps);
+    free(d.numIterations);
+    free(d.variant);
+
+    assert(run.numFailed == 0);
+
+    int interationsTotal = (int) run.numIterations;
+    int stepsTotal = (int) run.numSteps;
+
+    int numVariants = validate_move_tests(&testVariants)->num;
+
+    printf("\n");
+    printf(" NumTests: %d\n", numTests);
+    printf(" Variants: %d\n", numVariants);
+    printf(" Iterations: %d\n", interationsTotal);
+    printf(" Steps: %d\n", stepsTotal);
+    printf("\n");
+    printf(" Board: %dx%d (ring %d x %d bit, address %d bit)\n", NUM_FIELDW, NUM_FIELDW, NUM_FIELDS, MEM_DATA_WIDTH, MEM_ADDRESS_WIDTH);
+    printf(" Shift cycles: %d (%.1f per move)\n", interationsTotal * MEM_DATA_WIDTH, (double) interationsTotal * MEM_DATA_WIDTH / numTests);
+}
+
+void debug_corpus()
+{
+    printf("\n=== debug_corpus ===\n\n");
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    corpus_open(CORPUS_FILE);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int numVariants = 0;
+    for(int variant = 0; variant < NUM_VARIANTS; variant++) numVariants += corpus.variantStart[variant + 1] > corpus.variantStart[variant];
+
+    printf(" File: %s\n", strlen(corpus.file) ? corpus.file : "(memory)");
+    printf(" Cases: %" PRIu64 " (%" PRIu64 " built-in, %zu bytes each)\n", corpus.header->numCases, corpus.header->numSeed, sizeof(corpus_case_t));
+    printf(" Moves: %zu (up %u, down %u, left %u, right %u)\n", corpus_numMoves(), 
+        corpus.dirStart[1] - corpus.dirStart[0], corpus.dirStart[2] - corpus.dirStart[1], corpus.dirStart[3] - corpus.dirStart[2], corpus.dirStart[4] - corpus.dirStart[3]);
+    printf(" Scores: %zu\n", corpus_numScores());
+    printf(" Variant classes: %d of %d\n", numVariants, NUM_VARIANTS);
+    printf(" Open: %.3f ms\n", (double) (end.tv_sec - begin.tv_sec) * 1e3 + (double) (end.tv_nsec - begin.tv_nsec) * 1e-6);
+}
+
+
+/* === TEST FUNCTIONS ==== */
+
+void test_term()
+{
+    printf("[test_term] ");
+
+    struct { const char *input; int keys[4]; } tests[] = {
+        { "\033[A\033OB",   { KEY_UP, KEY_DOWN, KEY_NONE } },
+        { "\033xq",         { 27, 'x', 'q', KEY_NONE } },
+        { "\033[1;5C\033[D", { KEY_RIGHT, KEY_LEFT, KEY_NONE } },
+        { "\033[2~x",       { KEY_NONE, 'x', KEY_NONE } },
+    };
+
+    for(size_t t = 0; t < sizeof(tests) / sizeof(tests[0]); t++)
+    {
+        // the keys are read from the input buffer, stdin is not touched
+        term_bufferLen = (int) strlen(tests[t].input);
+        term_bufferPos = 0;
+        memcpy(term_buffer, tests[t].input, (size_t) term_bufferLen);
+
+        for(int k = 0; tests[t].keys[k] != KEY_NONE || term_bufferPos < term_bufferLen; k++)
+        {
+            assert(term_poll(0) == tests[t].keys[k]);
+        }
+        assert(term_bufferPos == term_bufferLen);
+    }
+
+    term_bufferPos = term_bufferLen = 0;
+
+    printf("ok.\n");
+}
+
+void test_toggles()
+{
+    printf("[test_toggles] ");
+
+    const memory_model_t *model = memory_model;
+    uint32_t state = 0x2048;
+
+    for(int m = 0; m < NUM_MEMORY_MODELS; m++)
+    {
+        memory_model = &memory_models[m];
+
+        for(int i = 0; i < 100; i++)
+        {
+            memory_reset();
+
+            for(int k = 0; k < NUM_FIELDS; k++)
+            {
+                state = (state * 1103515245) + 12345;
+                game_field[k] = getSign((int) ((state >> 16) % 12));
+            }
+
+            state = (state * 1103515245) + 12345;
+            int index = (int) ((state >> 16) % NUM_FIELDS);
+            int distance = memory_model->distance(index);
+
+            int chain[NUM_FIELDS], ring;
+            int length = memory_model->chain(index, chain, &ring);
+
+            // shift the bits of the chain one clock at a time
+            uint8_t bits[TOGGLE_RING_BITS], next[TOGGLE_RING_BITS];
+            int numBits = length * MEM_DATA_WIDTH;
+            int clocks = distance * MEM_DATA_WIDTH;
+            long buffer = 0, memory = 0, counter = 0;
+
+            for(int k = 0; k < length; k++)
+            {
+                for(int b = 0; b < MEM_DATA_WIDTH; b++) bits[(k * MEM_DATA_WIDTH) + b] = (getSignValue(game_field[chain[k]]) >> b) & 1;
+            }
+
+            for(int t = 0; t < clocks; t++)
+            {
+                for(int k = 0; k < numBits; k++)
+                {
+                    next[k] = bits[(k + 1) % numBits];
+                    if(next[k] != bits[k])
+                    {
+                        if(k < MEM_DATA_WIDTH) buffer++;
+                        else memory++;
+                    }
+                }
+                memcpy(bits, next, numBits);
+            }
+
+            // counter loaded from 0 with the clocks, counting down to 1
+            int value = 0;
+            for(int t = clocks; t >= 1; t--)
+            {
+                counter += __builtin_popcount((unsigned) (value ^ t));
+                value = t;
+            }
+
+            toggle_count_t before = game_numToggles;
+            memory_toggleShift(index, distance);
+
+            assert(game_numToggles.buffer - before.buffer == buffer);
+            assert(game_numToggles.memory - before.memory == memory);
+            assert(game_numToggles.counter - before.counter == counter);
+
+            // an access without shift reloads the counter from 1 to 0
+            before = game_numToggles;
+            memory_toggleShift(index, 0);
+            assert(game_numToggles.counter - before.counter == (clocks ? 1 : 0));
+            assert(game_numToggles.buffer == before.buffer && game_numToggles.memory == before.memory);
+        }
+    }
+
+    memory_model = model;
+    game_reset();
+
+    printf("ok.\n");
+}
+
+void test_memory()
+{
+    printf("[test_memory] ");
+
+    const memory_model_t *model = memory_model;
+
+    // shifts of two accesses (row 1 column 1, then row 0 column 1) from reset
+    int expected[][2] = {
+        { NUM_FIELDW + 1, NUM_FIELDS - NUM_FIELDW },    // ring
+        { NUM_FIELDW + 1, NUM_FIELDW },                 // biring, the short way back
+        { 1, 1 },                                       // rows
+        { 1, NUM_FIELDW - 1 },                          // columns
+        { 0, 0 },                                       // random
+    };
+    int indices[2] = { NUM_FIELDW + 1, 1 };
+
+    assert(sizeof(expected) / sizeof(expected[0]) == NUM_MEMORY_MODELS);
+
+    for(int m = 0; m < NUM_MEMORY_MODELS; m++)
+    {
+        memory_model = &memory_models[m];
+        game_reset();
+
+        for(int a = 0; a < 2; a++)
+        {
+            int iterations = game_numIterations;
+
+            assert(memory_model->distance(indices[a]) == expected[m][a]);
+            accessMemory(indices[a], false, 0);
+            assert(game_numIterations - iterations == expected[m][a]);
+            assert(memory_model->distance(indices[a]) == 0);
+        }
+
+        assert(memory_cycles() == (long) (expected[m][0] + expected[m][1]) * MEM_DATA_WIDTH + 2);
+
+        // shifting one field at a time reaches the field after distance shifts
+        for(int index = 0; index < NUM_FIELDS; index++)
+        {
+            int distance = memory_model->distance(index);
+
+            for(int d = 0; d < distance; d++) memory_model->shift(index);
+            assert(memory_model->distance(index) == 0);
+        }
+
+        // all moves are correct with every model
+        int numTests = (int) corpus_numMoves();
+        for(int i = 0; i < numTests; i++)
+        {
+            game_reset();
+            memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+            assert(game_move4(corpus_move(i)->dir) == corpus_move(i)->moved);
+            assert(memcmp(game_field, corpus_move(i)->result, NUM_FIELDS) == 0);
+        }
+    }
+
+    memory_model = model;
+    game_reset();
+
+    printf("ok.\n");
+}
+
+static void *test_traceThread(void *arg)
+{
+    trace_scope_t scope = trace_begin(arg);
+    trace_end(&scope);
+
+    return NULL;
+}
+
+void test_trace()
+{
+    printf("[test_trace] ");
+
+    // more thread lifetimes than buffers all record their events
+    size_t numEvents = 0;
+    pthread_mutex_lock(&trace_mutex);
+    for(int b = 0; b < trace_numBuffers; b++) numEvents += trace_buffers[b]->numEvents;
+    pthread_mutex_unlock(&trace_mutex);
+
+    for(int i = 0; i < TRACE_MAX_THREADS + 16; i++)
+    {
+        pthread_t thread;
+        assert(pthread_create(&thread, NULL, test_traceThread, "test_trace") == 0);
+        pthread_join(thread, NULL);
+    }
+
+    size_t numRecorded = 0;
+    pthread_mutex_lock(&trace_mutex);
+    for(int b = 0; b < trace_numBuffers; b++)
+    {
+        numRecorded += trace_buffers[b]->numEvents;
+
+        // begins after the start time
+        trace_buffer_t *buffer = trace_buffers[b];
+        if(buffer->numEvents > 0) assert(buffer->events[(buffer->numEvents - 1) % TRACE_BUFFER].begin >= trace_startTicks);
+    }
+    assert(trace_numBuffers < TRACE_MAX_THREADS);
+    pthread_mutex_unlock(&trace_mutex);
+
+    assert(numRecorded == numEvents + TRACE_MAX_THREADS + 16);
+
+    printf("ok.\n");
+}
+
+void test_computeIndex()
+{
+    printf("[test_computeIndex] ");
+
+    // every direction maps lanes and positions onto all fields exactly once
+    for(int dir = 1; dir <= NUM_DIRS; dir++)
+    {
+        bool seen[NUM_FIELDS] = {false};
+
+        for(int lane = 0; lane < NUM_FIELDW; lane++)
+        {
+            for(int pos = 0; pos < NUM_FIELDW; pos++)
+            {
+                int index = computeIndex(lane, pos, dir);
+
+                assert(index >= 0);
+                assert(index < NUM_FIELDS);
+                assert(!seen[index]);
+                seen[index] = true;
+            }
+        }
+    }
+
+#if NUM_FIELDW == 4
+    strncpy(game_field, "123456789abcdefg", NUM_FIELDS+1);
+
+    /*
+    ╔═══╦═══╦═══╦═══╗
+    ║ g ║ f ║ e ║ d ║
+    ╟───╫───╫───╫───╢
+    ║ c ║ b ║ a ║ 9 ║
+    ╟───╫───╫───╫───╢
+    ║ 8 ║ 7 ║ 6 ║ 5 ║
+    ╟───╫───╫───╫───╢
+    ║ 4 ║ 3 ║ 2 ║ 1 ║
+    ╚═══╩═══╩═══╩═══╝
+
+    */
+
+    assert(game_field[computeIndex(0, 0, MV_LEFT)] == '4');
+    assert(game_field[computeIndex(0, 1, MV_LEFT)] == '3');
+    assert(game_field[computeIndex(0, 2, MV_LEFT)] == '2');
+    assert(game_field[computeIndex(0, 3, MV_LEFT)] == '1');
+    assert(game_field[computeIndex(1, 0, MV_LEFT)] == '8');
+    assert(game_field[computeIndex(1, 1, MV_LEFT)] == '7');
+    assert(game_field[computeIndex(1, 2, MV_LEFT)] == '6');
+    assert(game_field[computeIndex(1, 3, MV_LEFT)] == '5');
+    assert(game_field[computeIndex(2, 0, MV_LEFT)] == 'c');
+    assert(game_field[computeIndex(2, 1, MV_LEFT)] == 'b');
+    assert(game_field[computeIndex(2, 2, MV_LEFT)] == 'a');
+    assert(game_field[computeIndex(2, 3, MV_LEFT)] == '9');
+    assert(game_field[computeIndex(3, 0, MV_LEFT)] == 'g');
+    assert(game_field[computeIndex(3, 1, MV_LEFT)] == 'f');
+    assert(game_field[computeIndex(3, 2, MV_LEFT)] == 'e');
+    assert(game_field[computeIndex(3, 3, MV_LEFT)] == 'd');
+
+    assert(game_field[computeIndex(0, 0, MV_RIGHT)] == '1');
+    assert(game_field[computeIndex(0, 1, MV_RIGHT)] == '2');
+    assert(game_field[computeIndex(0, 2, MV_RIGHT)] == '3');
+    assert(game_field[computeIndex(0, 3, MV_RIGHT)] == '4');
+    assert(game_field[computeIndex(1, 0, MV_RIGHT)] == '5');
+    assert(game_field[computeIndex(1, 1, MV_RIGHT)] == '6');
+    assert(game_field[computeIndex(1, 2, MV_RIGHT)] == '7');
+    assert(game_field[computeIndex(1, 3, MV_RIGHT)] == '8');
+    assert(game_field[computeIndex(2, 0, MV_RIGHT)] == '9');
+    assert(game_field[computeIndex(2, 1, MV_RIGHT)] == 'a');
+    assert(game_field[computeIndex(2, 2, MV_RIGHT)] == 'b');
+    assert(game_field[computeIndex(2, 3, MV_RIGHT)] == 'c');
+    assert(game_field[computeIndex(3, 0, MV_RIGHT)] == 'd');
+    assert(game_field[computeIndex(3, 1, MV_RIGHT)] == 'e');
+    assert(game_field[computeIndex(3, 2, MV_RIGHT)] == 'f');
+    assert(game_field[computeIndex(3, 3, MV_RIGHT)] == 'g');
+
+    assert(game_field[computeIndex(0, 0, MV_UP)] == 'd');
+    assert(game_field[computeIndex(0, 1, MV_UP)] == '9');
+    assert(game_field[computeIndex(0, 2, MV_UP)] == '5');
+    assert(game_field[computeIndex(0, 3, MV_UP)] == '1');
+    assert(game_field[computeIndex(1, 0, MV_UP)] == 'e');
+    assert(game_field[computeIndex(1, 1, MV_UP)] == 'a');
+    assert(game_field[computeIndex(1, 2, MV_UP)] == '6');
+    assert(game_field[computeIndex(1, 3, MV_UP)] == '2');
+    assert(game_field[computeIndex(2, 0, MV_UP)] == 'f');
+    assert(game_field[computeIndex(2, 1, MV_UP)] == 'b');
+    assert(game_field[computeIndex(2, 2, MV_UP)] == '7');
+    assert(game_field[computeIndex(2, 3, MV_UP)] == '3');
+    assert(game_field[computeIndex(3, 0, MV_UP)] == 'g');
+    assert(game_field[computeIndex(3, 1, MV_UP)] == 'c');
+    assert(game_field[computeIndex(3, 2, MV_UP)] == '8');
+    assert(game_field[computeIndex(3, 3, MV_UP)] == '4');
+
+    assert(game_field[computeIndex(0, 0, MV_DOWN)] == '1');
+    assert(game_field[computeIndex(0, 1, MV_DOWN)] == '5');
+    assert(game_field[computeIndex(0, 2, MV_DOWN)] == '9');
+    assert(game_field[computeIndex(0, 3, MV_DOWN)] == 'd');
+    assert(game_field[computeIndex(1, 0, MV_DOWN)] == '2');
+    assert(game_field[computeIndex(1, 1, MV_DOWN)] == '6');
+    assert(game_field[computeIndex(1, 2, MV_DOWN)] == 'a');
+    assert(game_field[computeIndex(1, 3, MV_DOWN)] == 'e');
+    assert(game_field[computeIndex(2, 0, MV_DOWN)] == '3');
+    assert(game_field[computeIndex(2, 1, MV_DOWN)] == '7');
+    assert(game_field[computeIndex(2, 2, MV_DOWN)] == 'b');
+    assert(game_field[computeIndex(2, 3, MV_DOWN)] == 'f');
+    assert(game_field[computeIndex(3, 0, MV_DOWN)] == '4');
+    assert(game_field[computeIndex(3, 1, MV_DOWN)] == '8');
+    assert(game_field[computeIndex(3, 2, MV_DOWN)] == 'c');
+    assert(game_field[computeIndex(3, 3, MV_DOWN)] == 'g');
+#endif
+
+    printf("ok.\n");
+}
+
+void test_signs()
+{
+    printf("[test_signs] ");
+
+    for(int value = 0; value <= NUM_SIGNS; value++)
+    {
+        assert(getSignValue(getSign(value)) == value);
+    }
+
+    assert(getSign(NUM_SIGNS + 1) == getSign(NUM_SIGNS));
+    assert(getSignValue('?') == 0);
+    assert(getSignValue((char) 0xff) == 0);
+
+    printf("ok.\n");
+}
+
+void test_display()
+{
+    printf("[test_display] ");
+
+    display_frame_t frame;
+    uint64_t chain[(DISPLAY_NUM_BITS + 63) / 64];
+
+    assert(display_encodeSign(' ') == 0);
+    assert(display_encodeSign('0') == 0x7e);
+    assert(display_encodeSign('8') == 0x7f);
+    assert(display_encodeSign('h') == 0x17);
+    assert(display_encodeSign('P') == 0x67);
+
+    memset(game_field, getSign(0), NUM_FIELDS);
+    game_field[0] = '1';
+    game_field[NUM_FIELDS - 1] = 'h';
+    strncpy(game_score, "   1024", NUM_SCORE + 1);
+
+    display_encode(&frame, 1 << 3);
+    display_pack(&frame, chain);
+
+    // first tile is shifted out first and ends up in the lowest bits
+    assert((chain[0] & 0xff) == (0x30 << 1));
+    assert(frame.digit[NUM_FIELDS - 1] == (0x17 << 1));
+
+    // "   1024" with a dot after the thousands
+    assert(frame.digit[DISPLAY_SCORE_DIGIT + 0] == (0x33 << 1));
+    assert(frame.digit[DISPLAY_SCORE_DIGIT + 3] == ((0x30 << 1) | 1));
+    assert(frame.digit[DISPLAY_SCORE_DIGIT + 4] == 0);
+
+    strncpy(game_score, "      0", NUM_SCORE + 1);
+
+    printf("ok.\n");
+}
+
+void test_batch()
+{
+    printf("[test_batch] ");
+
+    enum { NUM = 1000, STRIDE = 1024 };
+
+    static uint8_t cells[NUM_FIELDS * STRIDE];
+    static uint8_t test[NUM_FIELDS * STRIDE];
+    bool     moved[STRIDE];
+    uint32_t score[STRIDE];
+    uint32_t rng = 1;
+
+    batch_kernel_info_t kernels[3];
+    int numKernels = batch_kernels(kernels);
+
+    for(int k = 0; k < numKernels; k++)
+    {
+        if(!kernels[k].supported) continue;
+
+        for(int dir = 1; dir <= NUM_DIRS; dir++)
+        {
+            batch_fillRandom(test, NUM, STRIDE, &rng);
+            memcpy(cells, test, sizeof(cells));
+
+            kernels[k].kernel(dir, NUM, STRIDE, cells, moved, score);
+
+            for(int board = 0; board < NUM; board++)
+            {
+                char result[NUM_FIELDS + 1] = {0};
+
+                game_valuesToField(&test[board], STRIDE, game_field);
+                bool movedRef = game_move_ref(dir);
+
+                game_valuesToField(&cells[board], STRIDE, result);
+                assert(strncmp(result, game_field, NUM_FIELDS) == 0);
+                assert(moved[board] == movedRef);
+
+                // leading zeros, the score is compared as a number
+                game_valuesToField(&test[board], STRIDE, game_field);
+                strncpy(game_score, "0000000", NUM_SCORE + 1);
+                game_move4(dir);
+                game_scoreRefresh();
+                assert(score[board] == (uint32_t) atol(game_score));
+            }
+        }
+    }
+
+    strncpy(game_score, "      0", NUM_SCORE + 1);
+
+    printf("ok.\n");
+}
+
+void test_checkpoint()
+{
+    printf("[test_checkpoint] ");
+
+    static search_state_t saved, state;
+    char file[64], tmp[PATH_MAX];
+
+    snprintf(file, sizeof(file), "/tmp/emu_test_%d.ckpt", (int) getpid());
+    snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+
+    saved = (search_state_t) {
+        .magic     = SEARCH_CHECKPOINT_MAGIC,
+        .version   = SEARCH_CHECKPOINT_VERSION,
+        .numFieldW = NUM_FIELDW,
+        .rng       = 0x12345,
+        .limit     = 1000,
+        .iteration = 777,
+        .numCases  = 3,
+        .maxCases  = 4,
+        .cases     = calloc(4, sizeof(search_case_t)),
+    };
+    assert(saved.cases);
+
+    for(int i = 0; i < NUM_VARIANTS; i += 3) saved.variants.v[i] = true;
+    saved.variants.num = (NUM_VARIANTS + 2) / 3;
+
+    for(uint32_t i = 0; i < saved.numCases; i++)
+    {
+        memcpy(saved.cases[i].test, test_fields[i].test, NUM_FIELDS);
+        memcpy(saved.cases[i].result, test_fields[i].result, NUM_FIELDS);
+        saved.cases[i].dir = (uint8_t) test_fields[i].dir;
+        saved.cases[i].moved = test_fields[i].moved;
+    }
+
+    // round trip
+    assert(search_saveCheckpoint(&saved, file));
+    assert(access(tmp, F_OK) != 0);
+
+    state = (search_state_t) { .limit = saved.limit };
+    assert(search_loadCheckpoint(&state, file));
+    assert(state.rng == saved.rng && state.iteration == saved.iteration && state.numCases == saved.numCases);
+    assert(state.maxCases >= state.numCases);
+    assert(memcmp(&state.variants, &saved.variants, sizeof(variant_store_t)) == 0);
+    assert(memcmp(state.cases, saved.cases, saved.numCases * sizeof(search_case_t)) == 0);
+    free(state.cases);
+
+    // a search with another limit does not resume
+    state = (search_state_t) { .limit = saved.limit + 1 };
+    assert(!search_loadCheckpoint(&state, file));
+    assert(state.cases == NULL && state.iteration == 0);
+
+    // truncated files (in the state and in the cases) are rejected
+    off_t sizes[] = { 0, (off_t) offsetof(search_state_t, cases) - 1, (off_t) (offsetof(search_state_t, cases) + sizeof(search_case_t) * 2 + 1) };
+    for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        assert(search_saveCheckpoint(&saved, file));
+        assert(truncate(file, sizes[i]) == 0);
+
+        state = (search_state_t) { .limit = saved.limit };
+        assert(!search_loadCheckpoint(&state, file));
+        assert(state.cases == NULL && state.iteration == 0);
+    }
+
+    // another magic, version or width is rejected
+    for(int field = 0; field < 3; field++)
+    {
+        search_state_t other = saved;
+        if(field == 0) other.magic++;
+        if(field == 1) other.version++;
+        if(field == 2) other.numFieldW++;
+        assert(search_saveCheckpoint(&other, file));
+
+        state = (search_state_t) { .limit = saved.limit };
+        assert(!search_loadCheckpoint(&state, file));
+        assert(state.cases == NULL && state.iteration == 0);
+    }
+
+    // a missing file
+    unlink(file);
+    assert(!search_loadCheckpoint(&state, file));
+
+    free(saved.cases);
+
+    printf("ok.\n");
+}
+
+void test_move4_table()
+{
+    printf("[test_move4_table] ");
+
+    // first step only reads
+    uint16_t first = MOVE4_D_MEM_READ_B | MOVE4_D_MEM_READ_V | MOVE4_D_BASE_READ_ZERO;
+    assert(move4_table[1 << MOVE4_C_START] == first);
+
+    // merge two equal tiles
+    uint16_t merge = move4_table[1 << MOVE4_C_EQUAL];
+    assert(merge & MOVE4_D_ADD_SCORE);
+    assert(merge & MOVE4_D_MEM_WRITE);
+    assert(merge & MOVE4_D_CLR_VALUE);
+    assert(!(merge & MOVE4_D_BASE_WRITE_INC));
+
+    // done after the last position of the last lane
+    for(int condition = 0; condition < MOVE4_TABLE_SIZE; condition++)
+    {
+        bool last = (condition >> MOVE4_C_LAST_POS & 1) && (condition >> MOVE4_C_LAST_LANE & 1);
+
+        assert(!!(move4_table[condition] & MOVE4_D_DONE) == last);
+        assert(!(move4_table[condition] & MOVE4_D_DONE) || !(move4_table[condition] & (MOVE4_D_MEM_READ_B | MOVE4_D_MEM_READ_V)));
+    }
+
+    // the generated RTL matches the table
+    FILE *f = fopen(GENERATE_LOGIC_FILE, "r");
+    if(f)
+    {
+        char *text;
+        size_t size;
+        FILE *m = open_memstream(&text, &size);
+        move4_writeLogic(m);
+        fclose(m);
+
+        char *file = malloc(size + 1);
+        assert(file);
+        size_t read = fread(file, 1, size + 1, f);
+        fclose(f);
+
+        assert(read == size);
+        assert(memcmp(file, text, size) == 0);
+
+        free(file);
+        free(text);
+    }
+    else printf("RTL comparison skipped (%s not found) ", GENERATE_LOGIC_FILE);
+
+    printf("ok.\n");
+}
+
+void test_filter()
+{
+    printf("[test_filter] ");
+
+    static const char *dirNames[] = { "", "MV_UP", "MV_DOWN", "MV_LEFT", "MV_RIGHT" };
+    char line[128], field[NUM_FIELDS + 1];
+    int dir;
+    uint32_t score;
+    bool error;
+    int numTests = (int) corpus_numMoves();
+
+    for(int i = 0; i < numTests; i++)
+    {
+        // text record as in test_fields[] with a score
+        int len = snprintf(line, sizeof(line), "    {\"%s\", %s, %d},\n", corpus_move(i)->test, dirNames[corpus_move(i)->dir], i);
+
+        assert(filter_parseText(line, line + len, field, &dir, &score, &error));
+        assert(!error);
+        assert(strcmp(field, corpus_move(i)->test) == 0);
+        assert(dir == (int) corpus_move(i)->dir);
+        assert(score == (uint32_t) i);
+
+        // binary record
+        filter_record_t record = { .score = (uint32_t) i, .dir = (uint8_t) dir };
+        filter_result_t result;
+
+        for(int j = 0; j < NUM_FIELDS; j++) record.cells[j] = (uint8_t) getSignValue(field[j]);
+
+        game_moves_t moves;
+        game_moveAll(field, &moves);
+
+        assert(filter_binary(&record, &result, -1));
+        assert(result.moved == corpus_move(i)->moved);
+        assert(result.score == (uint32_t) i + moves.score[dir]);
+
+        for(int j = 0; j < NUM_FIELDS; j++) assert(getSign(result.cells[j]) == corpus_move(i)->result[j]);
+    }
+
+    // lines without a board are skipped, broken ones are errors
+    strcpy(line, "// move #8");
+    assert(!filter_parseText(line, line + strlen(line), field, &dir, &score, &error));
+    strcpy(line, "{\"12\", MV_UP}");
+    assert(filter_parseText(line, line + strlen(line), field, &dir, &score, &error) && error);
+
+    filter_record_t record = { .dir = 5 };
+    filter_result_t result;
+    assert(!filter_binary(&record, &result, -1));
+
+    // the same records from a stream (stdin) and from a mapped file give the same results
+    char file[64];
+    snprintf(file, sizeof(file), "/tmp/emu_test_%d.filter", (int) getpid());
+
+    for(int binary = 0; binary < 2; binary++)
+    {
+        char *input, *output[2];
+        size_t inputSize, outputSize[2];
+        FILE *f = open_memstream(&input, &inputSize);
+        assert(f);
+
+        for(int i = 0; i < numTests; i++)
+        {
+            if(binary)
+            {
+                filter_record_t r = { .score = (uint32_t) i, .dir = corpus_move(i)->dir };
+                for(int j = 0; j < NUM_FIELDS; j++) r.cells[j] = (uint8_t) getSignValue(corpus_move(i)->test[j]);
+                fwrite(&r, sizeof(r), 1, f);
+            }
+            else
+            {
+                fprintf(f, "    {\"%s\", %s, %d},\n", corpus_move(i)->test, dirNames[corpus_move(i)->dir], i);
+                if(i % 3 == 0) fprintf(f, "// no record\n");
+            }
+        }
+        fclose(f);
 
-        // Memory
-        int indexClear = computeIndex(lane,     posView,      dir);
-        int indexWrite = computeIndex(lane,     posBaseWrite, dir);
-        int indexReadB = computeIndex(nextLane, posBaseRead,  dir);
-        int indexReadD = computeIndex(nextLane, nextPosView,  dir);
+        FILE *written = fopen(file, "wb");
+        assert(written && fwrite(input, 1, inputSize, written) == inputSize);
+        fclose(written);
 
-        if(DEBUG_MOVE && debug) printf("[%d:%d-%d] %x '%c' '%c' ", lane, posBase, posView, game_fieldIndex, buff, data);
-        if(DEBUG_MOVE && debug) printf("(%d%d%d%d%d%d%d) ", start, isViewZero, isBaseZero, canMerge, hasGap, hasTwoTiles,moveTile);
-        if(DEBUG_MOVE && debug) print_lane(lane, dir);
+        for(int mapped = 0; mapped < 2; mapped++)
+        {
+            char *argv[5];
+            int   argc = 0;
 
-        unsigned char hex[] = "0123456789abcdef";
+            argv[argc++] = "emu";
+            argv[argc++] = "-f";
+            if(binary) argv[argc++] = "-b";
+            if(mapped) argv[argc++] = file;
+            argv[argc] = NULL;
 
-        if(DEBUG_MOVE && debug) printf(" C %c W %c R %c %c]", 
-            moveTile                    ? hex[posView]      : ' ',
-            moveTile                    ? hex[posBaseWrite] : ' ',
-            !done && (start || incLane) ? hex[posBaseRead]  : ' ',
-            !done                       ? hex[nextPosView]  : ' ');
+            FILE *in  = fmemopen(input, inputSize, "rb");
+            FILE *out = open_memstream(&output[mapped], &outputSize[mapped]);
+            assert(in && out);
 
-        if(DEBUG_MOVE && debug) printf(" ---> ");
+            optind = 1;
+            assert(filter_run(argc, argv, in, out) == EXIT_SUCCESS);
 
-        if(hasTwoTiles || moveTile)
+            fclose(in);
+            fclose(out);
+        }
+
+        assert(outputSize[0] == outputSize[1] && memcmp(output[0], output[1], outputSize[0]) == 0);
+
+        // one result per record, checked against the reference
+        const char *p = output[0];
+
+        for(int i = 0; i < numTests; i++)
         {
-            buff = canMerge ? next : data;
+            game_moves_t moves;
+            game_moveAll(corpus_move(i)->test, &moves);
 
-            if(moveTile)
+            int      moved;
+            char     resultField[NUM_FIELDS + 1];
+            uint32_t resultScore;
+
+            if(binary)
             {
-                accessMemory(indexClear, true, game_signs[0]);
-                accessMemory(indexWrite, true, buff);
+                const filter_result_t *r = (const filter_result_t *) p + i;
 
-                if(canMerge)
-                {
-                    game_addScore(nextValue);
-                    buff = game_signs[0];
-                } 
+                moved = r->moved;
+                resultScore = r->score;
+                for(int j = 0; j < NUM_FIELDS; j++) resultField[j] = getSign(r->cells[j]);
+                resultField[NUM_FIELDS] = '\0';
+            }
+            else
+            {
+                const char *eol = strchr(p, '\n');
+                assert(eol && p[2] == '"' && p[3 + NUM_FIELDS] == '"');
+
+                moved = p[0] - '0';
+                memcpy(resultField, p + 3, NUM_FIELDS);
+                resultField[NUM_FIELDS] = '\0';
+                resultScore = (uint32_t) strtoul(p + 5 + NUM_FIELDS, NULL, 10);
+                p = eol + 1;
             }
-        }        
 
-        if(!done)
-        {
-            if(start || incLane) buff = accessMemory(indexReadB, false, 0);
-            data = accessMemory(indexReadD, false, 0);            
+            assert(moved == corpus_move(i)->moved);
+            assert(strcmp(resultField, corpus_move(i)->result) == 0);
+            assert(resultScore == (uint32_t) i + moves.score[corpus_move(i)->dir]);
         }
 
-        if(DEBUG_MOVE && debug) printf("%x '%c' '%c' [%d:%d-%d] ", game_fieldIndex, buff, data, nextLane, nextPosBase, nextPosView);
-        if(DEBUG_MOVE && debug) print_lane(lane, dir);
-        if(DEBUG_MOVE && debug) printf("\n");
-
-        start    = false;
-        lane     = nextLane;
-        posBase  = nextPosBase;
-        posView  = nextPosView;
-        hasMoved = hasMoved || moveTile;  
-
+        assert(binary ? outputSize[0] == numTests * sizeof(filter_result_t) : *p == '\0');
 
-    } while(!done);
+        free(input);
+        free(output[0]);
+        free(output[1]);
+    }
 
-    if(DEBUG_MOVE && debug) print_game();
+    unlink(file);
+    game_reset();
 
-    if(hasMoved) game_lastMove = dir;
-    
-    return hasMoved;
+    printf("ok.\n");
 }
 
-bool game_move2(move_direction_t dir)
+/*
+    overwrite size bytes of a corpus file at offset
+*/
+static void test_corpusPatch(const char *file, size_t offset, const void *data, size_t size)
 {
-    bool hasMoved = false;
-    int base = 0, data = 0;
-
-    int lane = 0;
-    int posBase = 0;
-    int posData = 0;
-    bool done = false;
+    int fd = open(file, O_WRONLY);
+    assert(fd >= 0);
+    assert(pwrite(fd, data, size, (off_t) offset) == (ssize_t) size);
+    close(fd);
+}
 
-    do
-    {       
-        game_numSteps += 1;
+void test_corpus()
+{
+    printf("[test_corpus] ");
 
-        int index1   = computeIndex(lane, posBase, dir);
-        int index1p1 = computeIndex(lane, posBase+1, dir);
-        int index2   = computeIndex(lane, posData, dir);
-            
-        data = accessMemory(index2, false, 0);
-  
-        bool start       = (posBase == 0) && (posData == 0);
-        bool isBaseZero  = (base == game_signs[0]);
-        bool isDataZero  = (data == game_signs[0]);    
-        bool eqBaseData  = (base == data);        
-        bool hasTwoTiles = !start && !isBaseZero && !isDataZero;
-        bool canMerge    = hasTwoTiles && eqBaseData;
-        bool hasGap      = hasTwoTiles && (posData - posBase > 1);
-        bool moveTile    = !start && !isDataZero && (isBaseZero || canMerge || hasGap);
+    corpus_open("");
 
-        bool incData     = canMerge;
-        bool clear       = !start && !isDataZero && canMerge;
-        bool load        = start || (!start && !isDataZero && !canMerge);
+    size_t numFields = sizeof(test_fields)/sizeof(test_fields[0]);
+    size_t numScores = sizeof(test_scores)/sizeof(test_scores[0]);
 
-        int posBaseNext  = posBase + 1;
-        int posDataNext  = posData + 1;
-        int laneNext     = lane + 1;
-        int incLane      = (posDataNext >= NUM_FIELDW);
-        done             = incLane && (laneNext >= NUM_FIELDW);
+    for(int pass = 0; pass < 2; pass++)
+    {
+        // the built-in tables in their order, the appended case last
+        assert(corpus_numMoves() == numFields + pass);
+        assert(corpus_numScores() == numScores);
 
-        int nextLane     = incLane ? laneNext : lane;
-        int nextPosBase  = incLane ? 0 : (hasTwoTiles ? posBaseNext : posBase);
-        int nextPosData  = incLane ? 0 : posDataNext;
+        for(size_t i = 0; i < numFields; i++) assert(strcmp(corpus_move(i)->test, test_fields[i].test) == 0);
+        for(size_t i = 0; i < numScores; i++) assert(strcmp(corpus_score(i)->result, test_scores[i].result) == 0);
 
-        assert(game_fieldIndex == index2);
+        // every move case is in the list of its direction and of all its variants
+        size_t numListed = 0;
 
-        int nextValue = getSignValue(base) + 1;    
+        for(int dir = 1; dir <= NUM_DIRS; dir++)
+        {
+            for(uint32_t j = corpus.dirStart[dir - 1]; j < corpus.dirStart[dir]; j++)
+            {
+                assert(corpus.cases[corpus.dirCases[j]].dir == dir);
+                numListed++;
+            }
+        }
+        assert(numListed == corpus_numMoves());
 
-        if(moveTile) 
+        for(size_t i = 0; i < corpus_numMoves(); i++)
         {
-                 
-            int writeIndex = !canMerge && hasGap ? index1p1 : index1;
-            int setData    = incData ? game_signs[nextValue] : data;
+            const corpus_case_t *c = corpus_move(i);
 
-            int distW = computeMemoryDistance(writeIndex);
-            int dist2 = computeMemoryDistance(index2);
-            assert(dist2 < distW || dist2 == 0);
+            for(int lane = 0; lane < NUM_FIELDW; lane++)
+            {
+                bool found = false;
+                for(uint32_t j = corpus.variantStart[c->variants[lane]]; j < corpus.variantStart[c->variants[lane] + 1]; j++)
+                {
+                    found |= &corpus.cases[corpus.variantCases[j]] == c;
+                }
+                assert(found);
+            }
+        }
 
-            accessMemory(index2, true, game_signs[0]);
-            accessMemory(writeIndex, true, setData);
+        if(pass == 0)
+        {
+            corpus_case_t c;
+            corpus_makeMove(&c, test_fields[numFields - 1].test, test_fields[numFields - 1].dir);
+            assert(strcmp(c.result, test_fields[numFields - 1].result) == 0);
+            corpus_append(&c, 1);
         }
+    }
 
-        
-        if(canMerge) game_addScore(nextValue);
+    // a corpus file: mapped, index written back and mapped on the next open
+    char file[64];
+    snprintf(file, sizeof(file), "/tmp/emu_test_%d.corpus", (int) getpid());
+    unlink(file);
+
+    corpus_open(file);
+    assert(corpus.mapped && corpus.index != NULL);
+    assert(corpus_numMoves() == numFields && corpus_numScores() == numScores);
+
+    corpus_open(file);
+    assert(corpus.mapped && corpus.index == NULL);
+    assert(corpus_numMoves() == numFields && corpus_numScores() == numScores);
+
+    // an appended case is kept when the seed changes
+    corpus_case_t c;
+    corpus_makeMove(&c, test_fields[0].test, MV_DOWN);
+    corpus_append(&c, 1);
+    assert(corpus.mapped && corpus_numMoves() == numFields + 1);
+
+    corpus_open(file);
+    assert(corpus.index == NULL && corpus_numMoves() == numFields + 1);
+
+    uint64_t seedHash = 0;
+    test_corpusPatch(file, offsetof(corpus_header_t, seedHash), &seedHash, sizeof(seedHash));
+    corpus_open(file);
+    assert(corpus.mapped && corpus.header->seedHash == corpus_seedHash());
+    assert(corpus_numMoves() == numFields + 1);
+    assert(memcmp(corpus_move(numFields), &c, sizeof(c)) == 0);
+
+    // invalid stored indices are built again
+    corpus_open(file);
+    size_t indexOffset = corpus.header->indexOffset;
+    uint32_t numCases = (uint32_t) corpus.header->numCases;
+    assert(corpus.index == NULL && indexOffset != 0);
+
+    test_corpusPatch(file, indexOffset + (CORPUS_INDEX_STARTS + 1) * sizeof(uint32_t), &numCases, sizeof(numCases));
+    corpus_open(file);
+    assert(corpus.index != NULL && corpus_numMoves() == numFields + 1);
+
+    uint32_t numVariantCases = UINT32_MAX / 2;
+    test_corpusPatch(file, indexOffset + (CORPUS_INDEX_STARTS - 1) * sizeof(uint32_t), &numVariantCases, sizeof(numVariantCases));
+    corpus_open(file);
+    assert(corpus.index != NULL && corpus_numMoves() == numFields + 1);
+
+    // invalid cases (the appended one) and files of another version or width are replaced
+    size_t caseOffset = sizeof(corpus_header_t) + (numFields + numScores) * sizeof(corpus_case_t);
+    uint8_t dir = 0;
+    uint16_t variant = 60000;
+    uint8_t kind = CORPUS_NUM_KINDS;
+    uint32_t version = CORPUS_VERSION + 1, numFieldW = NUM_FIELDW + 1;
+
+    struct { size_t offset; const void *data; size_t size; } patches[] = {
+        { caseOffset + offsetof(corpus_case_t, dir), &dir, sizeof(dir) },
+        { caseOffset + offsetof(corpus_case_t, variants), &variant, sizeof(variant) },
+        { caseOffset + offsetof(corpus_case_t, kind), &kind, sizeof(kind) },
+        { offsetof(corpus_header_t, version), &version, sizeof(version) },
+        { offsetof(corpus_header_t, numFieldW), &numFieldW, sizeof(numFieldW) },
+    };
+
+    for(size_t p = 0; p < sizeof(patches) / sizeof(patches[0]); p++)
+    {
+        test_corpusPatch(file, patches[p].offset, patches[p].data, patches[p].size);
+        corpus_open(file);
+        assert(corpus.mapped && corpus.header->version == CORPUS_VERSION && corpus.header->numFieldW == NUM_FIELDW);
+        assert(corpus_numMoves() == numFields && corpus_numScores() == numScores);
 
-        lane     = nextLane;
-        posBase  = nextPosBase;
-        posData  = nextPosData;
-        
-        if(load)  base = data;
-        if(clear) base = game_signs[0];
+        corpus_append(&c, 1);
+        assert(corpus_numMoves() == numFields + 1);
+    }
 
-        hasMoved = hasMoved || moveTile;   
+    corpus_close();
+    unlink(file);
 
-    } while(!done);
+    corpus_open(CORPUS_FILE);
 
-    if(hasMoved) game_lastMove = dir;
-    
-    return hasMoved;
+    printf("ok.\n");
 }
 
-bool game_move1(move_direction_t dir)
+void test_compact()
 {
-    bool hasMoved = false;
-    int data1, data2;
-
-    for(int lane = 0; lane < NUM_FIELDW; lane++)
+    printf("[test_compact] ");
+
+    compact_t c;
+    int counts[4];
+
+    compact_init(&c, 2000, 7);
+    compact_select(&c);
+    compact_count(&c, true, counts);
+
+    // the selection covers every goal of the candidates
+    assert(c.numSelected > 0 && c.numSelected < c.numVectors);
+    for(int k = 0; k < 4; k++) assert(counts[k] == c.reached[k]);
+    assert(c.reached[0] > 0 && c.reached[1] > 0 && c.reached[2] >= c.reached[1]);
+    if(game_scoreVersion == 1) assert(c.reached[3] > 1);
+
+    // the written module reads back as the selected vectors
+    char file[64];
+    snprintf(file, sizeof(file), "/tmp/emu_test_%d.py", (int) getpid());
+
+    FILE *f = fopen(file, "w");
+    assert(f);
+    compact_write(&c, f);
+    fclose(f);
+
+    compact_vector_t *vectors = malloc((c.numSelected + 1) * sizeof(compact_vector_t));
+    assert(vectors);
+
+    f = fopen(file, "r");
+    assert(f);
+    assert(compact_read(f, vectors, c.numSelected) == (long) c.numSelected);
+    rewind(f);
+    if(c.numSelected > 1) assert(compact_read(f, vectors, c.numSelected - 1) == -1);
+    fclose(f);
+    unlink(file);
+
+    // the expected results are the ones of the reference, the score wraps at NUM_SCORE digits
+    for(size_t i = 0; i < c.numSelected; i++)
     {
-        int pos1 = 0;
-        int pos2 = 1;
-    
-        bool fetch1 = true;
-        bool done = false;
-
-        do
-        {    
-            game_numSteps += 1;   
-
-            bool writeData1 = false;
-            bool clearData2 = false;
-            bool updateScore = false;
-
-            int nextPos1 = pos1;
-            int nextPos2 = pos2 + 1;
+        const compact_vector_t *v = &vectors[i], *selected = &c.vectors[c.selected[i]];
+        game_moves_t moves;
 
-            int index1 = computeIndex(lane, pos1, dir);
-            int index2 = computeIndex(lane, pos2, dir);
-            int index1p1 = computeIndex(lane, pos1+1, dir);
-            
-            if(fetch1) data1 = accessMemory(index1, false, 0);
-            data2 = accessMemory(index2, false, 0);
-
-            fetch1 = false;
+        assert(memcmp(v->board, selected->board, NUM_FIELDS) == 0 && memcmp(v->score, selected->score, NUM_SCORE) == 0);
+        assert(v->dir == selected->dir);
 
-            int nextData1 = data1;
-            int writeData1Value;
+        game_moveAll(v->board, &moves);
+        assert(moves.moved[v->dir] == v->moved);
+        assert(strncmp(moves.field[v->dir], v->result, NUM_FIELDS) == 0);
+        assert((uint32_t) atol(v->resultScore) == ((uint32_t) atol(v->score) + moves.score[v->dir]) % SCORE_MODULO);
+    }
 
-            bool pos1empty = (data1 == game_signs[0]);
-            bool pos2empty = (data2 == game_signs[0]);            
-            bool canMerge  = (data1 == data2);
-            int nextValue  = getSignValue(data1) + 1;
-            bool hasGap = (pos2 - pos1 > 1);
+    free(vectors);
+    compact_free(&c);
+    game_reset();
 
-            if(!pos2empty)
-            {
-                if(pos1empty)
-                {
-                    /*
-                        move
-                        1   2       1     2 
-                        . . 1 1 --> 1 . . 1 
-                    */
+    printf("ok.\n");
+}
 
-                    writeData1 = true;
-                    writeData1Value = data2;
-                    nextData1 = data2;
-                    clearData2 = true;
-                }  
-                else  // both not empty
-                {
-                    if(canMerge)
-                    {
-                        /*
-                            merge
-                            1 2           1 2
-                            1 1 2 . --> 2 . 2 . 
+void test_moveK()
+{
+    printf("[test_moveK] ");
 
-                        */
-                        writeData1 = true;
-                        writeData1Value = game_signs[nextValue];
+    game_moves_t moves;
+    char test[NUM_FIELDS + 1] = {0};
+    uint32_t rng = 1;
+    int numTests = (int) corpus_numMoves();
 
-                        nextData1 = game_signs[0];
+    for(int i = 0; i < numTests + 1000; i++)
+    {
+        if(i < numTests)
+        {
+            memcpy(test, corpus_move(i)->test, NUM_FIELDS);
+        }
+        else
+        {
+            uint8_t values[NUM_FIELDS];
+            batch_fillRandom(values, 1, 1, &rng);
+            game_valuesToField(values, 1, test);
+        }
 
-                        updateScore = true;
-                        clearData2  = true;
+        game_moveAll(test, &moves);
 
-                    }
-                    else // both not empty, but can't merge
-                    {
-                        if(hasGap) 
-                        {
-                            /*
-                                shift value 2 to first gap spot
-                                1   2         1   2
-                                1 . 2 2 --> 1 2 . 2  
-                            */
+        static const int sizes[] = { MOVEK_MIN_BUFFERS, MOVEK_MAX_BUFFERS };
 
-                            index1 = index1p1;
+        for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            int k = sizes[s];
 
-                            writeData1 = true;
-                            writeData1Value = data2;                        
+            for(int dir = 1; dir <= NUM_DIRS; dir++)
+            {
+                // leading zeros, the score is compared as a number
+                memcpy(game_field, test, NUM_FIELDS);
+                strncpy(game_score, "0000000", NUM_SCORE + 1);
+                bool moved = game_moveK(dir, k);
+                game_scoreRefresh();
+
+                assert(moved == moves.moved[dir]);
+                assert(strncmp(game_field, moves.field[dir], NUM_FIELDS) == 0);
+                assert((uint32_t) atol(game_score) == moves.score[dir]);
+            }
+        }
+    }
 
-                            nextData1  = data2;
+    printf("ok.\n");
+}
 
-                            clearData2 = true;
-                        }
-                        else
-                        {
-                            /*
-                                check next value
-                                1 2           1 2
-                                1 2 . 2 --> 1 2 . 2
-                            */
-                            nextData1 = data2;
-                            nextPos2 = pos1 + 2; 
-                        }
-                    }
-                    
-                    nextPos1 = pos1 + 1;
-                }
-            }   
+void test_fuzz()
+{
+    printf("[test_fuzz] ");
 
-            if(DEBUG_MOVE && debug)  printf("\n%d:%d-%d empty:%d:%d gap:%d canMerge:%d", lane, pos1, pos2, pos1empty, pos2empty, hasGap, canMerge);  
-            if(DEBUG_MOVE && debug)  if(writeData1) printf(" [%d]<-%c", pos1, writeData1Value);
-            if(DEBUG_MOVE && debug)  if(clearData2) printf(" [%d]<-0", pos2);
+    static fuzz_t f;
+    f.rng = RNG_SEED;
 
-            if(writeData1) accessMemory(index1, true, writeData1Value);
-            if(clearData2) accessMemory(index2, true, game_signs[0]);
-            if(updateScore) game_addScore(nextValue);
+    fuzz_search(&f, 2000, true, 0);
 
-            pos1 = nextPos1;
-            pos2 = nextPos2;
+    assert(f.numMismatches == 0);
+    assert(f.numCorpus > 0);
+    assert(move4_numConditions > 0 && move4_numConditions <= MOVE4_TABLE_SIZE);
+    assert(move4_numPairs >= move4_numConditions);
 
-            data1 = nextData1;
+    printf("ok.\n");
+}
 
-            if(nextPos2 >= NUM_FIELDW) done = true;
+void test_move4_steps()
+{
+    printf("[test_move4_steps] ");
 
-            hasMoved = hasMoved || writeData1;   
+    int numTests = (int) corpus_numMoves();
 
-        } while(!done);
+    for(int i = 0; i < numTests; i++)
+    {
+        char field[NUM_FIELDS + 1], score[NUM_SCORE + 1];
+        int dir = corpus_move(i)->dir;
+
+        // at once
+        memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+        strncpy(game_score, "      0", NUM_SCORE + 1);
+        memory_reset();
+        game_numIterations = game_numSteps = 0;
+
+        bool moved = game_move4(dir);
+        game_scoreRefresh();
+        int numIterations = game_numIterations, numSteps = game_numSteps, fieldIndex = game_fieldIndex;
+        memcpy(field, game_field, NUM_FIELDS + 1);
+        memcpy(score, game_score, NUM_SCORE + 1);
+
+        // step by step
+        memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
+        strncpy(game_score, "      0", NUM_SCORE + 1);
+        memory_reset();
+        game_numIterations = game_numSteps = 0;
+
+        move4_t m;
+        move4_begin(&m, dir);
+
+        int numShifts = 0, numLogic = 0;
+        move4_event_t event;
+        while((event = move4_step(&m)) != MOVE4_DONE)
+        {
+            numShifts += event == MOVE4_SHIFT;
+            numLogic  += event == MOVE4_STEP;
+        }
 
+        assert(move4_end(&m) == moved);
+        game_scoreRefresh();
+        assert(strncmp(field, game_field, NUM_FIELDS) == 0);
+        assert(strncmp(score, game_score, NUM_SCORE) == 0);
+        assert(numShifts == numIterations && game_numIterations == numIterations);
+        assert(numLogic  == numSteps && game_numSteps == numSteps);
+        assert(game_fieldIndex == fieldIndex);
     }
 
-    if(DEBUG_MOVE && debug)  printf("\n");
-    if(DEBUG_MOVE && debug)  print_game();
-
-    if(hasMoved) game_lastMove = dir;
-    
-    return hasMoved;
+    printf("ok.\n");
 }
 
-/*
-    hardcoded move function for refernce and testing
- */
-bool game_move_ref(int dir)
+void test_moveAll()
 {
+    printf("[test_moveAll] ");
 
-    if(DEBUG_MOVE_REF && debug) printf("dir: %s\n", game_moveLabels[dir]);
-    if(DEBUG_MOVE_REF && debug) print_game();
+    game_moves_t moves;
+    char test[NUM_FIELDS + 1] = {0};
+    uint32_t rng = 1;
 
-    bool moved = false;
+    int numTests = (int) corpus_numMoves();
 
-    int coordinates[4][4];
-
-    if(dir == MV_LEFT)
-    {
-        coordinates[0][0] = 3;
-        coordinates[0][1] = 2;
-        coordinates[0][2] = 1;
-        coordinates[0][3] = 0;
-        coordinates[1][0] = 7;
-        coordinates[1][1] = 6;
-        coordinates[1][2] = 5;
-        coordinates[1][3] = 4;
-        coordinates[2][0] = 0xb;
-        coordinates[2][1] = 0xa;
-        coordinates[2][2] = 9;
-        coordinates[2][3] = 8;
-        coordinates[3][0] = 0xf;
-        coordinates[3][1] = 0xe;
-        coordinates[3][2] = 0xd;
-        coordinates[3][3] = 0xc;
-    }
-
-    if(dir == MV_RIGHT)
-    {
-        coordinates[0][0] = 0;
-        coordinates[0][1] = 1;
-        coordinates[0][2] = 2;
-        coordinates[0][3] = 3;
-        coordinates[1][0] = 4;
-        coordinates[1][1] = 5;
-        coordinates[1][2] = 6;
-        coordinates[1][3] = 7;
-        coordinates[2][0] = 8;
-        coordinates[2][1] = 9;
-        coordinates[2][2] = 0xa;
-        coordinates[2][3] = 0xb;
-        coordinates[3][0] = 0xc;
-        coordinates[3][1] = 0xd;
-        coordinates[3][2] = 0xe;
-        coordinates[3][3] = 0xf;
-    }
-
-    if(dir == MV_UP)
-    {
-        coordinates[0][0] = 0xc;
-        coordinates[0][1] = 8;
-        coordinates[0][2] = 4;
-        coordinates[0][3] = 0;
-        coordinates[1][0] = 0xd;
-        coordinates[1][1] = 9;
-        coordinates[1][2] = 5;
-        coordinates[1][3] = 1;
-        coordinates[2][0] = 0xe;
-        coordinates[2][1] = 0xa;
-        coordinates[2][2] = 6;
-        coordinates[2][3] = 2;
-        coordinates[3][0] = 0xf;
-        coordinates[3][1] = 0xb;
-        coordinates[3][2] = 7;
-        coordinates[3][3] = 3;
-    }
-
-    if(dir == MV_DOWN)
-    {
-        coordinates[0][0] = 0;
-        coordinates[0][1] = 4;
-        coordinates[0][2] = 8;
-        coordinates[0][3] = 0xc;
-        coordinates[1][0] = 1;
-        coordinates[1][1] = 5;
-        coordinates[1][2] = 9;
-        coordinates[1][3] = 0xd;
-        coordinates[2][0] = 2;
-        coordinates[2][1] = 6;
-        coordinates[2][2] = 0xa;
-        coordinates[2][3] = 0xe;
-        coordinates[3][0] = 3;
-        coordinates[3][1] = 7;
-        coordinates[3][2] = 0xb;
-        coordinates[3][3] = 0xf;
-    }
-
-    int convert[128] = {0};
-        convert[' '] = 0;
-        convert['1'] = 1;
-        convert['2'] = 2;
-        convert['3'] = 3;
-        convert['4'] = 4;
-        convert['5'] = 5;
-        convert['6'] = 6;
-        convert['7'] = 7;
-        convert['8'] = 8;
-        convert['9'] = 9;
-        convert['a'] = 10;
-        convert['b'] = 11;
-        convert['c'] = 12;
-        convert['d'] = 13;
-        convert['e'] = 14;
-        convert['f'] = 15;
-        convert['g'] = 16;
-        convert['h'] = 17;
-
-        // only for random searching
-        convert['x'] = 18;
-
-    for(int lane = 0; lane < 4; lane++)
-    {
-        int indexPos1 = coordinates[lane][0];
-        int indexPos2 = coordinates[lane][1];
-        int indexPos3 = coordinates[lane][2];
-        int indexPos4 = coordinates[lane][3];
-
-        assert(indexPos1 < 16);
-        assert(indexPos2 < 16);
-        assert(indexPos3 < 16);
-        assert(indexPos4 < 16);
-
-        int data[13] = {
-            0,
-            convert[(int) game_field[indexPos1]],
-            convert[(int) game_field[indexPos2]],
-            convert[(int) game_field[indexPos3]],
-            convert[(int) game_field[indexPos4]]
-        };
-
-        data[0xa] = data[1] + 1;
-        data[0xb] = data[2] + 1;
-        data[0xc] = data[3] + 1;
-
-        int value1 = moveRefLastValues[indexPos1] =                                                                                                    (data[1] == 0) ? 0 : 1;
-        int value2 = moveRefLastValues[indexPos2] =                                                                   (data[2] == data[1]) ? value1 : ((data[2] == 0) ? 0 : 2);
-        int value3 = moveRefLastValues[indexPos3] =                                 (data[3] == data[2])  ? value2 : ((data[3] == data[1]) ? value1 : ((data[3] == 0) ? 0 : 3));
-        int value4 = moveRefLastValues[indexPos4] =(data[4] == data[3]) ? value3 : ((data[4] == data[2])  ? value2 : ((data[4] == data[1]) ? value1 : ((data[4] == 0) ? 0 : 4)));
-
-        int value = (value4 << 12) | (value3 << 8) | (value2 << 4) | (value1 << 0);
-        int start = value; 
-
-        if(DEBUG_MOVE_REF && debug) printf("%04x (%2d %2d %2d %2d) ", value, data[1], data[2], data[3], data[4]);
-        if(DEBUG_MOVE_REF && debug) print_lane(lane, dir);
-        if(DEBUG_MOVE_REF && debug) printf(" --> ");
-
-        switch (value)
-        {
-            case 0x0000: 
-            case 0x0001: 
-            case 0x0021:
-            case 0x0121:  
-            case 0x0321:  
-            case 0x1321:   
-            case 0x2121:   
-            case 0x2321: 
-            case 0x4121:
-            case 0x4321:break;
-
-            case 0x0020: value = 0x0002; break;
-            case 0x0300: value = 0x0003; break;
-            case 0x4000: value = 0x0004; break;
-            case 0x1001: 
-            case 0x0101:
-            case 0x0011: value = 0x000a; break;
-            case 0x0220: 
-            case 0x2020: value = 0x000b; break;
-            case 0x3300: value = 0x000c; break;
-            case 0x1101:
-            case 0x1011: value = 0x001a; break;
-            case 0x0111: value = 0x001a; break;
-            case 0x2220: value = 0x002b; break;
-            case 0x0301: value = 0x0031; break;
-            case 0x0320: value = 0x0032; break;
-            case 0x0311: value = 0x003a; break;
-            case 0x4001: value = 0x0041; break;
-            case 0x4020: value = 0x0042; break;
-            case 0x4300: value = 0x0043; break;
-            case 0x4101: 
-            case 0x4011: value = 0x004a; break;
-            case 0x4220: value = 0x004b; break;
-            case 0x1111: value = 0x00aa; break;
-            case 0x2021: value = 0x00b1; break;
-            case 0x0221: value = 0x00b1; break;
-            case 0x3301: value = 0x00c1; break;
-            case 0x3320: value = 0x00c2; break;
-            case 0x3311: value = 0x00ca; break;
-            case 0x1021: value = 0x0121; break;
-            case 0x1301: value = 0x0131; break;
-            case 0x1311: value = 0x013a; break;
-            case 0x1221: value = 0x01b1; break;
-            case 0x2320: value = 0x0232; break;
-            case 0x2221: value = 0x02b1; break;
-            case 0x4111: value = 0x041a; break;
-            case 0x4021: value = 0x0421; break;
-            case 0x4301: value = 0x0431; break;
-            case 0x4320: value = 0x0432; break;
-            case 0x4311: value = 0x043a; break;
-            case 0x4221: value = 0x04b1; break;
-            case 0x1121: value = 0x0a21; break;
-            case 0x3321: value = 0x0c21; break;
-
-            default: printf("<%04x>\n", value); fflush(stdout); assert(0);
-        }
-
-        moved = moved || (start != value);
-
-        value1 = ((0xf <<  0) & value) >>  0;
-        value2 = ((0xf <<  4) & value) >>  4;
-        value3 = ((0xf <<  8) & value) >>  8;
-        value4 = ((0xf << 12) & value) >> 12;
-        
-        if(DEBUG_MOVE_REF && debug) printf("%04x (%2d %2d %2d %2d):(%2x %2x %2x %2x) ", value, data[value1], data[value2], data[value3], data[value4], 
-                                                                                    game_signs[data[value1]], game_signs[data[value2]], game_signs[data[value3]], game_signs[data[value4]]);
-        if(DEBUG_MOVE_REF && debug) print_lane(lane, dir);
-        if(DEBUG_MOVE_REF && debug) printf("\n");
+    for(int i = 0; i < numTests + 1000; i++)
+    {
+        if(i < numTests)
+        {
+            memcpy(test, corpus_move(i)->test, NUM_FIELDS);
+        }
+        else
+        {
+            uint8_t values[NUM_FIELDS];
+            batch_fillRandom(values, 1, 1, &rng);
+            game_valuesToField(values, 1, test);
+        }
 
+        game_moveAll(test, &moves);
 
-        assert(game_signs[data[value1]] > 0);
-        assert(game_signs[data[value2]] > 0);
-        assert(game_signs[data[value3]] > 0);
-        assert(game_signs[data[value4]] > 0);
+        for(int dir = 1; dir <= NUM_DIRS; dir++)
+        {
+            memcpy(game_field, test, NUM_FIELDS);
+            bool moved = game_move_ref(dir);
 
-        game_field[indexPos1] = game_signs[data[value1]];
-        game_field[indexPos2] = game_signs[data[value2]];
-        game_field[indexPos3] = game_signs[data[value3]];
-        game_field[indexPos4] = game_signs[data[value4]];
+            assert(moves.moved[dir] == moved);
+            assert(strncmp(moves.field[dir], game_field, NUM_FIELDS) == 0);
 
+            // leading zeros, the score is compared as a number
+            memcpy(game_field, test, NUM_FIELDS);
+            strncpy(game_score, "0000000", NUM_SCORE + 1);
+            game_move4(dir);
+            game_scoreRefresh();
+            assert(moves.score[dir] == (uint32_t) atol(game_score));
+        }
     }
 
-    if(DEBUG_MOVE_REF && debug) print_game();
+    // checkerboard, no tile can move
+    for(int i = 0; i < NUM_FIELDS; i++) game_field[i] = getSign(1 + (((i / NUM_FIELDW) + (i % NUM_FIELDW)) % 2));
+    assert(!canmove());
+    game_field[0] = getSign(0);
+    assert(canmove());
 
-    return moved;
+    strncpy(game_score, "      0", NUM_SCORE + 1);
+
+    printf("ok.\n");
 }
 
-bool game_move(int dir)
+void test_train()
 {
+    printf("[test_train] ");
 
-    /*
-        ref
-     */
-    if(MOVE_ALGO == 0) return game_move_ref(dir);
+    static train_t train;
+    assert(train_open(&train, ""));
 
-    /*
-        Iterations: 11120
-        Steps: 1053
-    */
-    if(MOVE_ALGO == 4) return game_move4(dir);
+    // every field is part of two lanes and up to four squares
+    int numUsed[NUM_FIELDS] = {0};
+    for(int t = 0; t < TRAIN_NUM_TUPLES; t++)
+    {
+        for(int i = 0; i < train.tuples[t].size; i++) numUsed[train.tuples[t].field[i]]++;
+    }
+    for(int i = 0; i < NUM_FIELDS; i++) assert(numUsed[i] >= 3);
 
-    /*
-        Iterations: 11120
-        Steps: 1053
-    */
-    if(MOVE_ALGO == 3) return game_move3(dir);
+    uint8_t values[NUM_FIELDS];
+    for(int i = 0; i < NUM_FIELDS; i++) values[i] = (uint8_t) (i % (NUM_SIGNS + 1));
 
-    /*
-        Iterations: 11120
-        Steps: 1296
-    */
-    if(MOVE_ALGO == 2) return game_move2(dir);
+    assert(train_value(&train, values) == 0);
+    train_update(&train, values, 0.5f);
+    assert(train_value(&train, values) == 0.5f * TRAIN_NUM_TUPLES);
 
-    /*
-        Iterations: 12674
-        Steps: 972
-    */
-    if(MOVE_ALGO == 1) return game_move1(dir);
+    // a single game learns something and ends on a full board
+    uint32_t rng = RNG_SEED, score;
+    long numMoves;
+    int maxTile = train_game(&train, &rng, &score, &numMoves, true, NULL, NULL);
+    assert(maxTile >= 3);
+    assert(numMoves > 0);
+    assert(score > 0);
 
-    assert(false);
+    // playing visits every move, checks it with game_move and does not learn
+    static play_game_t game;
+    float value = train_value(&train, values);
+
+    memset(&game, 0, sizeof(game));
+    maxTile = train_game(&train, &rng, &score, &numMoves, false, play_visit, &game);
+    assert(game.maxTile == maxTile);
+    assert(game.numErrors == 0);
+    assert(train_value(&train, values) == value);
+
+    // a board with a new highest tile from PLAY_MIN_TILE gives a case per direction
+    game_moves_t moves;
+    char field[NUM_FIELDS + 1];
+
+    memset(field, getSign(0), NUM_FIELDS);
+    field[NUM_FIELDS] = '\0';
+    field[0] = field[1] = getSign(PLAY_MIN_TILE - 1);
+    game_moveAll(field, &moves);
+
+    memset(&game, 0, sizeof(game));
+    play_visit(field, MV_LEFT, &moves, &game);
+    assert(game.maxTile == PLAY_MIN_TILE && game.numCases == NUM_DIRS && game.numErrors == 0);
+    assert(game.cases[MV_LEFT - 1].dir == MV_LEFT && memchr(game.cases[MV_LEFT - 1].result, getSign(PLAY_MIN_TILE), NUM_FIELDS));
+
+    play_visit(field, MV_LEFT, &moves, &game);
+    assert(game.numCases == NUM_DIRS);
+
+    train_close(&train);
+
+    printf("ok.\n");
 }
 
-bool canmove()
+void test_spawn_tetrisrng()
 {
-    /* TODO */
-    return true;
-}
+    printf("[test_spawn_tetrisrng] ");
 
+    uint64_t steps[] = { 0, 1, 2, 15, 16, 17, 1000, 32767, 65535, 65536, 100000 };
+    uint16_t saved = game_rng_value;
 
-/* === SHARED TEST CASES ==== */
+    for(size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        game_rng_value = RNG_SEED;
+        for(uint64_t step = 0; step < steps[i]; step++) spawn_tetrisrng();
 
-struct test_fields_t
-{
-    char test[NUM_FIELDS + 1];
-    move_direction_t dir;
-    char result[NUM_FIELDS + 1];
-    bool moved;
-};
+        assert(rng_jump(RNG_SEED, steps[i]) == game_rng_value);
+    }
 
-struct test_fields_t test_fields[] = {
-    {"                ", MV_LEFT,  "                ", false},
-    {"                ", MV_RIGHT, "                ", false},
-    {"                ", MV_UP,    "                ", false},
-    {"                ", MV_DOWN,  "                ", false},
-    {"123456789abcdefg", MV_LEFT,  "123456789abcdefg", false},
-    {"123456789abcdefg", MV_RIGHT, "123456789abcdefg", false},
-    {"123456789abcdefg", MV_UP,    "123456789abcdefg", false},
-    {"123456789abcdefg", MV_DOWN,  "123456789abcdefg", false},
-    
-    // move #8
-    {"     1          ", MV_LEFT,  "       1        ", true},
-    {"     1          ", MV_RIGHT, "    1           ", true},
-    {"     1          ", MV_UP,    "             1  ", true},
-    {"     1          ", MV_DOWN,  " 1              ", true},
+    rng_analysis_t analysis = rng_analyze();
+    assert(rng_jump(RNG_SEED, (uint64_t) analysis.tailLength + (uint64_t) analysis.cycleLength) == rng_jump(RNG_SEED, (uint64_t) analysis.tailLength));
 
-    // merge 0 #12
-    {" 11             ", MV_LEFT,  "   2            ", true},
-    {" 11             ", MV_RIGHT, "2               ", true},
-    {"     1   1      ", MV_UP,    "             2  ", true},
-    {"     1   1      ", MV_DOWN,  " 2              ", true},
+    assert(rng_sequenceLength() == analysis.tailLength + analysis.cycleLength);
 
-    // move with gap 1 #16
-    {"    1 2         ", MV_LEFT,  "      12        ", true},
-    {"     1 2        ", MV_RIGHT, "    12          ", true},
-    {" 1       2      ", MV_UP,    "         1   2  ", true},
-    {"     1       2  ", MV_DOWN,  " 1   2          ", true},
+    // stream k starts at k * length and no value is in two streams
+    int numStreams = 4;
+    uint64_t streamLength = (uint64_t) rng_sequenceLength() / (uint64_t) numStreams;
+    uint8_t *seen = calloc(1 << 16, 1);
+    assert(seen);
 
-    // merge with gap 1 #20
-    {"    2 2         ", MV_LEFT,  "       3        ", true},
-    {"     2 2        ", MV_RIGHT, "    3           ", true},
-    {" 2       2      ", MV_UP,    "             3  ", true},
-    {"     2       2  ", MV_DOWN,  " 3              ", true},
+    game_rng_value = RNG_SEED;
+    for(int k = 0; k < numStreams; k++)
+    {
+        uint16_t start = game_rng_value;
 
-    // move with gap 2 #24
-    {"    2  2        ", MV_LEFT,  "       3        ", true},
-    {"    2  2        ", MV_RIGHT, "    3           ", true},
-    {"  1           2 ", MV_UP,    "          1   2 ", true},
-    {"  1           2 ", MV_DOWN,  "  1   2         ", true},
+        spawn_tetrisrng_stream(k, numStreams);
+        assert(game_rng_value == start);
+        assert(game_rng_value == rng_jump(RNG_SEED, (uint64_t) k * streamLength));
 
-    // merge with gap 2 #28
-    {"    2  2        ", MV_LEFT,  "       3        ", true},
-    {"    2  2        ", MV_RIGHT, "    3           ", true},
-    {"  2           2 ", MV_UP,    "              3 ", true},
-    {"  2           2 ", MV_DOWN,  "  3             ", true},
+        for(uint64_t step = 0; step < streamLength; step++)
+        {
+            assert(!seen[game_rng_value]);
+            seen[game_rng_value] = 1;
+            spawn_tetrisrng();
+        }
+    }
 
-    // combined test #32
-    {"3311            ", MV_LEFT,  "  42            ", true},
-    {"3311            ", MV_RIGHT, "42              ", true},
-    {"3   3   1   1   ", MV_UP,    "        4   2   ", true},
-    {"3   3   1   1   ", MV_DOWN,  "4   2           ", true},
+    free(seen);
 
-    // multi merge #36
-    {"1111            ", MV_LEFT,  "  22            ", true},
-    {"1111            ", MV_RIGHT, "22              ", true},
-    {"1   1   1   1   ", MV_UP,    "        2   2   ", true},
-    {"1   1   1   1   ", MV_DOWN,  "2   2           ", true},
+    game_rng_value = saved;
 
-    // shift
-    {"121             ", MV_LEFT,  " 121            ", true},
-    {" 121            ", MV_RIGHT, "121             ", true},
-    {"1   2   1       ", MV_UP,    "    1   2   1   ", true},
-    {"    1   2   1   ", MV_DOWN,  "1   2   1       ", true},
+    printf("ok.\n");
+}
 
-    //shift and merge
-    {"111             ", MV_LEFT,  "  12            ", true},
-    {"111             ", MV_RIGHT, "21              ", true},
-    {"1   1   1       ", MV_UP,    "        1   2   ", true},
-    {"    1   1   1   ", MV_DOWN,  "2   1           ", true},
+typedef uint8_t (*test_addScore_t)(int value);
 
-    //edge cases *pun intended*
-    {"1231123112311231", MV_LEFT,  "1231123112311231", false},
-    {"1231123112311231", MV_RIGHT, "1231123112311231", false},
-    {"1111222233331111", MV_UP,    "1111222233331111", false},
-    {"1111222233331111", MV_DOWN,  "1111222233331111", false},
+typedef struct test_runner_st
+{
+    _Atomic uint8_t *runs;        // quiet runs of every case
+    _Atomic uint8_t *verbose;     // verbose runs of every case
+} test_runner_t;
 
+/*
+    every 1000th case fails, the verbose run sees debug set
+*/
+static bool test_runnerCase(size_t index, void *context, runner_counts_t *counts)
+{
+    test_runner_t *t = context;
 
-    // variants
-    {"7 4efe722284g2a ", MV_LEFT,  " 74efe72 384 g2a", true }, // 4021432133214320
-    {"7 4efe722284g2a ", MV_RIGHT, "74e fe72384 g2a ", true }, // 1034123411341230
-    {"c2a7gf7  g2ggdgh", MV_UP,    " 2a  f77cg2ghdgh", true }, // 4444133002221111
-    {"2fge5815d 6e 9gc", MV_DOWN,  "2fge5815d96e  gc", true }, // 1111222230310414
-    {"b2 9h6e57gg1f3b ", MV_LEFT,  " b29h6e5 7h1 f3b", true }, // 4301432142214320
-    {"d257b6bh5fc299 d", MV_RIGHT, "d257b6bh5fc2ad  ", true }, // 1234121412341104
-    {"h9b6dg6d133c39f9", MV_RIGHT, "h9b6dg6d14c 39f9", true }, // 1234123112241232
-    {"chdg3 1a8f 49f29", MV_DOWN , "chdg3g1a8 249  9", true }, // 1111202233034344
-    {" g2 21d7b3af87g2", MV_LEFT , "  g221d7b3af87g2", true }, // 0320432143214321
-    {"49g79hfgfd 6b f9", MV_DOWN , "49g79hggfd 6b  9", true }, // 1111222233034024
-    {"6 16e4 bhh2hgag ", MV_LEFT , " 616 e4b x2h gag", true }, // 1021430111212320
-    {"6 16e4 bhh2hgag ", MV_RIGHT, "616 e4b x2h gag ", true }, // 1031120411311210
-    {"fb d629f435fcc6d", MV_UP   , "fb  629d435gcc6d", true }, // 4401333222221111
-    {"8 2c aa3bf 374h7", MV_LEFT , " 82c  b3 bf374h7", true }, // 4021022143011321
-    {"8 2c aa3bf 374h7", MV_RIGHT, "82c b3  bf3 74h7", true }, // 1034022412041231
-    {"94f25cd21dcbach ", MV_UP   , "94f 5cd 1dc3achb", true }, // 4443313322221110
-    {"94f25cd21dcbach ", MV_DOWN , "94f35cdb1dc ach ", true }, // 1111222133334240
-    {"bbb1g38defahb4b4", MV_LEFT , " bc1g38defahb4b4", true }, // 2221432143212121
-    {"bbb1g38defahb4b4", MV_RIGHT, "cb1 g38defahb4b4", true }, // 1114123412341212
-    {"gg g 997c eae9g5", MV_LEFT , "  gh  a7 ceae9g5", true }, // 1101022140214321
-    {"gg g 997c eae9g5", MV_RIGHT, "hg  a7  cea e9g5", true }, // 1101022410341234
-    {"  7e96f78e1d b31", MV_LEFT , "  7e96f78e1d b31", false}, // 0021432143210321
-    {"  7e96f78e1d b31", MV_RIGHT, "7e  96f78e1db31 ", true }, // 0034123412340234
-    {"7 98efg65 f5668 ", MV_UP   , "7 9 e g85ff66685", true }, // 4044333320221110
-    {" 2 2g4h23e7 e c1", MV_LEFT , "   3g4h2 3e7 ec1", true }, // 0101432143204021
-    {"7198b4dbgecc   e", MV_LEFT , "7198b4db ged   e", true }, // 4321132143110001
-    {"7198b4dbgecc   e", MV_RIGHT, "7198b4dbged e   ", true }, // 1234123112330004
-    {"6bb 6 dd d73 369", MV_UP   , "  b  bdd d737369", true }, // 3440303302220111
-    {"6bb 6 dd d73 369", MV_DOWN , "7bbd dd3 379  6 ", true }, // 1110102203330444
-};
+    if(debug)
+    {
+        atomic_fetch_add(&t->verbose[index], 1);
+        return false;
+    }
 
-struct test_score_t
+    atomic_fetch_add(&t->runs[index], 1);
+    counts->numIterations += 1;
+    counts->numSteps += (long) (index & 1);
+
+    return index % 1000 != 7;
+}
+
+void test_runner()
 {
-    char test[NUM_SCORE+ 1];
-    int addScore;
-    char result[NUM_SCORE + 1];
-    char resultWithDecSep[NUM_SCORE_WITH_DECSEP + 1];
-};
+    printf("[test_runner] ");
 
-struct test_score_t test_scores[] = {
-    {"      0",  2, "      4", "        4"},
-    {"     12",  2, "     16", "       16"},
-    {"     16",  4, "     32", "       32"},
-    {"     32",  5, "     64", "       64"},
-    {"     64",  6, "    128", "      128"},
-    {"    128",  7, "    256", "      256"},
-    {"    256",  8, "    512", "      512"},
-    {"    512",  9, "   1024", "    1.024"},
-    {"   1024", 10, "   2048", "    2.048"},
-    {"   2048", 11, "   4096", "    4.096"},
-    {"   4096", 12, "   8192", "    8.192"},
-    {"   8192", 13, "  16384", "   16.384"},
-    {"  16384", 14, "  32768", "   32.768"},
-    {"  32768", 15, "  65536", "   65.536"},
-    {"  65536", 16, " 131072", "  131.072"},
-    {" 131072", 17, " 262144", "  262.144"},
-    {"3801028", 17, "3932100", "3.932.100"},
-    {"3932100",  2, "3932104", "3.932.104"},
-    {"3932100", 17, "4063172", "4.063.172"},
-    {"9999996",  2, "0000000", "0.000.000"},
-};
+    // stealing halves the largest other range
+    runner_t r = { .numThreads = 3 };
+    size_t index;
 
+    atomic_init(&r.ranges[0], runner_pack(0, 0));
+    atomic_init(&r.ranges[1], runner_pack(10, 20));
+    atomic_init(&r.ranges[2], runner_pack(20, 100));
 
-/* === VARIANT SEARCH ==== */
+    assert(!runner_pop(&r, 0, &index));
+    assert(runner_steal(&r, 0));
+    assert(atomic_load(&r.ranges[2]) == runner_pack(20, 60) && atomic_load(&r.ranges[0]) == runner_pack(60, 100));
+    assert(runner_pop(&r, 0, &index) && index == 60);
 
-bool updateVariant(variant_store_t *variants, int lane, int dir)
-{    
-    bool *v = &(variants->v[moveRefLastValues[ computeIndex(lane, 0, dir)]]\
-                           [moveRefLastValues[ computeIndex(lane, 1, dir)]]\
-                           [moveRefLastValues[ computeIndex(lane, 2, dir)]]\
-                           [moveRefLastValues[ computeIndex(lane, 3, dir)]]);
+    // every case runs exactly once on many workers, failures run again verbose
+    size_t numCases = 1000000;
+    test_runner_t t = { calloc(numCases, 1), calloc(numCases, 1) };
+    assert(t.runs && t.verbose);
 
-    if(!*v)
+    // the verbose runs print their case number
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    assert(saved >= 0 && null >= 0);
+    dup2(null, STDOUT_FILENO);
+
+    runner_result_t result = runner_runWith(test_runnerCase, &t, numCases, 8);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(null);
+
+    for(size_t i = 0; i < numCases; i++)
     {
-        *v = true;
-        variants->num++;
-        return true;
+        assert(t.runs[i] == 1);
+        assert(t.verbose[i] == (i % 1000 == 7));
     }
 
-    return false;
+    assert(result.numCases == numCases && result.numFailed == numCases / 1000);
+    assert(result.numIterations == (long) numCases && result.numSteps == (long) numCases / 2);
+
+    // no cases
+    result = runner_runWith(test_runnerCase, &t, 0, 8);
+    assert(result.numFailed == 0 && result.numIterations == 0);
+
+    free(t.runs);
+    free(t.verbose);
+
+    printf("ok.\n");
 }
 
-variant_store_t* validate_move_tests(variant_store_t *variants)
+static bool test_scoreCase(size_t i, void *context, runner_counts_t *counts)
 {
-    int numTests = sizeof(test_fields)/sizeof(test_fields[0]);
-    for(int i = 0; i < numTests; i++)
-    {
-        int dir = test_fields[i].dir;
-        strncpy(game_field, test_fields[i].test, NUM_FIELDS); 
-        game_move_ref(dir);
+    (void) counts;
 
-        for(int lane = 0; lane < NUM_FIELDW; lane++)
+    test_addScore_t addScore = *(test_addScore_t *) context;
+    char resultWithDecSep[NUM_SCORE_WITH_DECSEP + 1] = "         ";
+
+    memcpy(game_score, corpus_score(i)->test, NUM_SCORE);
+
+    uint8_t decSep = addScore(corpus_score(i)->addScore);
+    game_scoreRefresh();
+
+    for(int pos = (NUM_SCORE - 1), j = (NUM_SCORE_WITH_DECSEP - 1); pos >= 0; pos--, j--) 
+    { 
+        if(decSep & (1 << NUM_SCORE - pos - 1))
         {
-           updateVariant(variants, lane, dir);
+            resultWithDecSep[j--] = '.';
         }
+
+        if(pos <= NUM_SCORE) resultWithDecSep[j] = game_score[pos];             
     }
 
-    return variants;
+    if(debug) printf("'%s' + %2d(%6d):  '%s' ('%s') [", corpus_score(i)->test, corpus_score(i)->addScore, 1 << corpus_score(i)->addScore, corpus_score(i)->result, game_score);
+    if(debug) printBits(sizeof(uint8_t), &decSep);
+    if(debug) printf("] -> '%s' ('%s')\n", corpus_score(i)->resultWithDecSep, resultWithDecSep);
+    
+    bool testScore  = (strncmp(game_score,       corpus_score(i)->result,           NUM_SCORE) == 0);
+    bool testDecSep = (strncmp(resultWithDecSep, corpus_score(i)->resultWithDecSep, NUM_SCORE_WITH_DECSEP) == 0);
+
+    return testScore && testDecSep;
 }
 
-void printLastVariante()
+void test_scoreWith(test_addScore_t addScore)
 {
-    for(int i = 0; i < NUM_FIELDS; i++)
-    {
-        printf("%x", moveRefLastValues[i]);
-    }
+    int numTests = (int) corpus_numScores();
+    runner_result_t result = runner_run(test_scoreCase, &addScore, numTests);
+
+    assert(result.numFailed == 0);
 }
 
-void search_variants_rnd(size_t limit)
-{
-    printf("\n=== search_variants_rnd ===\n");
+void test_score()
+{
+    TRACE_SCOPE("test_score");
+
+    printf("[test_score] ");
+
+    test_scoreWith(game_addScore);
+    test_scoreWith(game_addScore2);
 
-    printf("\n Limit: %lu", limit);
-    printf("\n Known Variants: %d\n\n", testVariants.num);
+    // v2 adds in the register and converts once when the display is refreshed
+    game_reset();
+    long convertCycles = game_scoreConvertCycles;
 
-    int newVariants = 0;
-    char test[NUM_FIELDS + 1]   = "                ";
+    for(int value = 1; value <= 3; value++) game_addScore2(value);
+    assert(game_scoreBinary == 14 && game_scoreConvertCycles == convertCycles);
+    assert(strcmp(game_score, "      0") == 0);
 
-    srand((unsigned int) time(NULL));
+    game_scoreRefresh();
+    game_scoreRefresh();
+    assert(strcmp(game_score, "     14") == 0 && game_scoreConvertCycles == convertCycles + SCORE_CONVERT_CYCLES);
 
-    for(size_t i = 0; i < limit; i++)
-    {
-        for(int j = 0; j < NUM_FIELDS; j++)
-        {
-            test[j] = game_signs[(rand() % NUM_SIGNS)];
-        }
+    // a score written from outside is loaded, the wrap around is kept in the flag
+    memcpy(game_score, "9999999", NUM_SCORE + 1);
+    game_addScore2(4);
+    game_scoreRefresh();
+    assert(game_scoreBinary == 15 && game_scoreWrapped && strcmp(game_score, "0000015") == 0);
+    game_reset();
 
-        for(int dir = 1; dir <= NUM_DIRS; dir++)
+    // v2 equals the reference for all tiles on a range of scores
+    for(int score = 0; score < 20000; score += 7)
+    {
+        for(int value = 1; value <= NUM_SIGNS; value++)
         {
-            strncpy(game_field, test, NUM_FIELDS);
-            bool moved = game_move_ref(dir);
-
-            bool newVariantFound = false;
+            char test[NUM_SCORE + 1], result[NUM_SCORE + 1];
+            int  start = (score * 499) % SCORE_MODULO;
 
-            for(int lane = 0; lane < NUM_FIELDW; lane++)
-            {
-                if(updateVariant(&testVariants, lane, dir))
-                {
-                    newVariantFound = true;
-                }
-            }
+            snprintf(test, sizeof(test), start >= 1000000 ? "%07d" : "%7d", start);
 
-            if(newVariantFound || DEBUG_SEARCH)
-            {
-                newVariants++;
+            memcpy(game_score, test, NUM_SCORE + 1);
+            uint8_t decSep = game_addScore2(value);
+            game_scoreRefresh();
+            memcpy(result, game_score, NUM_SCORE + 1);
 
-                printf(" {\"%s\", %s, \"%s\", %s}, // (", test, game_moveNames[dir], game_field, moved ? "true " : "false");
-                printLastVariante();
-                printf(")");
-                if(DEBUG_SEARCH && newVariantFound) printf(" (new)");
-                printf("\n");
-            }
+            memcpy(game_score, test, NUM_SCORE + 1);
+            assert(game_addScore_ref(value) == decSep);
+            assert(strncmp(result, game_score, NUM_SCORE) == 0);
         }
     }
 
-    printf("\n New Variants: %d", newVariants);
-
-    printf("\n");    
+    printf("ok.\n");
 }
 
-
-/* === DEBUG FUNCTIONS ==== */
-
-void debug_spawn_tetrisrng()
+void test_lib()
 {
-    printf("\n=== debug_spawn_tetrisrng ===\n\n");
+    printf("[test_lib] ");
 
-    for(int i = 0; i < 16; i++)
-    {
-        printf(" ");
-        printBits(sizeof(uint16_t), &game_rng_value); printf(" %04x\n", game_rng_value);
-        spawn_tetrisrng();
-    }
-}
+    char field[NUM_FIELDS + 1], score[NUM_SCORE + 1], expected[NUM_SCORE + 1];
+    emu_counters_t counters;
 
-void debug_computeIndex()
-{
-    printf("\n=== debug_computeIndex ===\n");
+    assert(emu_version() == EMU_API_VERSION);
+    assert(emu_numFieldW() == NUM_FIELDW && emu_numFields() == NUM_FIELDS && emu_numScore() == NUM_SCORE);
 
-    for(int dir = 1; dir <= 4; dir++)
+    // every algorithm gives the corpus results through the api
+    int numTests = (int) corpus_numMoves();
+    for(int algo = 0; algo <= 4; algo++)
     {
-        printf("\n direction: %s (%d)\n", game_moveLabels[dir], dir);
-
-        for(int lane = 0; lane < NUM_FIELDW; lane++)
+        for(int i = 0; i < numTests; i++)
         {
-            for(int pos = 0; pos < NUM_FIELDW; pos++)
-            {
-                printf(" %d.%d (%2d)  ", lane, pos, computeIndex(lane, pos, dir));
-            } 
-            printf("\n");
+            emu_reset();
+            assert(emu_load(corpus_move(i)->test, NULL));
+            assert(emu_move(corpus_move(i)->dir, algo) == corpus_move(i)->moved);
+
+            // like the emulator, only a move which changed the board is the last move
+            assert(game_lastMove == (corpus_move(i)->moved ? corpus_move(i)->dir : 0));
+
+            emu_getField(field);
+            assert(memcmp(field, corpus_move(i)->result, NUM_FIELDS) == 0 && field[NUM_FIELDS] == '\0');
         }
     }
+
+    // invalid input is rejected
+    memset(field, '?', NUM_FIELDS);
+    field[NUM_FIELDS] = '\0';
+    assert(!emu_load(field, NULL));
+    assert(!emu_move(0, 0) && !emu_move(NUM_DIRS + 1, 0));
+
+    // score
+    memset(field, getSign(0), NUM_FIELDS);
+    snprintf(score, sizeof(score), "%*d", NUM_SCORE, 100);
+    snprintf(expected, sizeof(expected), "%*d", NUM_SCORE, 108);
+    emu_reset();
+    assert(emu_load(field, score));
+    emu_addScore(3);
+    emu_getScore(score);
+    assert(strcmp(score, expected) == 0);
+
+    // spawn and counters
+    assert(emu_spawn(NUM_FIELDW, 1));
+    assert(!emu_spawn(NUM_FIELDW, 1) && !emu_spawn(NUM_FIELDS, 1) && !emu_spawn(0, NUM_SIGNS));
+    assert(emu_canMove());
+
+    emu_setRng(RNG_SEED);
+    uint16_t rng = emu_spawnStep();
+    emu_getCounters(&counters);
+    assert(counters.rng == rng && rng != RNG_SEED && counters.lastSpawn == NUM_FIELDW);
+
+    emu_move(1, 4);
+    emu_getCounters(&counters);
+    assert(counters.numIterations > 0);
+    emu_resetCounters();
+    emu_getCounters(&counters);
+    assert(counters.numIterations == 0 && counters.numSteps == 0);
+
+    // display
+    uint8_t digits[DISPLAY_NUM_DIGITS];
+    display_frame_t frame;
+    assert(emu_getDisplay(digits, DISPLAY_NUM_DIGITS) == DISPLAY_NUM_DIGITS);
+    display_encode(&frame, counters.decSep);
+    assert(memcmp(digits, frame.digit, DISPLAY_NUM_DIGITS) == 0);
+
+    emu_reset();
+
+    printf("ok.\n");
 }
 
-void debug_move()
+static bool test_moveCase(size_t i, void *context, runner_counts_t *counts)
 {
+    (void) context;
 
-    printf("\n=== debug_move ===\n");
-
-    char result[NUM_FIELDS + 1] = "                ";
+    memcpy(game_field, corpus_move(i)->test, NUM_FIELDS);
 
-    debug = 0;
+    if(debug) printf("=== %zu === \n", i);
+    if(debug) printf("\n"); 
+    if(debug) print_game();
 
-    int interationsTotal = 0;
-    int stepsTotal = 0;
+    bool moved = game_move(corpus_move(i)->dir);
+    
+    if(debug) printf("\n"); 
+    if(debug) print_game();
+    if(debug) printf("'%s' %s '%s' (%s): '%s' (%s) [%3d][%2d]\n", corpus_move(i)->test, game_moveLabels[corpus_move(i)->dir], corpus_move(i)->result, corpus_move(i)->moved ? "true " : "false", game_field, moved ? "true " : "false", game_numIterations, game_numSteps);
 
-    printf("\n [ #] ✥ field             variant             St Itr\n");
+    counts->numIterations += game_numIterations;
+    counts->numSteps += game_numSteps;
 
-    int numTests = sizeof(test_fields)/sizeof(test_fields[0]);
-    for(int i = 0; i < numTests; i++)
-    {
-        strncpy(game_field, test_fields[i].test, NUM_FIELDS); 
-        
-        if(debug) printf("\n");
-        if(debug) printf("[%d] setup (%s) '%s'\n", i, game_moveLabels[test_fields[i].dir], game_field);
-        if(debug) print_game();
+    bool testMoved = (corpus_move(i)->moved == moved);
+    bool testField = (strncmp(game_field, corpus_move(i)->result, NUM_FIELDS) == 0);
 
-        int moved1 = game_move_ref(test_fields[i].dir);
-        strncpy(result, game_field, NUM_FIELDS);
-        strncpy(game_field, test_fields[i].test, NUM_FIELDS);
+    return testMoved && testField;
+}
 
-        if(debug) printf("[%d] mov Ref : %d, '%s'\n", i, moved1, result);
-        if(debug) print_game();
+void test_move()
+{
+    TRACE_SCOPE("test_move");
 
-        game_fieldIndex = 0;
-        game_numIterations = 0;
-        game_numSteps = 0;
-        int moved2 = game_move(test_fields[i].dir);
-        interationsTotal += game_numIterations;
-        stepsTotal += game_numSteps;
+    printf("[test_move] ");
 
-        if(debug) printf("[%d] test      %s  '%s'\n", i, game_moveLabels[test_fields[i].dir], game_field);
-        if(debug) print_game();
+    int numTests = (int) corpus_numMoves();
+    runner_result_t result = runner_run(test_moveCase, NULL, numTests);
 
-        bool testMoved = (moved1 == moved2);
-        bool testField = (strncmp(result, game_field, NUM_FIELDS) == 0);
+    assert(result.numFailed == 0);
 
-        if(debug) printf("[%d] test    : %s  '%s'\n", i, game_moveLabels[test_fields[i].dir], game_field);
-        if(debug) printf("[%d] mov Ref : %d, '%s'\n", i, moved1, result);
-        if(debug) printf("[%d] mov Test: %d, '%s'\n", i, moved2, game_field);
-        if(debug) printf("\n");
+    printf("ok.\n");
+}
 
-        printf(" [%2d] %s '%s'(", i, game_moveLabels[test_fields[i].dir],  test_fields[i].test);
-        printLastVariante();
-        printf("): %2d %3d\n", game_numSteps, game_numIterations);
 
-        if(!debug && (!testMoved || !testField))
-        {
-            i--;
-            debug = true;
-            continue;
-        }
 
-        assert(testMoved);   
-        assert(testField);   
-    }
+/* === LIBRARY FUNCTIONS ==== */
 
-    int numVariants = validate_move_tests(&testVariants)->num;
+/*
+    implementation of emu.h, the state is the state of the calling thread
+*/
 
-    printf("\n");
-    printf(" NumTests: %d\n", numTests);
-    printf(" Variants: %d\n", numVariants);
-    printf(" Iterations: %d\n", interationsTotal);
-    printf(" Steps: %d\n", stepsTotal);
+int emu_version(void)
+{
+    return EMU_API_VERSION;
 }
 
+int emu_numFieldW(void)
+{
+    return NUM_FIELDW;
+}
 
-/* === TEST FUNCTIONS ==== */
+int emu_numFields(void)
+{
+    return NUM_FIELDS;
+}
 
-void test_computeIndex()
+int emu_numScore(void)
 {
-    printf("[test_computeIndex] ");
+    return NUM_SCORE;
+}
 
-    strncpy(game_field, "123456789abcdefg", NUM_FIELDS+1);
+void emu_reset(void)
+{
+    game_reset();
+    game_rng_value = RNG_SEED;
+    game_scoreDecSep = 0;
+    game_lastSpawn = 0;
+}
 
-    /*
-    ╔═══╦═══╦═══╦═══╗
-    ║ g ║ f ║ e ║ d ║
-    ╟───╫───╫───╫───╢
-    ║ c ║ b ║ a ║ 9 ║
-    ╟───╫───╫───╫───╢
-    ║ 8 ║ 7 ║ 6 ║ 5 ║
-    ╟───╫───╫───╫───╢
-    ║ 4 ║ 3 ║ 2 ║ 1 ║
-    ╚═══╩═══╩═══╩═══╝
+bool emu_load(const char *field, const char *score)
+{
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        if(field[i] == '\0' || getSign(getSignValue(field[i])) != field[i]) return false;
+    }
 
-    */
+    for(int i = 0; score && i < NUM_SCORE; i++)
+    {
+        if(score[i] != ' ' && !isdigit((unsigned char) score[i])) return false;
+    }
 
-    assert(game_field[computeIndex(0, 0, MV_LEFT)] == '4');
-    assert(game_field[computeIndex(0, 1, MV_LEFT)] == '3');
-    assert(game_field[computeIndex(0, 2, MV_LEFT)] == '2');
-    assert(game_field[computeIndex(0, 3, MV_LEFT)] == '1');
-    assert(game_field[computeIndex(1, 0, MV_LEFT)] == '8');
-    assert(game_field[computeIndex(1, 1, MV_LEFT)] == '7');
-    assert(game_field[computeIndex(1, 2, MV_LEFT)] == '6');
-    assert(game_field[computeIndex(1, 3, MV_LEFT)] == '5');
-    assert(game_field[computeIndex(2, 0, MV_LEFT)] == 'c');
-    assert(game_field[computeIndex(2, 1, MV_LEFT)] == 'b');
-    assert(game_field[computeIndex(2, 2, MV_LEFT)] == 'a');
-    assert(game_field[computeIndex(2, 3, MV_LEFT)] == '9');
-    assert(game_field[computeIndex(3, 0, MV_LEFT)] == 'g');
-    assert(game_field[computeIndex(3, 1, MV_LEFT)] == 'f');
-    assert(game_field[computeIndex(3, 2, MV_LEFT)] == 'e');
-    assert(game_field[computeIndex(3, 3, MV_LEFT)] == 'd');
+    memcpy(game_field, field, NUM_FIELDS);
+    game_field[NUM_FIELDS] = '\0';
 
-    assert(game_field[computeIndex(0, 0, MV_RIGHT)] == '1');
-    assert(game_field[computeIndex(0, 1, MV_RIGHT)] == '2');
-    assert(game_field[computeIndex(0, 2, MV_RIGHT)] == '3');
-    assert(game_field[computeIndex(0, 3, MV_RIGHT)] == '4');
-    assert(game_field[computeIndex(1, 0, MV_RIGHT)] == '5');
-    assert(game_field[computeIndex(1, 1, MV_RIGHT)] == '6');
-    assert(game_field[computeIndex(1, 2, MV_RIGHT)] == '7');
-    assert(game_field[computeIndex(1, 3, MV_RIGHT)] == '8');
-    assert(game_field[computeIndex(2, 0, MV_RIGHT)] == '9');
-    assert(game_field[computeIndex(2, 1, MV_RIGHT)] == 'a');
-    assert(game_field[computeIndex(2, 2, MV_RIGHT)] == 'b');
-    assert(game_field[computeIndex(2, 3, MV_RIGHT)] == 'c');
-    assert(game_field[computeIndex(3, 0, MV_RIGHT)] == 'd');
-    assert(game_field[computeIndex(3, 1, MV_RIGHT)] == 'e');
-    assert(game_field[computeIndex(3, 2, MV_RIGHT)] == 'f');
-    assert(game_field[computeIndex(3, 3, MV_RIGHT)] == 'g');
+    if(score) 
+    {
+        memcpy(game_score, score, NUM_SCORE);
+        game_score[NUM_SCORE] = '\0';
+    }
 
-    assert(game_field[computeIndex(0, 0, MV_UP)] == 'd');
-    assert(game_field[computeIndex(0, 1, MV_UP)] == '9');
-    assert(game_field[computeIndex(0, 2, MV_UP)] == '5');
-    assert(game_field[computeIndex(0, 3, MV_UP)] == '1');
-    assert(game_field[computeIndex(1, 0, MV_UP)] == 'e');
-    assert(game_field[computeIndex(1, 1, MV_UP)] == 'a');
-    assert(game_field[computeIndex(1, 2, MV_UP)] == '6');
-    assert(game_field[computeIndex(1, 3, MV_UP)] == '2');
-    assert(game_field[computeIndex(2, 0, MV_UP)] == 'f');
-    assert(game_field[computeIndex(2, 1, MV_UP)] == 'b');
-    assert(game_field[computeIndex(2, 2, MV_UP)] == '7');
-    assert(game_field[computeIndex(2, 3, MV_UP)] == '3');
-    assert(game_field[computeIndex(3, 0, MV_UP)] == 'g');
-    assert(game_field[computeIndex(3, 1, MV_UP)] == 'c');
-    assert(game_field[computeIndex(3, 2, MV_UP)] == '8');
-    assert(game_field[computeIndex(3, 3, MV_UP)] == '4');
+    return true;
+}
 
-    assert(game_field[computeIndex(0, 0, MV_DOWN)] == '1');
-    assert(game_field[computeIndex(0, 1, MV_DOWN)] == '5');
-    assert(game_field[computeIndex(0, 2, MV_DOWN)] == '9');
-    assert(game_field[computeIndex(0, 3, MV_DOWN)] == 'd');
-    assert(game_field[computeIndex(1, 0, MV_DOWN)] == '2');
-    assert(game_field[computeIndex(1, 1, MV_DOWN)] == '6');
-    assert(game_field[computeIndex(1, 2, MV_DOWN)] == 'a');
-    assert(game_field[computeIndex(1, 3, MV_DOWN)] == 'e');
-    assert(game_field[computeIndex(2, 0, MV_DOWN)] == '3');
-    assert(game_field[computeIndex(2, 1, MV_DOWN)] == '7');
-    assert(game_field[computeIndex(2, 2, MV_DOWN)] == 'b');
-    assert(game_field[computeIndex(2, 3, MV_DOWN)] == 'f');
-    assert(game_field[computeIndex(3, 0, MV_DOWN)] == '4');
-    assert(game_field[computeIndex(3, 1, MV_DOWN)] == '8');
-    assert(game_field[computeIndex(3, 2, MV_DOWN)] == 'c');
-    assert(game_field[computeIndex(3, 3, MV_DOWN)] == 'g');
+void emu_getField(char *field)
+{
+    memcpy(field, game_field, NUM_FIELDS + 1);
+}
 
-    printf("ok.\n");
+void emu_getScore(char *score)
+{
+    game_scoreRefresh();
+    memcpy(score, game_score, NUM_SCORE + 1);
 }
 
-void test_score()
+bool emu_move(int dir, int algo)
 {
-    printf("[test_score] ");
-    
-    debug = false;
-    char resultWithDecSep[NUM_SCORE_WITH_DECSEP + 1] = "         ";
+    if(dir < 1 || dir > NUM_DIRS) return false;
 
-    int numTests = sizeof(test_scores)/sizeof(test_scores[0]);
-    for(int i = 0; i < numTests; i++)
+    switch(algo)
     {
-        strncpy(game_score, test_scores[i].test, NUM_SCORE);
-
-        uint8_t decSep = game_addScore(test_scores[i].addScore);
+        case 0: return game_move_ref(dir);
+        case 1: return game_move1(dir);
+        case 2: return game_move2(dir);
+        case 3: return game_move3(dir);
+        case 4: return game_move4(dir);
+    }
 
-        for(int i = (NUM_SCORE - 1), j = (NUM_SCORE_WITH_DECSEP - 1); i >= 0; i--, j--) 
-        { 
-            if(decSep & (1 << NUM_SCORE - i - 1))
-            {
-                resultWithDecSep[j--] = '.';
-            }
+    return false;
+}
 
-            if(i <= NUM_SCORE) resultWithDecSep[j] = game_score[i];             
-        }
+bool emu_canMove(void)
+{
+    return canmove();
+}
 
-        if(debug) printf("'%s' + %2d(%6d):  '%s' ('%s') [", test_scores[i].test, test_scores[i].addScore, 1 << test_scores[i].addScore, test_scores[i].result, game_score);
-        if(debug) printBits(sizeof(uint8_t), &decSep);
-        if(debug) printf("] -> '%s' ('%s')\n", test_scores[i].resultWithDecSep, resultWithDecSep);
-        
-        bool testScore  = (strncmp(game_score,       test_scores[i].result,           NUM_SCORE) == 0);
-        bool testDecSep = (strncmp(resultWithDecSep, test_scores[i].resultWithDecSep, NUM_SCORE_WITH_DECSEP) == 0);
+uint8_t emu_addScore(int value)
+{
+    return game_addScore(value);
+}
 
-        if(!debug && (!testScore || !testDecSep))
-        {
-            i--;
-            debug = true;
-            printf("\n");
-            continue;
-        }
+uint16_t emu_spawnStep(void)
+{
+    spawn_tetrisrng();
 
-        assert(testScore); 
-        assert(testDecSep);   
-    }  
+    return game_rng_value;
+}
 
-    printf("ok.\n");
+void emu_setRng(uint16_t value)
+{
+    game_rng_value = value;
 }
 
-void test_move()
+bool emu_spawn(int index, int value)
 {
-    printf("[test_move] ");
-    
-    debug = false;
+    if(index < 0 || index >= NUM_FIELDS || value < 1 || value > NUM_SIGNS - 1) return false;
+    if(game_field[index] != getSign(0)) return false;
 
-    int numTests = sizeof(test_fields)/sizeof(test_fields[0]);
-    for(int i = 0; i < numTests; i++)
-    {
-       strncpy(game_field, test_fields[i].test, NUM_FIELDS);
+    game_field[index] = getSign(value);
+    game_lastSpawn = index;
 
-        if(debug) printf("=== %d === \n", i);
-        if(debug) printf("\n"); 
-        if(debug) print_game();
+    return true;
+}
 
-        bool moved = game_move(test_fields[i].dir);
-        
-        if(debug) printf("\n"); 
-        if(debug) print_game();
-        if(debug) printf("'%s' %s '%s' (%s): '%s' (%s) [%3d][%2d]\n", test_fields[i].test, game_moveLabels[test_fields[i].dir], test_fields[i].result, test_fields[i].moved ? "true " : "false", game_field, moved ? "true " : "false", game_numIterations, game_numSteps);
-        
-        bool testMoved = (test_fields[i].moved == moved);
-        bool testField = (strncmp(game_field, test_fields[i].result, NUM_FIELDS) == 0);
+void emu_getCounters(emu_counters_t *counters)
+{
+    counters->numIterations = game_numIterations;
+    counters->numSteps      = game_numSteps;
+    counters->fieldIndex    = game_fieldIndex;
+    counters->lastSpawn     = game_lastSpawn;
+    counters->rng           = game_rng_value;
+    counters->decSep        = game_scoreDecSep;
+}
 
-        if(!debug && (!testMoved || !testField))
-        {
-            i--;
-            debug = true;
-            printf("\n");
-            continue;
-        }
+void emu_resetCounters(void)
+{
+    game_numIterations = 0;
+    game_numSteps = 0;
+}
 
-        assert(testMoved);   
-        assert(testField); 
-    }  
+int emu_getDisplay(uint8_t *digits, int size)
+{
+    display_frame_t frame;
+    display_encode(&frame, game_scoreDecSep);
 
-    printf("ok.\n");
-}
+    int num = size < DISPLAY_NUM_DIGITS ? size : DISPLAY_NUM_DIGITS;
+    memcpy(digits, frame.digit, (size_t) (num > 0 ? num : 0));
 
+    return DISPLAY_NUM_DIGITS;
+}
 
 
 /* === MAIN ==== */
 
-int main()
+#ifndef EMU_LIB
+
+int main(int argc, char **argv)
 {
     int ch;
     bool moved = true;
     size_t numMoves = 0;
+
+    if(argc > 1) return filter(argc, argv);
+
+    corpus_open(CORPUS_FILE);
   
-    if(DEBUG) search_variants_rnd(1);
+    if(DEBUG) search_variants_rnd(1, "");
     if(DEBUG) debug_spawn_tetrisrng();
     if(DEBUG) debug_computeIndex();
     if(DEBUG) debug_move();  
-
-    if(SEARCH) search_variants_rnd(NUM_SEARCH);
+    if(DEBUG) debug_display();
+    if(DEBUG) debug_schedule();
+    if(DEBUG) debug_memory();
+    if(DEBUG) debug_moveK();
+    if(DEBUG) debug_score();
+    if(DEBUG) debug_batch();
+    if(DEBUG) debug_corpus();
+    if(DEBUG && TOGGLE) debug_toggles();
+
+    if(SEARCH) search_variants_rnd(NUM_SEARCH, SEARCH_CHECKPOINT_FILE);
+    if(CHECK_SCORE) check_score();
+    if(TRAIN) train();
+    if(PLAY) play();
+    if(GENERATE_LOGIC) move4_generateLogic();
+    if(FUZZ) fuzz();
+    if(COMPACT) compact();
 
     if(DEBUG) printf("\n=== tests ===\n\n"); 
+    test_term();
+    test_trace();
     test_computeIndex();
+    test_memory();
+    test_toggles();
+    test_signs();
+    test_display();
+    test_batch();
+    test_moveAll();
+    test_checkpoint();
+    test_move4_table();
+    test_move4_steps();
+    test_fuzz();
+    test_filter();
+    test_corpus();
+    test_compact();
+    test_moveK();
+    test_spawn_tetrisrng();
+    test_train();
     test_score();
+    test_lib();
+    test_runner();
     test_move();
     
     if(DEBUG) return 0;
 
-    strncpy(game_field, "                ", NUM_FIELDS + 1);
-    strncpy(game_score, "      0", NUM_SCORE + 1);
-    game_fieldIndex = 0; 
-    game_numIterations = 0;
-    game_lastMove = 0;
+    game_reset();
+    term_init();
 
     do
     {
         if (moved)
         {
-            CLEAR();
-
             numMoves++;
             spawn();
 
-            printf("\nfield: '%s' score: %s last spawn: %d last move: %s step: %zu\n", game_field, game_score, game_lastSpawn, game_moveLabels[game_lastMove], numMoves);
-            print_game();
+            if(RENDER == 1)
+            {
+                render_game(numMoves, false);
+            }
+            else
+            {
+                CLEAR();
+                printf("\nfield: '%s' score: %s last spawn: %d last move: %s step: %zu\n", game_field, game_score, game_lastSpawn, game_moveLabels[game_lastMove], numMoves);
+                print_game();
+            }
             
             moved = false;
         }
@@ -2008,36 +9381,36 @@ int main()
 
         if (!canmove())
         {
+            if(RENDER == 1) render_game(numMoves, true);
             printf("\nGame Over!");
             break;
         }
 
+        // a frame skipped by RENDER_INTERVAL is drawn before waiting for the next key
+        if(RENDER == 1) render_game(numMoves, true);
+
         //printf("\rmove?> ");
         ch = GETCH();
 
         switch (ch)
         {
-        case 91:
-            ch = GETCH();
-            switch (ch)
-            {
-            case 65: // up
-                moved = game_move(MV_UP);
-                break;
-            case 66: // down
-                moved = game_move(MV_DOWN);
-                break;
-            case 68: // left 
-                moved = game_move(MV_LEFT);
-                break;
-            case 67: // right
-                moved = game_move(MV_RIGHT);
-                break;
-            }
+        case KEY_UP:
+            moved = game_move(MV_UP);
+            break;
+        case KEY_DOWN:
+            moved = game_move(MV_DOWN);
+            break;
+        case KEY_LEFT:
+            moved = game_move(MV_LEFT);
+            break;
+        case KEY_RIGHT:
+            moved = game_move(MV_RIGHT);
             break;
         }
 
-    } while (ch != 'x');
+    } while (ch != 'x' && ch != KEY_EOF);
 
     return EXIT_SUCCESS;
 }
+
+#endif
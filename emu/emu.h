@@ -0,0 +1,78 @@
+/* C API of the emulator, used as golden model (e.g. by cocotb via ctypes) */
+
+/* build: gcc -O2 -fPIC -shared -fvisibility=hidden -DEMU_LIB -pthread emu.c -o libemu2048.so */
+
+#ifndef EMU_H
+#define EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+    Boards and scores are passed as strings in the format of the emulator:
+
+        board   NUM_FIELDS signs, row by row (' ' empty, '1' = 2, '2' = 4, ...)
+        score   NUM_SCORE  decimal digits, leading blanks
+
+    Directions are 1 up, 2 down, 3 left, 4 right. All state is per thread.
+*/
+
+#define EMU_API_VERSION 1
+
+// the library is built with hidden visibility, only the api is exported
+#define EMU_API __attribute__((visibility("default")))
+
+typedef struct emu_counters_st
+{
+    int32_t numIterations;      // memory shifts (in fields)
+    int32_t numSteps;           // logic steps
+    int32_t fieldIndex;         // field in the buffer
+    int32_t lastSpawn;          // last spawned field
+    uint16_t rng;               // state of the spawn lfsr
+    uint8_t decSep;             // decimal seperators of the last score update
+} emu_counters_t;
+
+// version of this api
+EMU_API int emu_version(void);
+
+// board geometry
+EMU_API int emu_numFieldW(void);
+EMU_API int emu_numFields(void);
+EMU_API int emu_numScore(void);
+
+// clear board, score and counters
+EMU_API void emu_reset(void);
+
+// load board and score (score may be NULL), returns false if a sign is invalid
+EMU_API bool emu_load(const char *field, const char *score);
+
+// copy the board (NUM_FIELDS + 1 bytes) and the score (NUM_SCORE + 1 bytes)
+EMU_API void emu_getField(char *field);
+EMU_API void emu_getScore(char *score);
+
+// move with algorithm 0 (ref) to 4, returns true if a tile moved
+EMU_API bool emu_move(int dir, int algo);
+
+// true if any move is possible
+EMU_API bool emu_canMove(void);
+
+// add 2^value to the score, returns the decimal seperators
+EMU_API uint8_t emu_addScore(int value);
+
+// advance the spawn lfsr by one step and return its state
+EMU_API uint16_t emu_spawnStep(void);
+
+// set the state of the spawn lfsr
+EMU_API void emu_setRng(uint16_t value);
+
+// place a tile with the given value, returns false if the field is not empty
+EMU_API bool emu_spawn(int index, int value);
+
+// read and reset the counters
+EMU_API void emu_getCounters(emu_counters_t *counters);
+EMU_API void emu_resetCounters(void);
+
+// segments of the display chain (one byte per digit: segments << 1 | dot), returns the number of digits
+EMU_API int emu_getDisplay(uint8_t *digits, int size);
+
+#endif
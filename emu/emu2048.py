@@ -0,0 +1,110 @@
+# ctypes binding of libemu2048.so (see emu.h), build the library with make.sh
+
+import ctypes
+import os
+
+
+class Counters(ctypes.Structure):
+    _fields_ = [
+        ("numIterations", ctypes.c_int32),
+        ("numSteps", ctypes.c_int32),
+        ("fieldIndex", ctypes.c_int32),
+        ("lastSpawn", ctypes.c_int32),
+        ("rng", ctypes.c_uint16),
+        ("decSep", ctypes.c_uint8),
+    ]
+
+
+class Emu:
+    UP, DOWN, LEFT, RIGHT = 1, 2, 3, 4
+    API_VERSION = 1
+
+    def __init__(self, path=None):
+        if path is None:
+            path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "libemu2048.so")
+
+        lib = ctypes.CDLL(path)
+
+        lib.emu_load.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+        lib.emu_load.restype = ctypes.c_bool
+        lib.emu_getField.argtypes = [ctypes.c_char_p]
+        lib.emu_getScore.argtypes = [ctypes.c_char_p]
+        lib.emu_move.argtypes = [ctypes.c_int, ctypes.c_int]
+        lib.emu_move.restype = ctypes.c_bool
+        lib.emu_canMove.restype = ctypes.c_bool
+        lib.emu_addScore.argtypes = [ctypes.c_int]
+        lib.emu_addScore.restype = ctypes.c_uint8
+        lib.emu_spawnStep.restype = ctypes.c_uint16
+        lib.emu_setRng.argtypes = [ctypes.c_uint16]
+        lib.emu_spawn.argtypes = [ctypes.c_int, ctypes.c_int]
+        lib.emu_spawn.restype = ctypes.c_bool
+        lib.emu_getCounters.argtypes = [ctypes.POINTER(Counters)]
+        lib.emu_getDisplay.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.c_int]
+
+        assert lib.emu_version() == self.API_VERSION
+
+        self.lib = lib
+        self.numFieldW = lib.emu_numFieldW()
+        self.numFields = lib.emu_numFields()
+        self.numScore = lib.emu_numScore()
+
+    def reset(self):
+        self.lib.emu_reset()
+
+    def load(self, field, score=None):
+        assert len(field) == self.numFields
+        assert score is None or len(score) == self.numScore
+        if not self.lib.emu_load(field.encode(), None if score is None else score.encode()):
+            raise ValueError("invalid board or score")
+
+    def field(self):
+        buf = ctypes.create_string_buffer(self.numFields + 1)
+        self.lib.emu_getField(buf)
+        return buf.value.decode()
+
+    def score(self):
+        buf = ctypes.create_string_buffer(self.numScore + 1)
+        self.lib.emu_getScore(buf)
+        return buf.value.decode()
+
+    def move(self, direction, algo=4):
+        return self.lib.emu_move(direction, algo)
+
+    def can_move(self):
+        return self.lib.emu_canMove()
+
+    def add_score(self, value):
+        return self.lib.emu_addScore(value)
+
+    def spawn_step(self):
+        return self.lib.emu_spawnStep()
+
+    def set_rng(self, value):
+        self.lib.emu_setRng(value)
+
+    def spawn(self, index, value=1):
+        return self.lib.emu_spawn(index, value)
+
+    def counters(self):
+        counters = Counters()
+        self.lib.emu_getCounters(ctypes.byref(counters))
+        return counters
+
+    def reset_counters(self):
+        self.lib.emu_resetCounters()
+
+    def display(self):
+        num = self.lib.emu_getDisplay(None, 0)
+        digits = (ctypes.c_uint8 * num)()
+        self.lib.emu_getDisplay(digits, num)
+        return list(digits)
+
+
+if __name__ == "__main__":
+    emu = Emu()
+    emu.reset()
+    for algo in range(5):
+        emu.load("11  2 2 3  3    ", "      0")
+        assert emu.move(Emu.LEFT, algo)
+        assert emu.field() == "   2   3   4    ", emu.field()
+    print(emu.field(), "'{}'".format(emu.score()), emu.counters().numIterations)
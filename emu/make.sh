@@ -0,0 +1,5 @@
+#!/bin/bash
+gcc -O2 -fPIC -shared -fvisibility=hidden -DEMU_LIB -pthread emu.c -o libemu2048.so
+
+# only the emu_* api may be exported
+if nm -D --defined-only libemu2048.so | grep -v " emu_"; then echo "internal symbols exported"; exit 1; fi
@@ -0,0 +1,192 @@
+`default_nettype none
+
+/*
+    MoveLogic
+
+    Decision of one step of a move (v4), generated from the table of the emulator
+    (emu/emu.c, move4_decide) - do not edit, set GENERATE_LOGIC and run the emulator.
+
+    condition bits:
+        [0] start
+        [1] isBaseZero
+        [2] isViewZero
+        [3] eqBaseView
+        [4] hasGap
+        [5] incLane
+        [6] lastLane
+
+    decision bits:
+        [ 0] setValue
+        [ 1] memWrite
+        [ 2] addScore
+        [ 3] memReadB
+        [ 4] memReadV
+        [ 5] clrValue
+        [ 6] done
+        [ 7] baseWriteInc
+        [ 8] baseInc
+        [ 9] laneInc
+        [10] baseReadZero
+*/
+
+module MoveLogic (
+  input start,
+  input isBaseZero,
+  input isViewZero,
+  input eqBaseView,
+  input hasGap,
+  input incLane,
+  input lastLane,
+  output setValue,
+  output memWrite,
+  output addScore,
+  output memReadB,
+  output memReadV,
+  output clrValue,
+  output done,
+  output baseWriteInc,
+  output baseInc,
+  output laneInc,
+  output baseReadZero
+);
+
+  wire [6:0] condition = {lastLane, incLane, hasGap, eqBaseView, isViewZero, isBaseZero, start};
+  reg [10:0] decision;
+
+  assign {baseReadZero, laneInc, baseInc, baseWriteInc, done, clrValue, memReadV, memReadB, addScore, memWrite, setValue} = decision;
+
+  always @(*) begin
+    case(condition)
+      7'd0  : decision = 11'b00100010001;
+      7'd1  : decision = 11'b10000011000;
+      7'd2  : decision = 11'b00000010011;
+      7'd3  : decision = 11'b10000011000;
+      7'd4  : decision = 11'b00000010000;
+      7'd5  : decision = 11'b10000011000;
+      7'd6  : decision = 11'b00000010000;
+      7'd7  : decision = 11'b10000011000;
+      7'd8  : decision = 11'b00100110111;
+      7'd9  : decision = 11'b10000011000;
+      7'd10 : decision = 11'b00000010011;
+      7'd11 : decision = 11'b10000011000;
+      7'd12 : decision = 11'b00000010000;
+      7'd13 : decision = 11'b10000011000;
+      7'd14 : decision = 11'b00000010000;
+      7'd15 : decision = 11'b10000011000;
+      7'd16 : decision = 11'b00110010011;
+      7'd17 : decision = 11'b10000011000;
+      7'd18 : decision = 11'b00000010011;
+      7'd19 : decision = 11'b10000011000;
+      7'd20 : decision = 11'b00000010000;
+      7'd21 : decision = 11'b10000011000;
+      7'd22 : decision = 11'b00000010000;
+      7'd23 : decision = 11'b10000011000;
+      7'd24 : decision = 11'b00100110111;
+      7'd25 : decision = 11'b10000011000;
+      7'd26 : decision = 11'b00000010011;
+      7'd27 : decision = 11'b10000011000;
+      7'd28 : decision = 11'b00000010000;
+      7'd29 : decision = 11'b10000011000;
+      7'd30 : decision = 11'b00000010000;
+      7'd31 : decision = 11'b10000011000;
+      7'd32 : decision = 11'b11000011001;
+      7'd33 : decision = 11'b11000011000;
+      7'd34 : decision = 11'b11000011011;
+      7'd35 : decision = 11'b11000011000;
+      7'd36 : decision = 11'b11000011000;
+      7'd37 : decision = 11'b11000011000;
+      7'd38 : decision = 11'b11000011000;
+      7'd39 : decision = 11'b11000011000;
+      7'd40 : decision = 11'b11000011111;
+      7'd41 : decision = 11'b11000011000;
+      7'd42 : decision = 11'b11000011011;
+      7'd43 : decision = 11'b11000011000;
+      7'd44 : decision = 11'b11000011000;
+      7'd45 : decision = 11'b11000011000;
+      7'd46 : decision = 11'b11000011000;
+      7'd47 : decision = 11'b11000011000;
+      7'd48 : decision = 11'b11010011011;
+      7'd49 : decision = 11'b11000011000;
+      7'd50 : decision = 11'b11000011011;
+      7'd51 : decision = 11'b11000011000;
+      7'd52 : decision = 11'b11000011000;
+      7'd53 : decision = 11'b11000011000;
+      7'd54 : decision = 11'b11000011000;
+      7'd55 : decision = 11'b11000011000;
+      7'd56 : decision = 11'b11000011111;
+      7'd57 : decision = 11'b11000011000;
+      7'd58 : decision = 11'b11000011011;
+      7'd59 : decision = 11'b11000011000;
+      7'd60 : decision = 11'b11000011000;
+      7'd61 : decision = 11'b11000011000;
+      7'd62 : decision = 11'b11000011000;
+      7'd63 : decision = 11'b11000011000;
+      7'd64 : decision = 11'b00100010001;
+      7'd65 : decision = 11'b10000011000;
+      7'd66 : decision = 11'b00000010011;
+      7'd67 : decision = 11'b10000011000;
+      7'd68 : decision = 11'b00000010000;
+      7'd69 : decision = 11'b10000011000;
+      7'd70 : decision = 11'b00000010000;
+      7'd71 : decision = 11'b10000011000;
+      7'd72 : decision = 11'b00100110111;
+      7'd73 : decision = 11'b10000011000;
+      7'd74 : decision = 11'b00000010011;
+      7'd75 : decision = 11'b10000011000;
+      7'd76 : decision = 11'b00000010000;
+      7'd77 : decision = 11'b10000011000;
+      7'd78 : decision = 11'b00000010000;
+      7'd79 : decision = 11'b10000011000;
+      7'd80 : decision = 11'b00110010011;
+      7'd81 : decision = 11'b10000011000;
+      7'd82 : decision = 11'b00000010011;
+      7'd83 : decision = 11'b10000011000;
+      7'd84 : decision = 11'b00000010000;
+      7'd85 : decision = 11'b10000011000;
+      7'd86 : decision = 11'b00000010000;
+      7'd87 : decision = 11'b10000011000;
+      7'd88 : decision = 11'b00100110111;
+      7'd89 : decision = 11'b10000011000;
+      7'd90 : decision = 11'b00000010011;
+      7'd91 : decision = 11'b10000011000;
+      7'd92 : decision = 11'b00000010000;
+      7'd93 : decision = 11'b10000011000;
+      7'd94 : decision = 11'b00000010000;
+      7'd95 : decision = 11'b10000011000;
+      7'd96 : decision = 11'b11001000001;
+      7'd97 : decision = 11'b11001000000;
+      7'd98 : decision = 11'b11001000011;
+      7'd99 : decision = 11'b11001000000;
+      7'd100: decision = 11'b11001000000;
+      7'd101: decision = 11'b11001000000;
+      7'd102: decision = 11'b11001000000;
+      7'd103: decision = 11'b11001000000;
+      7'd104: decision = 11'b11001100111;
+      7'd105: decision = 11'b11001000000;
+      7'd106: decision = 11'b11001000011;
+      7'd107: decision = 11'b11001000000;
+      7'd108: decision = 11'b11001000000;
+      7'd109: decision = 11'b11001000000;
+      7'd110: decision = 11'b11001000000;
+      7'd111: decision = 11'b11001000000;
+      7'd112: decision = 11'b11011000011;
+      7'd113: decision = 11'b11001000000;
+      7'd114: decision = 11'b11001000011;
+      7'd115: decision = 11'b11001000000;
+      7'd116: decision = 11'b11001000000;
+      7'd117: decision = 11'b11001000000;
+      7'd118: decision = 11'b11001000000;
+      7'd119: decision = 11'b11001000000;
+      7'd120: decision = 11'b11001100111;
+      7'd121: decision = 11'b11001000000;
+      7'd122: decision = 11'b11001000011;
+      7'd123: decision = 11'b11001000000;
+      7'd124: decision = 11'b11001000000;
+      7'd125: decision = 11'b11001000000;
+      7'd126: decision = 11'b11001000000;
+      7'd127: decision = 11'b11001000000;
+      default: decision = 11'b0;
+    endcase
+  end
+
+endmodule
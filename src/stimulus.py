@@ -0,0 +1,128 @@
+# Gate level stimulus, generated by emu/emu.c (COMPACT), do not edit
+#
+# Every vector is one move from a preloaded board and score:
+#   (board, score, direction, expected board, expected score, moved)
+# board: NUM_FIELDS signs row by row (' ' empty, '1' = 2, '2' = 4, ...)
+# direction: 1 up, 2 down, 3 left, 4 right
+#
+# The RTL has no board/score preload port yet: the vectors can be imported
+# by a cocotb test, but only driven once the port exists.
+
+STIMULUS_VERSION = 1
+NUM_FIELDW = 4
+NUM_SCORE = 7
+
+# goals covered (all reached by 200081 candidates)
+coverage = {
+    "variants": 52,
+    "conditions": 41,
+    "pairs": 184,
+    "carries": 90,
+}
+
+# emulated cycles of all vectors
+cycles = 88383
+
+vectors = [
+    ("322  33 2   12 2", " 249780", 4, "33  4   2   13  ", " 249812", True),
+    ("2 13  33   2 212", "9799992", 4, "213 4   2   212 ", "9800008", True),
+    ("db93abf cg5ec11e", "     34", 1, "  9 dcf ag53d11f", "  45090", True),
+    (" 21 2331213  3  ", "      0", 4, "21  241 213 3   ", "     16", True),
+    (" 1 31 3  1 3121 ", "8993999", 2, "2234 21         ", "8994023", True),
+    ("  212  2 331 322", "   1220", 1, "   1  22  312422", "   1236", True),
+    ("3311 211332   12", "     68", 4, "42  22  42  12  ", "    108", True),
+    ("32 222 3   312 3", "      4", 2, "33 222 41  3    ", "     28", True),
+    ("321332  32123 11", "4299999", 4, "321332  321232  ", "4300003", True),
+    ("21331 2 2 3 31 2", "4999999", 2, "22331 222 3 3   ", "5000003", True),
+    ("33  2   313 3 11", "   9735", 2, "3331211 4       ", "   9751", True),
+    (" 333313 111 3323", "1859980", 4, "43  313 21  423 ", "1860016", True),
+    ("1 2  1321 31 223", "2498998", 4, "12  132 131 33  ", "2499006", True),
+    ("hh881hggaa2989ee", "1974499", 4, "x9  1hh b29 89f ", "2403043", True),
+    ("2131112211 3212 ", "  38707", 2, "223122322  3    ", "  38727", True),
+    ("2221331 3 33322 ", "3499999", 4, "321 41  43  33  ", "3500047", True),
+    ("1 2333  23 1 32 ", "9494993", 2, "143333 12       ", "9495017", True),
+    ("b2bfe8b 4h72hhb8", "2487506", 1, "b   e2cf4872hxb8", "2753746", True),
+    ("ff  9e27agg  322", "  19530", 3, "   g9e27  ah  33", " 216146", True),
+    ("323 13 1 2 333  ", "     52", 4, "323 131 23  4   ", "     68", True),
+    ("     1   1      ", "    219", 2, " 2              ", "    223", True),
+    ("7aad c14h2c6d9  ", "9999959", 4, "7bd c14 h2c6d9  ", "0002007", True),
+    ("233 1233  33 2 2", " 156217", 4, "24  124 4   3   ", " 156273", True),
+    ("1 3 3 3 1  13131", "  39027", 2, "11423 3 1   3   ", "  39047", True),
+    ("bdh d 6 d118 d  ", "  13983", 2, "bdh8e16  d1     ", "  30367", True),
+    ("3131322     1133", "  39062", 4, "313133      24  ", "  39090", True),
+    ("312 3 3 33  2 21", "     22", 4, "312 4   4   31  ", "     62", True),
+    ("gf44 9888eeefc35", "  73046", 4, "gf5 99  8fe fc35", " 106358", True),
+    ("194e81hb61hb63 2", "1249924", 2, "194e82xc73 2    ", "1516296", True),
+    ("23233 133 322133", "9999993", 2, "232441122 43    ", "0000041", True),
+    ("fa6f68bb1ce fdh2", "9999729", 4, "fa6f68c 1ce fdh2", "0003825", True),
+    ("312     3123  31", " 287482", 4, "312     312331  ", " 287482", True),
+    ("2bf6163cagdf aa ", "  18240", 4, "2bf6163cagdfb   ", "  20288", True),
+    ("hba68d495hd ccef", "2397747", 4, "hba68d495hd def ", "2405939", True),
+    ("ghhcf217a8hh834c", "4977374", 4, "gxc f217a8x 834c", "5501662", True),
+    ("d1ff6bebeff   h6", "      4", 4, "d1g 6bebeg  h6  ", " 131076", True),
+    ("2a31b747hgg3 c e", "4951744", 4, "2a31b747hh3 ce  ", "5082816", True),
+    ("1321122 11 21 2 ", " 393718", 4, "132113  22  12  ", " 393730", True),
+    ("3112  3 31   2  ", "   2164", 4, "322 3   31  2   ", "   2168", True),
+    ("2ce443ceeggchh8g", "9842999", 4, "2ce443ceehc x8g ", "0236215", True),
+    ("727a6hhb366e4 1 ", " 472312", 4, "727a6xb 37e 41  ", " 734584", True),
+    ("d5g3hf7 2ghd  h9", "8919379", 2, "d5g3hf7d2gx9    ", "9181523", True),
+    ("ae a61553ehh a73", "2984747", 4, "aea 616 3ex a73 ", "3246955", True),
+    ("123 3 22  33221 ", " 999982", 4, "123 33  4   31  ", "1000014", True),
+    ("d45 2 8584893b 5", "4999849", 2, "d5552b998  53   ", "5000393", True),
+    ("fefg4dah39a 1g2 ", "2499920", 1, "fe  4df 39bg1g2h", "2501968", True),
+    ("  6ghhfc 55 b 7 ", "  78069", 3, "  6g xfc   6  b7", " 340277", True),
+    ("h7921f96gadh9hee", "3494823", 4, "h7921f96gadh9hf ", "3527591", True),
+    ("873fb27abha929cc", "4999499", 4, "873fb27abha929d ", "5007691", True),
+    ("43b2ad76575c7hff", "2479924", 4, "43b2ad76575c7hg ", "2545460", True),
+    ("e4b9721f34163d66", "9999914", 4, "e4b9721f34163d7 ", "0000042", True),
+    ("c7d12f2494ccg182", "1997753", 4, "c7d12f2494d g182", "2005945", True),
+    ("79f7ghee1h877986", " 994999", 4, "79f7ghf 1h877986", "1027767", True),
+    ("57hhec4g874bc231", "2374955", 4, "57x ec4g874bc231", "2637099", True),
+    ("9a3ah8gg3b1g31eh", "2994964", 4, "9a3ah8h 3b1g31eh", "3126036", True),
+    ("feff9e14e6bd5ae6", "4966445", 4, "feg 9e14e6bd5ae6", "5031981", True),
+    ("32  1 3 23  2   ", "1201238", 4, "32  13  23  2   ", "1201238", True),
+    ("cg1chdb8gcffc6dh", "4947954", 4, "cg1chdb8gcg c6dh", "5013490", True),
+    ("5be63d72hdhh16c ", "4969824", 4, "5be63d72hdx 16c ", "5231968", True),
+    ("7198b4dbgecc   e", "      4", 4, "7198b4dbged e   ", "   8196", True),
+    ("31311232311 1  1", "  70466", 4, "3131123232  2   ", "  70474", True),
+    ("1313313231 1   1", "4324999", 4, "1313313232  1   ", "4325003", True),
+    ("81hg574eg9f7fee4", "9970999", 4, "81hg574eg9f7ff4 ", "0003767", True),
+    ("gd6d2921b54aahh6", "4974419", 4, "gd6d2921b54aax6 ", "5236563", True),
+    ("ebd4g5fc37gg4d a", "9959551", 4, "ebd4g5fc37h 4da ", "0090623", True),
+    ("a28gfggc9g6h43g6", "9997990", 4, "a28gfhc 9g6h43g6", "0129062", True),
+    ("2717c4af3541hh55", "7917943", 4, "2717c4af3541x6  ", "8180151", True),
+    ("ae974 3fa5  h688", "9999934", 4, "ae9743f a5  h69 ", "0000446", True),
+    ("85bfe8df83 bfhhb", "9919989", 4, "85bfe8df83b fxb ", "0182133", True),
+    ("hfe46gg4516273cc", "1953299", 4, "hfe46h4 516273d ", "2092563", True),
+    ("92hhcfed1g62a338", "4929959", 4, "92x cfed1g62a48 ", "5192119", True),
+    ("gh 23gg4cfd 61d3", "9991719", 4, "gh2 3h4 cfd 61d3", "0122791", True),
+    ("bd2 a9729919dh48", "9999359", 4, "bd2 a972a19 dh48", "0000383", True),
+    ("312121 2122 33  ", "   4463", 4, "3121212 13  4   ", "   4487", True),
+    ("hha219c661hfd1d3", "9909992", 4, "xa2 19c661hfd1d3", "0172136", True),
+    ("a926d 67g5c37ffe", "9935192", 4, "a926d67 g5c37ge ", "0000728", True),
+    ("7ghg2abdgg72gh a", "4934524", 2, "7ghg2abdhg72 h a", "5065596", True),
+    ("ebab175h4b2d b e", "9999900", 2, "ebab175h4c2d   e", "0003996", True),
+    ("eed2bf 64ea28d56", "7984920", 4, "fd2 bf6 4ea28d56", "8017688", True),
+    ("gg396be11b19e hg", "9935999", 4, "h39 6be11b19ehg ", "0067071", True),
+    ("2d4fe7a4e2hg888e", "9994909", 2, "2d4ff7a482hg 88e", "0027677", True),
+    ("caa3f3 c48g7d9g2", "9958299", 2, "caa3f3hc48 7d9 2", "0089371", True),
+    ("5dee6c 5hh97b2ca", "6994819", 4, "5df 6c5 x97 b2ca", "7289731", True),
+    ("547e4762ae15aeh5", "9989998", 2, "547e4762bf16  h ", "0024878", True),
+    ("c329ee67a4a6hh4a", "1786864", 4, "c329f67 a4a6x4a ", "2081776", True),
+    ("f35647 fc 3gb4dg", "4964979", 2, "f356473fc4dhb   ", "5096051", True),
+    ("7cb44bdha9dhfag2", "9949929", 2, "7cb44bexa9g2fa  ", "0228457", True),
+    ("82bh9cch5 7848f9", "4834954", 2, "82bx9cc858794 f ", "5097098", True),
+    ("a433fd 5adgd2hgf", "9928991", 2, "a433feh5ah d2  f", "0076447", True),
+    ("bge9agagg1hbfbb7", "9944209", 1, "b e9ahagg1hbfbb7", "0075281", True),
+    ("89364ghe6ch7b4eh", "9894920", 1, "89 64g3e6cx7b4eh", "0157064", True),
+    ("1fhaaeh6h4c4h6eg", "4571964", 1, " f a1ex6a4c4x6eg", "5096252", True),
+    ("5cdb6ghd4gd64h1h", "9908288", 1, "  db5chd6hd65h1h", "0039392", True),
+    ("17a92h6a2h67c4gh", "9902899", 1, "   917aa3x77c4gh", "0165179", True),
+    ("cf9885hf3 h2 67f", "9819329", 1, "   8cf9f85x2367f", "0081473", True),
+    ("g 3ea38ge1fgae2d", "9949039", 1, "g 3 a38ee1fhae2d", "0080111", True),
+    ("2875 bbh heh7fe4", "7795949", 1, " 8   b752hbx7ff4", "8090861", True),
+    ("h7f34ed1hd7bh59 ", "9922891", 1, " 7f hed34d71x59b", "0185035", True),
+    ("63b392hheb9c5d35", "9925903", 3, "63b3 92xeb9c5d35", "0188047", True),
+    ("3e32  hh2ee3a9e5", "4907949", 3, "3e32   x 2f3a9e5", "5202861", True),
+    ("4e1462hh 6cb89c2", "1933991", 3, "4e14 62x 6cb89c2", "2196135", True),
+]